@@ -21,15 +21,27 @@
 
 var common = require('../common.js');
 
-var bench = common.createBenchmark(main, {});
+var bench = common.createBenchmark(main, {
+  encoding: ['base64', 'hex'],
+  op: ['encode', 'decode']
+});
 
 function main(conf) {
+  var encoding = conf.encoding;
   var N = 64 * 1024 * 1024;
   var b = Buffer(N);
   var s = '';
   for (var i = 0; i < 256; ++i) s += String.fromCharCode(i);
   for (var i = 0; i < N; i += 256) b.write(s, i, 256, 'ascii');
-  bench.start();
-  for (var i = 0; i < 32; ++i) b.toString('base64');
-  bench.end(64);
+
+  if (conf.op === 'decode') {
+    var encoded = b.toString(encoding);
+    bench.start();
+    for (var i = 0; i < 32; ++i) b.write(encoded, 0, N, encoding);
+    bench.end(64);
+  } else {
+    bench.start();
+    for (var i = 0; i < 32; ++i) b.toString(encoding);
+    bench.end(64);
+  }
 }
@@ -0,0 +1,67 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common.js');
+
+var needles = {
+  lf: '\n',
+  crlf: '\r\n',
+  header: 'Content-Length',
+  absent: 'not there, not anywhere'
+};
+
+var bench = common.createBenchmark(main, {
+  needle: Object.keys(needles),
+  type: ['number', 'string', 'buffer'],
+  n: [2000]
+});
+
+// Splitting 64 KB of HTTP-ish lines on a delimiter, or looking for something
+// that isn't there at all. Numbers stand for the first byte of the needle.
+var lines = [
+  'GET /index.html HTTP/1.1',
+  'Host: www.example.com',
+  'Content-Length: 1234',
+  'Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8',
+  ''
+];
+
+function main(conf) {
+  var n = conf.n | 0;
+  var search = needles[conf.needle];
+  if (conf.type === 'number')
+    search = search.charCodeAt(0);
+  else if (conf.type === 'buffer')
+    search = new Buffer(search);
+
+  var text = '';
+  while (text.length < 64 * 1024)
+    text += lines.join('\r\n');
+  var haystack = new Buffer(text);
+
+  bench.start();
+  for (var i = 0; i < n; i++) {
+    var pos = haystack.indexOf(search);
+    while (pos !== -1)
+      pos = haystack.indexOf(search, pos + 1);
+  }
+  bench.end(n);
+}
@@ -0,0 +1,59 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common.js');
+
+var bench = common.createBenchmark(main, {
+  content: ['ascii', 'latin1', 'mixed', 'cjk'],
+  size: [1024, 64 * 1024, 1024 * 1024],
+  n: [256]
+});
+
+var samples = {
+  ascii: 'The quick brown fox jumps over the lazy dog. 0123456789\n',
+  latin1: 'Le cœur déçu mais l\'âme plutôt naïve, Louÿs rêva de crapaüter.\n',
+  mixed: 'GET /index.html 200 – 東京 Zürich résumé ok\n',
+  cjk: '天地玄黄宇宙洪荒日月盈昃辰宿列张寒来暑往秋收冬藏\n'
+};
+
+function main(conf) {
+  var size = conf.size | 0;
+  var n = conf.n | 0;
+  var sample = samples[conf.content];
+
+  var s = '';
+  while (Buffer.byteLength(s) < size)
+    s += sample;
+  var b = new Buffer(s);
+
+  // Stop at a character boundary, a split character goes the slow way.
+  while ((b[size] & 0xc0) === 0x80)
+    size--;
+  b = b.slice(0, size);
+
+  // Repeat more for the smaller buffers so that every run moves 256 MB.
+  var iterations = n * 1024 * 1024 / size | 0;
+
+  bench.start();
+  for (var i = 0; i < iterations; ++i)
+    b.toString('utf8');
+  bench.end(iterations * size / 1024 / 1024);
+}
@@ -1,6 +1,9 @@
 // Call fs.readFile over and over again really fast.
 // Then see how many times it got called.
 // Yes, this is a silly benchmark.  Most benchmarks are silly.
+//
+// `unknown` reads a file that reports a size of 0, like most files in /proc,
+// so it has to be read until EOF.
 
 var path = require('path');
 var common = require('../common.js');
@@ -9,17 +12,34 @@ var fs = require('fs');
 
 var bench = common.createBenchmark(main, {
   dur: [5],
-  len: [1024, 16 * 1024 * 1024],
+  size: ['small', 'large', 'unknown'],
+  encoding: ['buffer', 'utf8'],
   concurrent: [1, 10]
 });
 
+var sizes = {
+  small: 1024,
+  large: 16 * 1024 * 1024
+};
+
 function main(conf) {
-  var len = +conf.len;
-  try { fs.unlinkSync(filename); } catch (e) {}
-  var data = new Buffer(len);
-  data.fill('x');
-  fs.writeFileSync(filename, data);
-  data = null;
+  var len = sizes[conf.size];
+  var file = filename;
+  var encoding = conf.encoding === 'buffer' ? null : conf.encoding;
+
+  if (conf.size === 'unknown') {
+    file = '/proc/self/maps';
+    if (!fs.existsSync(file)) {
+      console.error('%s not available, skipping', file);
+      return;
+    }
+  } else {
+    try { fs.unlinkSync(filename); } catch (e) {}
+    var data = new Buffer(len);
+    data.fill('x');
+    fs.writeFileSync(filename, data);
+    data = null;
+  }
 
   var reads = 0;
   bench.start();
@@ -29,14 +49,14 @@ function main(conf) {
   }, +conf.dur * 1000);
 
   function read() {
-    fs.readFile(filename, afterRead);
+    fs.readFile(file, encoding, afterRead);
   }
 
   function afterRead(er, data) {
     if (er)
       throw er;
 
-    if (data.length !== len)
+    if (len !== undefined && data.length !== len)
       throw new Error('wrong number of bytes returned');
 
     reads++;
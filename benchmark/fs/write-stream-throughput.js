@@ -8,7 +8,7 @@ var fs = require('fs');
 var bench = common.createBenchmark(main, {
   dur: [5],
   type: ['buf', 'asc', 'utf'],
-  size: [2, 1024, 65535, 1024 * 1024]
+  size: [2, 64, 1024, 65535, 1024 * 1024]
 });
 
 function main(conf) {
@@ -7,7 +7,8 @@ if (cluster.isMaster) {
     // unicode confuses ab on os x.
     type: ['bytes', 'buffer'],
     length: [4, 1024, 102400],
-    c: [50, 500]
+    c: [50, 500],
+    policy: ['rr', 'none', 'reuseport']
   });
 } else {
   require('../http_simple.js');
@@ -15,6 +16,11 @@ if (cluster.isMaster) {
 
 function main(conf) {
   process.env.PORT = PORT;
+  cluster.schedulingPolicy = {
+    rr: cluster.SCHED_RR,
+    none: cluster.SCHED_NONE,
+    reuseport: cluster.SCHED_REUSEPORT
+  }[conf.policy];
   var workers = 0;
   var w1 = cluster.fork();
   var w2 = cluster.fork();
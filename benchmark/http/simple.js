@@ -6,6 +6,7 @@ var bench = common.createBenchmark(main, {
   type: ['bytes', 'buffer'],
   length: [4, 1024, 102400],
   chunks: [0, 1, 4],  // chunks=0 means 'no chunked encoding'.
+  headers: [0, 20, 50],  // extra request headers, the server reads none.
   c: [50, 500]
 });
 
@@ -16,6 +17,8 @@ function main(conf) {
   setTimeout(function() {
     var path = '/' + conf.type + '/' + conf.length + '/' + conf.chunks;
     var args = ['-d', '10s', '-t', 8, '-c', conf.c];
+    for (var i = 0; i < conf.headers; i++)
+      args.push('-H', 'X-Benchmark-Header-' + i + ': some value ' + i);
 
     bench.http(path, args, function() {
       server.close();
@@ -0,0 +1,60 @@
+// Measure the throughput and round trip time of child_process IPC messages.
+// The child echoes every message back to the parent. The parent keeps
+// `window` messages in flight; with window=1 the rate is round trips/s.
+var common = require('../common.js');
+var fork = require('child_process').fork;
+
+if (process.send) {
+  process.on('message', function(msg) {
+    process.send(msg);
+  });
+  return;
+}
+
+var bench = common.createBenchmark(main, {
+  serialization: ['json', 'binary'],
+  payload: ['object', 'buffer'],
+  window: [1, 128],
+  dur: [5]
+});
+
+function makePayload(type) {
+  if (type === 'buffer')
+    return new Buffer(4096);
+  return {
+    cmd: 'update',
+    id: 1234567,
+    ratio: 0.5,
+    ok: true,
+    tags: ['alpha', 'beta', 'gamma'],
+    user: { name: 'node', email: 'node@example.com', groups: [1, 2, 3] }
+  };
+}
+
+function main(conf) {
+  var dur = +conf.dur;
+  var window = +conf.window;
+  var payload = makePayload(conf.payload);
+  var child = fork(__filename, [], { serialization: conf.serialization });
+  var done = false;
+  var received = 0;
+
+  child.on('message', function() {
+    if (done) return;
+    received++;
+    child.send(payload);
+  });
+
+  // Start the clock after the child has booted.
+  child.once('message', function() {
+    bench.start();
+    setTimeout(function() {
+      done = true;
+      bench.end(received);
+      child.kill();
+    }, dur * 1000);
+  });
+
+  for (var i = 0; i < window; i++)
+    child.send(payload);
+}
@@ -0,0 +1,26 @@
+// Cost of event loop phase timing. Every setImmediate() callback runs in a
+// loop iteration of its own, so this measures iterations per second.
+var common = require('../common.js');
+var bench = common.createBenchmark(main, {
+  timing: ['off', 'on'],
+  millions: [2]
+});
+
+function main(conf) {
+  var N = +conf.millions * 1e6;
+  var n = 0;
+
+  if (conf.timing === 'on')
+    process.binding('loop_timing').start();
+
+  function cb() {
+    n++;
+    if (n === N)
+      bench.end(n / 1e6);
+    else
+      setImmediate(cb);
+  }
+
+  bench.start();
+  setImmediate(cb);
+}
@@ -1,20 +1,56 @@
 var common = require('../common.js');
 var spawn = require('child_process').spawn;
 var path = require('path');
+var fs = require('fs');
 var emptyJsFile = path.resolve(__dirname, '../../test/fixtures/semicolon.js');
+var treeDir = path.resolve(__dirname, '.removeme-benchmark-garbage-tree');
+var cacheFile = path.resolve(__dirname, '.removeme-benchmark-garbage-cache');
 var starts = 100;
 var i = 0;
 var start;
 
+// `modules` > 0 starts a script that requires a generated node_modules tree
+// of that many packages instead of an empty file. `cache` resolves them with
+// a warm NODE_MODULE_RESOLVE_CACHE file.
 var bench = common.createBenchmark(startNode, {
+  modules: [0, 3000],
+  cache: [0, 1],
   dur: [1]
 });
 
 function startNode(conf) {
   var dur = +conf.dur;
+  var modules = +conf.modules;
   var go = true;
   var starts = 0;
   var open = 0;
+  var script = emptyJsFile;
+  var env = {};
+
+  for (var key in process.env)
+    env[key] = process.env[key];
+  delete env.NODE_MODULE_RESOLVE_CACHE;
+
+  if (modules > 0) {
+    script = makeTree(modules);
+    process.on('exit', function() {
+      rmrf(treeDir);
+      rmrf(cacheFile);
+    });
+  }
+
+  if (+conf.cache) {
+    env.NODE_MODULE_RESOLVE_CACHE = cacheFile;
+    rmrf(cacheFile);
+    // Fill the cache before timing anything.
+    return spawnNode(function() {
+      setTimeout(function() {
+        go = false;
+      }, dur * 1000);
+      bench.start();
+      start();
+    });
+  }
 
   setTimeout(function() {
     go = false;
@@ -24,11 +60,7 @@ function startNode(conf) {
   start();
 
   function start() {
-    var node = spawn(process.execPath || process.argv[0], [emptyJsFile]);
-    node.on('exit', function(exitCode) {
-      if (exitCode !== 0) {
-        throw new Error('Error during node startup');
-      }
+    spawnNode(function() {
       starts++;
 
       if (go)
@@ -37,4 +69,85 @@ function startNode(conf) {
         bench.end(starts);
     });
   }
+
+  function spawnNode(cb) {
+    var node = spawn(process.execPath || process.argv[0], [script], {
+      env: env
+    });
+    node.on('exit', function(exitCode) {
+      if (exitCode !== 0) {
+        throw new Error('Error during node startup');
+      }
+      cb();
+    });
+  }
+}
+
+// Lay out `count` packages the way npm does: ten per top level package, nine
+// of them nested in its own node_modules. Every package requires its nested
+// ones and a few top level ones, which are found by walking up the tree.
+function makeTree(count) {
+  var top = Math.ceil(count / 10);
+  var requires = [];
+
+  rmrf(treeDir);
+  mkdirp(treeDir);
+  for (var i = 0; i < top; i++) {
+    var dir = path.join(treeDir, 'node_modules', 'pkg' + i);
+    var nested = [];
+    for (var j = 0; j < 9 && i * 10 + j + 1 < count; j++) {
+      nested.push('sub' + j);
+      makePackage(path.join(dir, 'node_modules', 'sub' + j),
+                  siblings(i));
+    }
+    makePackage(dir, nested.concat(siblings(i)));
+    requires.push('pkg' + i);
+  }
+
+  var main = path.join(treeDir, 'main.js');
+  fs.writeFileSync(main, requireAll(requires));
+  return main;
+}
+
+function siblings(i) {
+  var names = [];
+  for (var k = 1; k <= 3 && k <= i; k++)
+    names.push('pkg' + (i - k));
+  return names;
+}
+
+function makePackage(dir, requires) {
+  mkdirp(path.join(dir, 'lib'));
+  fs.writeFileSync(path.join(dir, 'package.json'),
+                   JSON.stringify({ main: './lib/index' }));
+  fs.writeFileSync(path.join(dir, 'lib', 'index.js'), requireAll(requires));
+}
+
+function requireAll(names) {
+  return names.map(function(name) {
+    return 'require(' + JSON.stringify(name) + ');\n';
+  }).join('');
+}
+
+function mkdirp(dir) {
+  if (fs.existsSync(dir))
+    return;
+  mkdirp(path.dirname(dir));
+  fs.mkdirSync(dir);
+}
+
+function rmrf(p) {
+  try {
+    var stats = fs.lstatSync(p);
+  } catch (e) {
+    return;
+  }
+  if (stats.isDirectory()) {
+    fs.readdirSync(p).forEach(function(name) {
+      rmrf(path.join(p, name));
+    });
+    fs.rmdirSync(p);
+  } else {
+    fs.unlinkSync(p);
+  }
 }
@@ -1,14 +1,17 @@
 var common = require('../common.js');
+var timers = require('timers');
 
 var bench = common.createBenchmark(main, {
   thousands: [500],
-  type: ['depth', 'breadth']
+  type: ['depth', 'breadth', 'sockets']
 });
 
 function main(conf) {
   var n = +conf.thousands * 1e3;
   if (conf.type === 'breadth')
     breadth(n);
+  else if (conf.type === 'sockets')
+    sockets(n);
   else
     depth(n);
 }
@@ -38,3 +41,37 @@ function breadth(N) {
     setTimeout(cb);
   }
 }
+
+// Models 100k keep-alive sockets with an idle timeout that gets refreshed
+// on every read, the way net.Socket does it.
+function sockets(N) {
+  var count = 1e5;
+  var items = new Array(count);
+  for (var i = 0; i < count; i++) {
+    items[i] = {
+      _idleTimeout: -1,
+      _idleStart: null,
+      _idleNext: null,
+      _idlePrev: null,
+      _onTimeout: onTimeout
+    };
+    timers.enroll(items[i], 120000 + i % 1000);
+    timers._unrefActive(items[i]);
+  }
+
+  var n = 0;
+  bench.start();
+  (function touch() {
+    for (var i = 0; i < 1e4; i++, n++)
+      timers._unrefActive(items[n % count]);
+    if (n < N)
+      return setImmediate(touch);
+    bench.end(N / 1e3);
+    for (var i = 0; i < count; i++)
+      timers.unenroll(items[i]);
+  })();
+
+  function onTimeout() {
+    throw new Error('should not time out');
+  }
+}
@@ -6,9 +6,12 @@ var PORT = common.PORT;
 // `num` is the number of send requests to queue up each time.
 // Keep it reasonably high (>10) otherwise you're benchmarking the speed of
 // event loop cycles more than anything else.
+// `batch` queues them up as one sendBatch() call instead and turns on
+// batched receives.
 var bench = common.createBenchmark(main, {
   len: [1, 64, 256, 1024],
   num: [100],
+  batch: [0, 1],
   type: ['send', 'recv'],
   dur: [5]
 });
@@ -16,16 +19,22 @@ var bench = common.createBenchmark(main, {
 var dur;
 var len;
 var num;
+var batch;
 var type;
 var chunk;
+var chunks;
 var encoding;
 
 function main(conf) {
   dur = +conf.dur;
   len = +conf.len;
   num = +conf.num;
+  batch = +conf.batch;
   type = conf.type;
   chunk = new Buffer(len);
+  chunks = [];
+  for (var i = 0; i < num; i++)
+    chunks.push(chunk);
   server();
 }
 
@@ -34,9 +43,14 @@ var dgram = require('dgram');
 function server() {
   var sent = 0;
   var received = 0;
-  var socket = dgram.createSocket('udp4');
+  var socket = dgram.createSocket({ type: 'udp4', batch: !!batch });
 
   function onsend() {
+    if (batch) {
+      sent += num;
+      socket.sendBatch(chunks, PORT, '127.0.0.1', onsend);
+      return;
+    }
     if (sent++ % num == 0)
       for (var i = 0; i < num; i++)
         socket.send(chunk, 0, chunk.length, PORT, '127.0.0.1', onsend);
@@ -53,9 +67,15 @@ function server() {
     }, dur * 1000);
   });
 
-  socket.on('message', function(buf, rinfo) {
-    received++;
-  });
+  if (batch) {
+    socket.on('messages', function(msgs, rinfos) {
+      received += msgs.length;
+    });
+  } else {
+    socket.on('message', function(buf, rinfo) {
+      received++;
+    });
+  }
 
   socket.bind(PORT);
 }
@@ -0,0 +1,50 @@
+// measure how many connections per second a server can accept.
+// the connectors run in a child process so they don't compete with the
+// server for the event loop.
+
+var common = require('../common.js');
+var PORT = common.PORT;
+var net = require('net');
+
+if (process.argv[2] === 'child')
+  return child(+process.argv[3]);
+
+var bench = common.createBenchmark(main, {
+  c: [1, 8, 64],
+  batch: [1, 64],
+  dur: [5]
+});
+
+function main(conf) {
+  var accepted = 0;
+
+  var server = net.createServer({ acceptBatch: +conf.batch }, function(socket) {
+    accepted++;
+    socket.destroy();
+  });
+
+  server.listen(PORT, function() {
+    var spawn = require('child_process').spawn;
+    var connector = spawn(process.execPath,
+                          [__filename, 'child', conf.c],
+                          { stdio: 'inherit' });
+    bench.start();
+
+    setTimeout(function() {
+      connector.kill();
+      bench.end(accepted);
+    }, conf.dur * 1000);
+  });
+}
+
+function child(c) {
+  for (var i = 0; i < c; i++)
+    connect();
+
+  function connect() {
+    var socket = net.connect(PORT);
+    socket.on('error', function() {});
+    socket.on('close', connect);
+    socket.resume();
+  }
+}
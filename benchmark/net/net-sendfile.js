@@ -0,0 +1,59 @@
+// serve a file over a socket with socket.sendFile() or a ReadStream pipe
+
+var path = require('path');
+var fs = require('fs');
+var net = require('net');
+var common = require('../common.js');
+var PORT = common.PORT;
+var filename = path.resolve(__dirname, '.removeme-benchmark-garbage');
+
+var bench = common.createBenchmark(main, {
+  size: [64 * 1024, 16 * 1024 * 1024],
+  method: ['sendfile', 'pipe'],
+  dur: [5]
+});
+
+function main(conf) {
+  var size = +conf.size;
+  var dur = +conf.dur;
+  var method = conf.method;
+
+  var chunk = new Buffer(size);
+  chunk.fill('x');
+  fs.writeFileSync(filename, chunk);
+  var fd = fs.openSync(filename, 'r');
+
+  // Sends the file over and over again until the benchmark is over
+  var server = net.createServer(function(socket) {
+    socket.on('error', function() {});
+    (function send() {
+      if (method === 'sendfile') {
+        socket.sendFile(fd, 0, size, send);
+      } else {
+        var rs = fs.createReadStream(null, { fd: fd,
+                                             start: 0,
+                                             end: size - 1,
+                                             autoClose: false });
+        rs.pipe(socket, { end: false });
+        rs.on('end', send);
+      }
+    })();
+  });
+
+  server.listen(PORT, function() {
+    var received = 0;
+    var socket = net.connect(PORT);
+    socket.on('connect', function() {
+      bench.start();
+      socket.on('data', function(data) {
+        received += data.length;
+      });
+      setTimeout(function() {
+        var gbits = (received * 8) / (1024 * 1024 * 1024);
+        bench.end(gbits);
+        fs.unlinkSync(filename);
+        process.exit(0);
+      }, dur * 1000);
+    });
+  });
+}
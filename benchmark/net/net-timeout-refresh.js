@@ -0,0 +1,32 @@
+// cost of refreshing a socket's idle timeout, which net.Socket does on every
+// read and write once socket.setTimeout() has been called
+
+var common = require('../common.js');
+var net = require('net');
+var timers = require('timers');
+
+var bench = common.createBenchmark(main, {
+  sockets: [1, 1000],
+  millions: [10]
+});
+
+function main(conf) {
+  var n = +conf.millions * 1e6;
+  var count = +conf.sockets;
+  var sockets = [];
+
+  for (var i = 0; i < count; i++) {
+    var socket = new net.Socket();
+    socket.setTimeout(120000);
+    sockets.push(socket);
+  }
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    timers._unrefActive(sockets[i % count]);
+  bench.end(n / 1e6);
+
+  sockets.forEach(function(socket) {
+    socket.setTimeout(0);
+  });
+}
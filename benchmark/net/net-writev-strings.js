@@ -0,0 +1,106 @@
+// test writing many small strings per tick, which the socket sends as one
+// writev() batch. `api` is either a corked net.Socket or an http response,
+// which corks the connection for chunked res.write() calls on its own.
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  api: ['net', 'http'],
+  type: ['ascii', 'utf8', 'mixed'],
+  num: [16, 256],
+  dur: [5]
+});
+
+var api;
+var num;
+var dur;
+var chunks;
+
+function main(conf) {
+  api = conf.api;
+  num = +conf.num;
+  dur = +conf.dur;
+
+  switch (conf.type) {
+    case 'ascii':
+      chunks = ['<li>item number one</li>\n', '<li>and two</li>\n'];
+      break;
+    case 'utf8':
+      chunks = ['<li>café crème</li>\n', '<li>中文</li>\n'];
+      break;
+    case 'mixed':
+      chunks = ['<li>item number one</li>\n', new Buffer('<li>and two</li>\n'),
+                '<li>café crème</li>\n', new Buffer('<br>\n')];
+      break;
+    default:
+      throw new Error('invalid type: ' + conf.type);
+  }
+
+  if (api === 'net')
+    netServer();
+  else
+    httpServer();
+}
+
+var net = require('net');
+var http = require('http');
+
+// Keep writing batches of `num` chunks, waiting for 'drain' whenever the
+// socket has enough queued up.
+function writeBatches(writable) {
+  function batch() {
+    var ok = true;
+    for (var i = 0; i < num; i++)
+      ok = writable.write(chunks[i % chunks.length]);
+    if (ok)
+      setImmediate(batch);
+    else
+      writable.once('drain', batch);
+  }
+  batch();
+}
+
+function netServer() {
+  var server = net.createServer(function(socket) {
+    function batch() {
+      socket.cork();
+      for (var i = 0; i < num; i++)
+        socket.write(chunks[i % chunks.length]);
+      socket.uncork();
+      if (socket._writableState.length === 0)
+        setImmediate(batch);
+      else
+        socket.once('drain', batch);
+    }
+    batch();
+  });
+  server.listen(PORT, function() {
+    client('');
+  });
+}
+
+function httpServer() {
+  var server = http.createServer(function(req, res) {
+    res.writeHead(200, { 'Content-Type': 'text/html' });
+    writeBatches(res);
+  });
+  server.listen(PORT, function() {
+    client('GET / HTTP/1.1\r\nHost: localhost\r\n\r\n');
+  });
+}
+
+function client(request) {
+  var bytes = 0;
+  var socket = net.connect(PORT, function() {
+    socket.write(request);
+    bench.start();
+    setTimeout(function() {
+      var gbits = (bytes * 8) / (1024 * 1024 * 1024);
+      bench.end(gbits);
+    }, dur * 1000);
+  });
+  socket.on('data', function(chunk) {
+    bytes += chunk.length;
+  });
+}
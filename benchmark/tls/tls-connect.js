@@ -1,64 +1,97 @@
 var assert = require('assert'),
+    fork = require('child_process').fork,
     fs = require('fs'),
     path = require('path'),
     tls = require('tls');
 
 var common = require('../common.js');
+
+// Clients run in a separate process so that only the server's handshakes
+// load the event loop being measured.
+if (process.env.TLS_CONNECT_CLIENTS)
+  return clients(+process.env.TLS_CONNECT_CLIENTS);
+
 var bench = common.createBenchmark(main, {
   concurrency: [1, 10],
+  async: [0, 1],
+  measure: ['conn', 'lag'],
   dur: [5]
 });
 
-var clientConn = 0;
 var serverConn = 0;
 var server;
+var child;
 var dur;
 var concurrency;
-var running = true;
+var measure;
+var maxLag = 0;
 
 function main(conf) {
   dur = +conf.dur;
   concurrency = +conf.concurrency;
+  measure = conf.measure;
 
   var cert_dir = path.resolve(__dirname, '../../test/fixtures'),
       options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
                   cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
                   ca: [ fs.readFileSync(cert_dir + '/test_ca.pem') ],
-                  ciphers: 'AES256-GCM-SHA384' };
+                  ciphers: 'AES256-GCM-SHA384',
+                  asyncHandshake: !!+conf.async };
 
   server = tls.createServer(options, onConnection);
   server.listen(common.PORT, onListening);
 }
 
 function onListening() {
-  setTimeout(done, dur * 1000);
-  bench.start();
-  for (var i = 0; i < concurrency; i++)
-    makeConnection();
+  child = fork(__filename, [], {
+    env: { TLS_CONNECT_CLIENTS: concurrency }
+  });
+  child.on('message', function() {
+    setTimeout(done, dur * 1000);
+    watchLag();
+    bench.start();
+  });
+}
+
+// Worst delay of a 1ms timer, i.e. how long other connections had to wait
+function watchLag() {
+  var last = process.hrtime();
+  setInterval(function() {
+    var delta = process.hrtime(last);
+    var lag = delta[0] * 1e3 + delta[1] / 1e6 - 1;
+    if (lag > maxLag)
+      maxLag = lag;
+    last = process.hrtime();
+  }, 1);
 }
 
 function onConnection(conn) {
   serverConn++;
+  conn.resume();
 }
 
-function makeConnection() {
-  var conn = tls.connect({ port: common.PORT,
-                           rejectUnauthorized: false }, function() {
-    clientConn++;
+function done() {
+  child.kill();
+  if (measure === 'lag')
+    bench.report(maxLag);
+  else
+    bench.end(serverConn);
+}
+
+function clients(concurrency) {
+  process.send('ready');
+  for (var i = 0; i < concurrency; i++)
+    makeConnection();
+
+  function makeConnection() {
+    var conn = tls.connect({ port: common.PORT,
+                             rejectUnauthorized: false }, function() {
+      conn.end();
+      makeConnection();
+    });
     conn.on('error', function(er) {
       console.error('client error', er);
       throw er;
     });
-    conn.end();
-    if (running) makeConnection();
-  });
-}
-
-function done() {
-  running = false;
-  // it's only an established connection if they both saw it.
-  // because we destroy the server somewhat abruptly, these
-  // don't always match.  Generally, serverConn will be
-  // the smaller number, but take the min just to be sure.
-  bench.end(Math.min(serverConn, clientConn));
+  }
 }
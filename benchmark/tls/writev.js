@@ -0,0 +1,66 @@
+var common = require('../common.js');
+var bench = common.createBenchmark(main, {
+  dur: [5],
+  size: [64, 1024, 16 * 1024],
+  chunks: [1, 16, 64]
+});
+
+var dur, size, chunks;
+var server;
+
+var path = require('path');
+var fs = require('fs');
+var cert_dir = path.resolve(__dirname, '../../test/fixtures');
+var options;
+var tls = require('tls');
+
+// Every write is a batch of `chunks` buffers of `size` bytes handed to the
+// TLS socket at once with cork()/uncork(), like a response made of headers
+// and a few body chunks.
+function main(conf) {
+  dur = +conf.dur;
+  size = +conf.size;
+  chunks = +conf.chunks;
+
+  var chunk = new Buffer(size);
+  chunk.fill('b');
+
+  options = { key: fs.readFileSync(cert_dir + '/test_key.pem'),
+              cert: fs.readFileSync(cert_dir + '/test_cert.pem'),
+              ca: [ fs.readFileSync(cert_dir + '/test_ca.pem') ],
+              ciphers: 'AES256-GCM-SHA384' };
+
+  server = tls.createServer(options, onConnection);
+  setTimeout(done, dur * 1000);
+  server.listen(common.PORT, function() {
+    var opt = { port: common.PORT, rejectUnauthorized: false };
+    var conn = tls.connect(opt, function() {
+      bench.start();
+      conn.on('drain', write);
+      write();
+    });
+
+    function write() {
+      do {
+        conn.cork();
+        for (var i = 0; i < chunks - 1; i++)
+          conn.write(chunk);
+        var more = conn.write(chunk);
+        conn.uncork();
+      } while (more !== false);
+    }
+  });
+
+  var received = 0;
+  function onConnection(conn) {
+    conn.on('data', function(chunk) {
+      received += chunk.length;
+    });
+  }
+
+  function done() {
+    var mbits = (received * 8) / (1024 * 1024);
+    bench.end(mbits);
+    process.exit(0);
+  }
+}
@@ -0,0 +1,61 @@
+// gzip JSON responses concurrently and measure how long a 1ms timer is
+// delayed, i.e. how long other work waits on the event loop meanwhile
+var common = require('../common.js');
+var zlib = require('zlib');
+
+var bench = common.createBenchmark(main, {
+  concurrency: [16],
+  len: [200 * 1024],
+  ring: [1, 16],
+  measure: ['lag', 'mb'],
+  dur: [5]
+});
+
+function main(conf) {
+  var json = new Buffer(JSON.stringify(makeRows(+conf.len)));
+  var opts = { ringSize: +conf.ring * zlib.Z_DEFAULT_CHUNK };
+  var running = true;
+  var bytes = 0;
+  var maxLag = 0;
+
+  for (var i = 0; i < +conf.concurrency; i++)
+    compress();
+
+  function compress() {
+    if (!running)
+      return;
+    var gzip = zlib.createGzip(opts);
+    gzip.on('data', function() {});
+    gzip.on('end', function() {
+      bytes += json.length;
+      compress();
+    });
+    gzip.end(json);
+  }
+
+  var last = process.hrtime();
+  var timer = setInterval(function() {
+    var delta = process.hrtime(last);
+    var lag = delta[0] * 1e3 + delta[1] / 1e6 - 1;
+    if (lag > maxLag)
+      maxLag = lag;
+    last = process.hrtime();
+  }, 1);
+
+  bench.start();
+  setTimeout(function() {
+    running = false;
+    clearInterval(timer);
+    if (conf.measure === 'lag')
+      bench.report(maxLag);
+    else
+      bench.end(bytes / (1024 * 1024));
+  }, +conf.dur * 1000);
+}
+
+function makeRows(len) {
+  var rows = [];
+  for (var size = 0; size < len; size += 64)
+    rows.push({ id: rows.length, name: 'row ' + rows.length, ok: true });
+  return rows;
+}
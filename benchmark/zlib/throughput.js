@@ -0,0 +1,61 @@
+// compress or decompress a JSON document as fast as possible
+var common = require('../common.js');
+var zlib = require('zlib');
+
+var bench = common.createBenchmark(main, {
+  type: ['gzip', 'deflate', 'gunzip', 'inflate'],
+  len: [1024, 200 * 1024],
+  ring: [1, 4, 16],
+  n: [500]
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var json = makeJSON(+conf.len);
+  var opts = { ringSize: +conf.ring * zlib.Z_DEFAULT_CHUNK };
+  var input = json;
+  var method = conf.type;
+
+  if (method === 'gunzip')
+    input = zlib.gzipSync(json);
+  else if (method === 'inflate')
+    input = zlib.deflateSync(json);
+
+  var create = {
+    gzip: zlib.createGzip,
+    deflate: zlib.createDeflate,
+    gunzip: zlib.createGunzip,
+    inflate: zlib.createInflate
+  }[method];
+
+  var bytes = 0;
+  var i = 0;
+  bench.start();
+  next();
+
+  function next() {
+    if (i++ === n)
+      return bench.end(bytes / (1024 * 1024));
+    var stream = create(opts);
+    stream.on('data', function() {});
+    stream.on('end', next);
+    stream.end(input);
+    bytes += json.length;
+  }
+}
+
+function makeJSON(len) {
+  var list = [];
+  var size = 2;
+  for (var i = 0; size < len; i++) {
+    var item = JSON.stringify({
+      id: i,
+      name: 'item ' + i,
+      tags: ['alpha', 'beta', 'gamma'].slice(i % 3),
+      price: (i * 7919) % 10000 / 100
+    });
+    list.push(item);
+    size += item.length + 1;
+  }
+  return new Buffer('[' + list.join(',') + ']').slice(0, len);
+}
@@ -32,6 +32,9 @@ struct uv__work {
   void (*done)(struct uv__work *w, int status);
   struct uv_loop_s* loop;
   void* wq[2];
+  unsigned int kind;
+  unsigned int shard;
+  uint64_t queued_time;
 };
 
 #endif /* UV_THREADPOOL_H_ */
@@ -192,6 +192,9 @@ typedef struct {
   uv__io_t signal_io_watcher;                                                 \
   uv_signal_t child_watcher;                                                  \
   int emfile_fd;                                                              \
+  uv_loop_timing_cb timing_cb;                                                \
+  uint64_t timing_mark;                                                       \
+  uint64_t timing[UV_LOOP_PHASE_MAX];                                         \
   UV_PLATFORM_LOOP_FIELDS                                                     \
 
 #define UV_REQ_TYPE_PRIVATE /* empty */
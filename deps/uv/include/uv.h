@@ -328,6 +328,38 @@ UV_EXTERN int uv_loop_alive(const uv_loop_t* loop);
  */
 UV_EXTERN void uv_stop(uv_loop_t*);
 
+/*
+ * The phases of a loop iteration, in the order in which they run. The poll
+ * phase is split in the time spent blocked waiting for events and the time
+ * spent running the callbacks of the events that came in.
+ */
+typedef enum {
+  UV_LOOP_PHASE_TIMERS,
+  UV_LOOP_PHASE_PENDING,
+  UV_LOOP_PHASE_IDLE,
+  UV_LOOP_PHASE_PREPARE,
+  UV_LOOP_PHASE_POLL_WAIT,
+  UV_LOOP_PHASE_POLL_IO,
+  UV_LOOP_PHASE_CHECK,
+  UV_LOOP_PHASE_CLOSING,
+  UV_LOOP_PHASE_MAX
+} uv_loop_phase;
+
+/*
+ * Called at the end of every loop iteration with the time, in nanoseconds,
+ * spent in each phase. `timing` is indexed by uv_loop_phase.
+ */
+typedef void (*uv_loop_timing_cb)(uv_loop_t* loop, const uint64_t* timing);
+
+/*
+ * Start timing the phases of each iteration of the loop, or stop when `cb` is
+ * NULL. Timing costs a few calls to uv_hrtime() per iteration while enabled
+ * and nothing otherwise.
+ *
+ * Returns UV_ENOSYS on Windows.
+ */
+UV_EXTERN int uv_loop_set_timing_cb(uv_loop_t* loop, uv_loop_timing_cb cb);
+
 /*
  * Manually modify the event loop's reference count. Useful if the user wants
  * to have a handle or timeout that doesn't keep the loop alive.
@@ -648,6 +680,20 @@ UV_EXTERN int uv_listen(uv_stream_t* stream, int backlog, uv_connection_cb cb);
  */
 UV_EXTERN int uv_accept(uv_stream_t* server, uv_stream_t* client);
 
+/*
+ * Take the next pending connection off the listen backlog without waiting
+ * for the event loop to poll the server again. Returns 0 when a connection
+ * is ready, which must then be claimed with uv_accept(). Returns UV_EAGAIN
+ * when the backlog is empty and another error code when accept() fails; in
+ * both cases the connection callback reports whatever comes next, as usual.
+ *
+ * Only valid from within the uv_connection_cb, after the connection it
+ * announced has been accepted. Lets the caller drain a burst of
+ * connections in one go. Not implemented on Windows, where it always
+ * returns UV_EAGAIN.
+ */
+UV_EXTERN int uv_accept_next(uv_stream_t* server);
+
 /*
  * Read data from an incoming stream. The callback will be made several
  * times until there is no more data to read or uv_read_stop() is called.
@@ -811,7 +857,15 @@ UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
 
 enum uv_tcp_flags {
   /* Used with uv_tcp_bind, when an IPv6 address is used. */
-  UV_TCP_IPV6ONLY = 1
+  UV_TCP_IPV6ONLY = 1,
+
+  /*
+   * Used with uv_tcp_bind. Sets SO_REUSEPORT so that several sockets, usually
+   * in different processes, can listen on the same address and port, with the
+   * kernel distributing incoming connections between them. Fails with
+   * UV_ENOTSUP on platforms that don't support SO_REUSEPORT.
+   */
+  UV_TCP_REUSEPORT = 2
 };
 
 /*
@@ -876,7 +930,23 @@ enum uv_udp_flags {
    * (provided they all set the flag) but only the last one to bind will receive
    * any traffic, in effect "stealing" the port from the previous listener.
    */
-  UV_UDP_REUSEADDR = 4
+  UV_UDP_REUSEADDR = 4,
+  /*
+   * Indicates that the message was received with recvmmsg() and that buf
+   * points into the larger buffer returned by the alloc callback. Used in
+   * uv_udp_recv_cb. Once all datagrams of the batch have been delivered,
+   * recv_cb is invoked one more time with nread == 0, addr == NULL and the
+   * original buffer so that it can be released.
+   */
+  UV_UDP_MMSG_CHUNK = 8,
+  /*
+   * Receive several datagrams per system call with recvmmsg(). Pass it to
+   * uv_udp_bind(). The alloc callback is asked for a buffer big enough for
+   * a full batch, which is then split in slots of 64 KB; a smaller buffer is
+   * used as a single slot. Queued sends also go out several at a time with
+   * sendmmsg(). Only has an effect on Linux, other platforms ignore the flag.
+   */
+  UV_UDP_RECVMMSG = 256
 };
 
 /*
@@ -1711,6 +1781,55 @@ UV_EXTERN int uv_queue_work(uv_loop_t* loop,
                             uv_work_cb work_cb,
                             uv_after_work_cb after_work_cb);
 
+/*
+ * Work submitted to the thread pool is sorted into classes. Workers take turns
+ * between the classes so that a backlog in one class does not starve the
+ * others, and at most half of the threads run slow I/O at any time.
+ *
+ * - UV_WORK_FAST_IO: file system requests.
+ * - UV_WORK_CPU: uv_queue_work() requests.
+ * - UV_WORK_SLOW_IO: DNS requests (uv_getaddrinfo() and uv_getnameinfo()) and
+ *   uv_fs_sendfile(), which waits for the target fd when it's a socket.
+ */
+typedef enum {
+  UV_WORK_FAST_IO = 0,
+  UV_WORK_CPU,
+  UV_WORK_SLOW_IO,
+  UV_WORK_CLASS_MAX
+} uv_work_class;
+
+/*
+ * Like uv_queue_work() but the request goes into class `kind`. Meant for work
+ * that is really file system or slow I/O, like a sequence of file system calls
+ * done in one go.
+ *
+ * Returns 0 on success, UV_EINVAL if `work_cb` is NULL or `kind` is not a
+ * valid class.
+ */
+UV_EXTERN int uv_queue_work_class(uv_loop_t* loop,
+                                  uv_work_t* req,
+                                  uv_work_class kind,
+                                  uv_work_cb work_cb,
+                                  uv_after_work_cb after_work_cb);
+
+typedef struct {
+  uint64_t queued;         /* Requests waiting for a thread. */
+  uint64_t dispatched;     /* Requests handed to a thread so far. */
+  uint64_t wait_time;      /* Total time dispatched requests spent queued. */
+  uint64_t max_wait_time;  /* Longest time a request spent queued. */
+} uv_work_class_stats_t;
+
+typedef struct {
+  unsigned int threads;
+  uv_work_class_stats_t classes[UV_WORK_CLASS_MAX];
+} uv_threadpool_stats_t;
+
+/*
+ * Fills in `stats` with a snapshot of the thread pool counters. Times are in
+ * nanoseconds. All counters are zero until the first request is queued.
+ */
+UV_EXTERN void uv_threadpool_stats(uv_threadpool_stats_t* stats);
+
 /* Cancel a pending request. Fails if the request is executing or has finished
  * executing.
  *
@@ -38,17 +38,35 @@ static void uv__req_init(uv_loop_t* loop,
 #endif
 
 #include <stdlib.h>
+#include <string.h>  /* memset */
 
 #define MAX_THREADPOOL_SIZE 128
 
+/* Every worker thread owns a shard: a lock, a condition variable and one queue
+ * per work class. post() spreads requests over the shards and workers that
+ * run out of work in their own shard steal from the others, so the lock that
+ * protects a queue is only contended by the posting thread and the odd thief.
+ */
+struct uv__shard {
+  uv_mutex_t mutex;
+  uv_cond_t cond;
+  QUEUE wq[UV_WORK_CLASS_MAX];
+  uv_work_class_stats_t stats[UV_WORK_CLASS_MAX];
+  int idle;    /* Worker is about to sleep or sleeping on `cond`. */
+  int wakeup;  /* Set by post() to wake up an idle worker. */
+};
+
 static uv_once_t once = UV_ONCE_INIT;
-static uv_cond_t cond;
-static uv_mutex_t mutex;
 static unsigned int nthreads;
 static uv_thread_t* threads;
 static uv_thread_t default_threads[4];
-static QUEUE exit_message;
-static QUEUE wq;
+static struct uv__shard* shards;
+static struct uv__shard default_shards[4];
+static unsigned int next_shard;
+static uv_mutex_t slow_io_mutex;
+static unsigned int slow_io_running;
+static unsigned int slow_io_max;
+static volatile int exiting;
 static volatile int initialized;
 
 
@@ -57,39 +75,137 @@ static void uv__cancelled(struct uv__work* w) {
 }
 
 
-/* To avoid deadlock with uv_cancel() it's crucial that the worker
- * never holds the global mutex and the loop-local mutex at the same time.
+static int slow_io_acquire(void) {
+  int acquired;
+
+  uv_mutex_lock(&slow_io_mutex);
+  acquired = slow_io_running < slow_io_max;
+  if (acquired)
+    slow_io_running++;
+  uv_mutex_unlock(&slow_io_mutex);
+
+  return acquired;
+}
+
+
+static void slow_io_release(void) {
+  uv_mutex_lock(&slow_io_mutex);
+  slow_io_running--;
+  uv_mutex_unlock(&slow_io_mutex);
+}
+
+
+/* Dequeues the next runnable request from `shard`, starting with work class
+ * `first` so that workers take turns between the classes. Returns NULL if
+ * there is nothing the caller may run.
  */
-static void worker(void* arg) {
+static struct uv__work* shard_take(struct uv__shard* shard,
+                                   unsigned int first) {
+  uv_work_class_stats_t* stats;
   struct uv__work* w;
+  unsigned int kind;
+  unsigned int i;
+  uint64_t wait;
   QUEUE* q;
 
-  (void) arg;
+  w = NULL;
+  uv_mutex_lock(&shard->mutex);
 
-  for (;;) {
-    uv_mutex_lock(&mutex);
+  for (i = 0; i < UV_WORK_CLASS_MAX; i++) {
+    kind = (first + i) % UV_WORK_CLASS_MAX;
 
-    while (QUEUE_EMPTY(&wq))
-      uv_cond_wait(&cond, &mutex);
+    if (QUEUE_EMPTY(&shard->wq[kind]))
+      continue;
 
-    q = QUEUE_HEAD(&wq);
+    if (kind == UV_WORK_SLOW_IO && !slow_io_acquire())
+      continue;
 
-    if (q == &exit_message)
-      uv_cond_signal(&cond);
-    else {
-      QUEUE_REMOVE(q);
-      QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is
-                             executing. */
-    }
+    q = QUEUE_HEAD(&shard->wq[kind]);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);  /* Signal uv_cancel() that the work req is executing. */
 
-    uv_mutex_unlock(&mutex);
+    w = QUEUE_DATA(q, struct uv__work, wq);
+    wait = uv_hrtime() - w->queued_time;
+
+    stats = &shard->stats[kind];
+    stats->queued--;
+    stats->dispatched++;
+    stats->wait_time += wait;
+    if (stats->max_wait_time < wait)
+      stats->max_wait_time = wait;
+    break;
+  }
 
-    if (q == &exit_message)
-      break;
+  uv_mutex_unlock(&shard->mutex);
+
+  return w;
+}
+
+
+/* Tries the worker's own shard first, then steals from the others. */
+static struct uv__work* next_work(unsigned int self, unsigned int first) {
+  struct uv__work* w;
+  unsigned int i;
+
+  for (i = 0; i < nthreads; i++) {
+    w = shard_take(shards + (self + i) % nthreads, first);
+    if (w != NULL)
+      return w;
+  }
+
+  return NULL;
+}
+
+
+/* To avoid deadlock with uv_cancel() it's crucial that the worker
+ * never holds a shard mutex and the loop-local mutex at the same time.
+ */
+static void worker(void* arg) {
+  struct uv__shard* shard;
+  struct uv__work* w;
+  unsigned int first;
+  unsigned int self;
+
+  self = (unsigned int) (uintptr_t) arg;
+  shard = shards + self;
+  first = 0;
+
+  for (;;) {
+    w = next_work(self, first);
+
+    if (w == NULL) {
+      /* Announce that we are going to sleep before looking one last time.
+       * post() either sees the flag and wakes us up or queued its request
+       * before the second scan, which then finds it.
+       */
+      uv_mutex_lock(&shard->mutex);
+      shard->idle = 1;
+      uv_mutex_unlock(&shard->mutex);
+
+      w = next_work(self, first);
+
+      uv_mutex_lock(&shard->mutex);
+      if (w == NULL)
+        while (shard->wakeup == 0 && exiting == 0)
+          uv_cond_wait(&shard->cond, &shard->mutex);
+      shard->idle = 0;
+      shard->wakeup = 0;
+      uv_mutex_unlock(&shard->mutex);
+
+      if (w == NULL) {
+        if (exiting)
+          break;
+        continue;
+      }
+    }
+
+    first = (w->kind + 1) % UV_WORK_CLASS_MAX;
 
-    w = QUEUE_DATA(q, struct uv__work, wq);
     w->work(w);
 
+    if (w->kind == UV_WORK_SLOW_IO)
+      slow_io_release();
+
     uv_mutex_lock(&w->loop->wq_mutex);
     w->work = NULL;  /* Signal uv_cancel() that the work req is done
                         executing. */
@@ -100,11 +216,48 @@ static void worker(void* arg) {
 }
 
 
-static void post(QUEUE* q) {
-  uv_mutex_lock(&mutex);
-  QUEUE_INSERT_TAIL(&wq, q);
-  uv_cond_signal(&cond);
-  uv_mutex_unlock(&mutex);
+static int shard_wakeup(struct uv__shard* shard) {
+  int idle;
+
+  idle = shard->idle;
+  if (idle && shard->wakeup == 0) {
+    shard->wakeup = 1;
+    uv_cond_signal(&shard->cond);
+  }
+
+  return idle;
+}
+
+
+static void post(struct uv__work* w) {
+  struct uv__shard* shard;
+  unsigned int index;
+  unsigned int i;
+  int idle;
+
+  /* Racy on purpose, it only balances the load. */
+  index = next_shard++ % nthreads;
+  shard = shards + index;
+
+  w->shard = index;
+  w->queued_time = uv_hrtime();
+
+  uv_mutex_lock(&shard->mutex);
+  QUEUE_INSERT_TAIL(&shard->wq[w->kind], &w->wq);
+  shard->stats[w->kind].queued++;
+  idle = shard_wakeup(shard);
+  uv_mutex_unlock(&shard->mutex);
+
+  if (idle)
+    return;
+
+  /* The owner is busy, hand the request to an idle worker instead. */
+  for (i = 1; i < nthreads && !idle; i++) {
+    shard = shards + (index + i) % nthreads;
+    uv_mutex_lock(&shard->mutex);
+    idle = shard_wakeup(shard);
+    uv_mutex_unlock(&shard->mutex);
+  }
 }
 
 
@@ -115,20 +268,34 @@ UV_DESTRUCTOR(static void cleanup(void)) {
   if (initialized == 0)
     return;
 
-  post(&exit_message);
+  /* Workers exit once they run out of work. */
+  for (i = 0; i < nthreads; i++) {
+    uv_mutex_lock(&shards[i].mutex);
+    exiting = 1;
+    uv_cond_signal(&shards[i].cond);
+    uv_mutex_unlock(&shards[i].mutex);
+  }
 
   for (i = 0; i < nthreads; i++)
     if (uv_thread_join(threads + i))
       abort();
 
-  if (threads != default_threads)
+  for (i = 0; i < nthreads; i++) {
+    uv_mutex_destroy(&shards[i].mutex);
+    uv_cond_destroy(&shards[i].cond);
+  }
+
+  if (threads != default_threads) {
     free(threads);
+    free(shards);
+  }
 
-  uv_mutex_destroy(&mutex);
-  uv_cond_destroy(&cond);
+  uv_mutex_destroy(&slow_io_mutex);
 
   threads = NULL;
+  shards = NULL;
   nthreads = 0;
+  exiting = 0;
   initialized = 0;
 }
 #endif
@@ -136,6 +303,7 @@ UV_DESTRUCTOR(static void cleanup(void)) {
 
 static void init_once(void) {
   unsigned int i;
+  unsigned int j;
   const char* val;
 
   nthreads = ARRAY_SIZE(default_threads);
@@ -148,24 +316,38 @@ static void init_once(void) {
     nthreads = MAX_THREADPOOL_SIZE;
 
   threads = default_threads;
+  shards = default_shards;
   if (nthreads > ARRAY_SIZE(default_threads)) {
     threads = malloc(nthreads * sizeof(threads[0]));
-    if (threads == NULL) {
+    shards = malloc(nthreads * sizeof(shards[0]));
+    if (threads == NULL || shards == NULL) {
+      free(threads);
+      free(shards);
       nthreads = ARRAY_SIZE(default_threads);
       threads = default_threads;
+      shards = default_shards;
     }
   }
 
-  if (uv_cond_init(&cond))
+  /* Leave at least half of the threads for file system and CPU work. */
+  slow_io_max = (nthreads + 1) / 2;
+  if (uv_mutex_init(&slow_io_mutex))
     abort();
 
-  if (uv_mutex_init(&mutex))
-    abort();
+  memset(shards, 0, nthreads * sizeof(shards[0]));
+  for (i = 0; i < nthreads; i++) {
+    if (uv_cond_init(&shards[i].cond))
+      abort();
 
-  QUEUE_INIT(&wq);
+    if (uv_mutex_init(&shards[i].mutex))
+      abort();
+
+    for (j = 0; j < UV_WORK_CLASS_MAX; j++)
+      QUEUE_INIT(&shards[i].wq[j]);
+  }
 
   for (i = 0; i < nthreads; i++)
-    if (uv_thread_create(threads + i, worker, NULL))
+    if (uv_thread_create(threads + i, worker, (void*) (uintptr_t) i))
       abort();
 
   initialized = 1;
@@ -174,28 +356,35 @@ static void init_once(void) {
 
 void uv__work_submit(uv_loop_t* loop,
                      struct uv__work* w,
+                     uv_work_class kind,
                      void (*work)(struct uv__work* w),
                      void (*done)(struct uv__work* w, int status)) {
   uv_once(&once, init_once);
   w->loop = loop;
   w->work = work;
   w->done = done;
-  post(&w->wq);
+  w->kind = kind;
+  post(w);
 }
 
 
 static int uv__work_cancel(uv_loop_t* loop, uv_req_t* req, struct uv__work* w) {
+  struct uv__shard* shard;
   int cancelled;
 
-  uv_mutex_lock(&mutex);
+  shard = shards + w->shard;
+
+  uv_mutex_lock(&shard->mutex);
   uv_mutex_lock(&w->loop->wq_mutex);
 
   cancelled = !QUEUE_EMPTY(&w->wq) && w->work != NULL;
-  if (cancelled)
+  if (cancelled) {
     QUEUE_REMOVE(&w->wq);
+    shard->stats[w->kind].queued--;
+  }
 
   uv_mutex_unlock(&w->loop->wq_mutex);
-  uv_mutex_unlock(&mutex);
+  uv_mutex_unlock(&shard->mutex);
 
   if (!cancelled)
     return UV_EBUSY;
@@ -238,6 +427,35 @@ void uv__work_done(uv_async_t* handle) {
 }
 
 
+void uv_threadpool_stats(uv_threadpool_stats_t* stats) {
+  uv_work_class_stats_t* total;
+  uv_work_class_stats_t* part;
+  unsigned int i;
+  unsigned int j;
+
+  memset(stats, 0, sizeof(*stats));
+
+  if (initialized == 0)
+    return;
+
+  stats->threads = nthreads;
+
+  for (i = 0; i < nthreads; i++) {
+    uv_mutex_lock(&shards[i].mutex);
+    for (j = 0; j < UV_WORK_CLASS_MAX; j++) {
+      total = &stats->classes[j];
+      part = &shards[i].stats[j];
+      total->queued += part->queued;
+      total->dispatched += part->dispatched;
+      total->wait_time += part->wait_time;
+      if (total->max_wait_time < part->max_wait_time)
+        total->max_wait_time = part->max_wait_time;
+    }
+    uv_mutex_unlock(&shards[i].mutex);
+  }
+}
+
+
 static void uv__queue_work(struct uv__work* w) {
   uv_work_t* req = container_of(w, uv_work_t, work_req);
 
@@ -262,14 +480,30 @@ int uv_queue_work(uv_loop_t* loop,
                   uv_work_t* req,
                   uv_work_cb work_cb,
                   uv_after_work_cb after_work_cb) {
+  return uv_queue_work_class(loop, req, UV_WORK_CPU, work_cb, after_work_cb);
+}
+
+
+int uv_queue_work_class(uv_loop_t* loop,
+                        uv_work_t* req,
+                        uv_work_class kind,
+                        uv_work_cb work_cb,
+                        uv_after_work_cb after_work_cb) {
   if (work_cb == NULL)
     return UV_EINVAL;
 
+  if ((unsigned) kind >= UV_WORK_CLASS_MAX)
+    return UV_EINVAL;
+
   uv__req_init(loop, req, UV_WORK);
   req->loop = loop;
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
-  uv__work_submit(loop, &req->work_req, uv__queue_work, uv__queue_done);
+  uv__work_submit(loop,
+                  &req->work_req,
+                  kind,
+                  uv__queue_work,
+                  uv__queue_done);
   return 0;
 }
 
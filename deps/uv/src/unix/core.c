@@ -75,6 +75,7 @@
 #endif
 
 static void uv__run_pending(uv_loop_t* loop);
+static void uv__timing_end(uv_loop_t* loop);
 
 /* Verify that uv_buf_t is ABI-compatible with struct iovec. */
 STATIC_ASSERT(sizeof(uv_buf_t) == sizeof(struct iovec));
@@ -276,28 +277,56 @@ int uv_loop_alive(const uv_loop_t* loop) {
 
 int uv_run(uv_loop_t* loop, uv_run_mode mode) {
   int timeout;
+  int busy;
   int r;
 
   r = uv__loop_alive(loop);
   if (!r)
     uv__update_time(loop);
 
+  uv__timing_begin(loop);
+
+  /* Phases that have nothing to do don't get a timing mark. They take next
+   * to no time and reading the clock doesn't come for free.
+   */
   while (r != 0 && loop->stop_flag == 0) {
     UV_TICK_START(loop, mode);
 
     uv__update_time(loop);
     uv__run_timers(loop);
+    uv__timing_mark(loop, UV_LOOP_PHASE_TIMERS);
+
+    busy = !QUEUE_EMPTY(&loop->pending_queue);
     uv__run_pending(loop);
+    if (busy)
+      uv__timing_mark(loop, UV_LOOP_PHASE_PENDING);
+
+    busy = !QUEUE_EMPTY(&loop->idle_handles);
     uv__run_idle(loop);
+    if (busy)
+      uv__timing_mark(loop, UV_LOOP_PHASE_IDLE);
+
+    busy = !QUEUE_EMPTY(&loop->prepare_handles);
     uv__run_prepare(loop);
+    if (busy)
+      uv__timing_mark(loop, UV_LOOP_PHASE_PREPARE);
 
     timeout = 0;
     if ((mode & UV_RUN_NOWAIT) == 0)
       timeout = uv_backend_timeout(loop);
 
     uv__io_poll(loop, timeout);
+    uv__timing_mark(loop, UV_LOOP_PHASE_POLL_IO);
+
+    busy = !QUEUE_EMPTY(&loop->check_handles);
     uv__run_check(loop);
+    if (busy)
+      uv__timing_mark(loop, UV_LOOP_PHASE_CHECK);
+
+    busy = loop->closing_handles != NULL;
     uv__run_closing_handles(loop);
+    if (busy)
+      uv__timing_mark(loop, UV_LOOP_PHASE_CLOSING);
 
     if (mode == UV_RUN_ONCE) {
       /* UV_RUN_ONCE implies forward progess: at least one callback must have
@@ -310,9 +339,11 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
        */
       uv__update_time(loop);
       uv__run_timers(loop);
+      uv__timing_mark(loop, UV_LOOP_PHASE_TIMERS);
     }
 
     r = uv__loop_alive(loop);
+    uv__timing_end(loop);
     UV_TICK_STOP(loop, mode);
 
     if (mode & (UV_RUN_ONCE | UV_RUN_NOWAIT))
@@ -329,6 +360,38 @@ int uv_run(uv_loop_t* loop, uv_run_mode mode) {
 }
 
 
+int uv_loop_set_timing_cb(uv_loop_t* loop, uv_loop_timing_cb cb) {
+  /* May be called halfway through an iteration, start from here. */
+  memset(loop->timing, 0, sizeof(loop->timing));
+  loop->timing_mark = uv__hrtime(UV_CLOCK_PRECISE);
+  loop->timing_cb = cb;
+  return 0;
+}
+
+
+static void uv__timing_end(uv_loop_t* loop) {
+  uint64_t* timing;
+
+  if (loop->timing_cb == NULL)
+    return;
+
+  /* The poll phase was charged in full, take the time spent blocked out. */
+  timing = loop->timing;
+  if (timing[UV_LOOP_PHASE_POLL_IO] >= timing[UV_LOOP_PHASE_POLL_WAIT])
+    timing[UV_LOOP_PHASE_POLL_IO] -= timing[UV_LOOP_PHASE_POLL_WAIT];
+  else
+    timing[UV_LOOP_PHASE_POLL_IO] = 0;
+
+  loop->timing_cb(loop, timing);
+  memset(timing, 0, sizeof(loop->timing));
+
+  /* Don't charge the tail of this iteration and the callback to the timers
+   * of the next one.
+   */
+  loop->timing_mark = uv__hrtime(UV_CLOCK_PRECISE);
+}
+
+
 void uv_update_time(uv_loop_t* loop) {
   uv__update_time(loop);
 }
@@ -565,6 +628,20 @@ int uv__dup(int fd) {
 }
 
 
+int uv__getiovmax(void) {
+#if defined(IOV_MAX)
+  return IOV_MAX;
+#elif defined(_SC_IOV_MAX)
+  static int iovmax = -1;
+  if (iovmax == -1)
+    iovmax = sysconf(_SC_IOV_MAX);
+  return iovmax;
+#else
+  return 1024;
+#endif
+}
+
+
 ssize_t uv__recvmsg(int fd, struct msghdr* msg, int flags) {
   struct cmsghdr* cmsg;
   ssize_t rc;
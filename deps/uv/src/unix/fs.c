@@ -114,7 +114,11 @@
 #define POST                                                                  \
   do {                                                                        \
     if ((cb) != NULL) {                                                       \
-      uv__work_submit((loop), &(req)->work_req, uv__fs_work, uv__fs_done);    \
+      uv__work_submit((loop),                                                 \
+                      &(req)->work_req,                                       \
+                      uv__fs_work_class((req)->fs_type),                      \
+                      uv__fs_work,                                            \
+                      uv__fs_done);                                           \
       return 0;                                                               \
     }                                                                         \
     else {                                                                    \
@@ -126,6 +130,16 @@
   while (0)
 
 
+/* sendfile() can wait for a slow peer to drain its socket, keep it from
+ * starving the other file system requests.
+ */
+static uv_work_class uv__fs_work_class(uv_fs_type fs_type) {
+  if (fs_type == UV_FS_SENDFILE)
+    return UV_WORK_SLOW_IO;
+  return UV_WORK_FAST_IO;
+}
+
+
 static ssize_t uv__fs_fdatasync(uv_fs_t* req) {
 #if defined(__linux__) || defined(__sun) || defined(__NetBSD__)
   return fdatasync(req->file);
@@ -231,6 +245,13 @@ static ssize_t uv__fs_read(uv_fs_t* req) {
     return -1;
   }
 #endif /* defined(_AIX) */
+
+  /* Limit iov count to avoid EINVALs from readv(), the caller sees a short
+   * read instead.
+   */
+  if (req->nbufs > (unsigned int) uv__getiovmax())
+    req->nbufs = uv__getiovmax();
+
   if (req->off < 0) {
     if (req->nbufs == 1)
       result = read(req->file, req->bufs[0].base, req->bufs[0].len);
@@ -393,8 +414,31 @@ static ssize_t uv__fs_readlink(uv_fs_t* req) {
 }
 
 
-static ssize_t uv__fs_sendfile_emul(uv_fs_t* req) {
+/* Waits until a non-blocking out_fd is writable again. Returns 0 on success,
+ * -1 with errno set on error.
+ */
+static int uv__fs_sendfile_wait(int out_fd) {
   struct pollfd pfd;
+  int n;
+
+  pfd.fd = out_fd;
+  pfd.events = POLLOUT;
+  pfd.revents = 0;
+
+  do
+    n = poll(&pfd, 1, -1);
+  while (n == -1 && errno == EINTR);
+
+  if (n == -1 || (pfd.revents & ~POLLOUT) != 0) {
+    errno = EIO;
+    return -1;
+  }
+
+  return 0;
+}
+
+
+static ssize_t uv__fs_sendfile_emul(uv_fs_t* req) {
   int use_pread;
   off_t offset;
   ssize_t nsent;
@@ -480,16 +524,7 @@ static ssize_t uv__fs_sendfile_emul(uv_fs_t* req) {
         goto out;
       }
 
-      pfd.fd = out_fd;
-      pfd.events = POLLOUT;
-      pfd.revents = 0;
-
-      do
-        n = poll(&pfd, 1, -1);
-      while (n == -1 && errno == EINTR);
-
-      if (n == -1 || (pfd.revents & ~POLLOUT) != 0) {
-        errno = EIO;
+      if (uv__fs_sendfile_wait(out_fd)) {
         nsent = -1;
         goto out;
       }
@@ -519,8 +554,16 @@ static ssize_t uv__fs_sendfile(uv_fs_t* req) {
     off_t off;
     ssize_t r;
 
-    off = req->off;
-    r = sendfile(out_fd, in_fd, &off, req->bufsml[0].len);
+    /* A non-blocking out_fd (a socket) returns EAGAIN when nothing could be
+     * sent, wait until it's writable like the emulation does.
+     */
+    do {
+      off = req->off;
+      r = sendfile(out_fd, in_fd, &off, req->bufsml[0].len);
+    } while (r == -1 &&
+             off == req->off &&
+             (errno == EINTR ||
+              (errno == EAGAIN && uv__fs_sendfile_wait(out_fd) == 0)));
 
     /* sendfile() on SunOS returns EINVAL if the target fd is not a socket but
      * it still writes out data. Fortunately, we can detect it by checking if
@@ -552,15 +595,23 @@ static ssize_t uv__fs_sendfile(uv_fs_t* req) {
      * number of bytes have been sent, we don't consider it an error.
      */
 
+    for (;;) {
 #if defined(__FreeBSD__)
-    len = 0;
-    r = sendfile(in_fd, out_fd, req->off, req->bufsml[0].len, NULL, &len, 0);
+      len = 0;
+      r = sendfile(in_fd, out_fd, req->off, req->bufsml[0].len, NULL, &len, 0);
 #else
-    /* The darwin sendfile takes len as an input for the length to send,
-     * so make sure to initialize it with the caller's value. */
-    len = req->bufsml[0].len;
-    r = sendfile(in_fd, out_fd, req->off, &len, NULL, 0);
+      /* The darwin sendfile takes len as an input for the length to send,
+       * so make sure to initialize it with the caller's value. */
+      len = req->bufsml[0].len;
+      r = sendfile(in_fd, out_fd, req->off, &len, NULL, 0);
 #endif
+      if (r != -1 || len != 0)
+        break;
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN || uv__fs_sendfile_wait(out_fd))
+        break;
+    }
 
     if (r != -1 || len != 0) {
       req->off += len;
@@ -607,6 +658,10 @@ static ssize_t uv__fs_write(uv_fs_t* req) {
   pthread_mutex_lock(&lock);
 #endif
 
+  /* Same as uv__fs_read(), a huge nbufs results in a short write. */
+  if (req->nbufs > (unsigned int) uv__getiovmax())
+    req->nbufs = uv__getiovmax();
+
   if (req->off < 0) {
     if (req->nbufs == 1)
       r = write(req->file, req->bufs[0].base, req->bufs[0].len);
@@ -143,7 +143,8 @@ enum {
   UV_TCP_NODELAY          = 0x400,  /* Disable Nagle. */
   UV_TCP_KEEPALIVE        = 0x800,  /* Turn on keep-alive. */
   UV_TCP_SINGLE_ACCEPT    = 0x1000, /* Only accept() when idle. */
-  UV_HANDLE_IPV6          = 0x2000  /* Handle is bound to a IPv6 socket. */
+  UV_HANDLE_IPV6          = 0x2000, /* Handle is bound to a IPv6 socket. */
+  UV_UDP_PROCESSING_MMSG  = 0x10000 /* Use recvmmsg() and sendmmsg(). */
 };
 
 typedef enum {
@@ -164,6 +165,7 @@ int uv__close(int fd);
 int uv__cloexec(int fd, int set);
 int uv__socket(int domain, int type, int protocol);
 int uv__dup(int fd);
+int uv__getiovmax(void);
 ssize_t uv__recvmsg(int fd, struct msghdr *msg, int flags);
 void uv__make_close_pending(uv_handle_t* handle);
 
@@ -296,6 +298,40 @@ UV_UNUSED(static void uv__update_time(uv_loop_t* loop)) {
   loop->time = uv__hrtime(UV_CLOCK_FAST) / 1000000;
 }
 
+/* Phase timing, see uv_loop_set_timing_cb(). The marks are no-ops unless
+ * timing is enabled. uv__timing_mark() charges the time since the previous
+ * mark to `phase`.
+ */
+UV_UNUSED(static void uv__timing_begin(uv_loop_t* loop)) {
+  if (loop->timing_cb == NULL)
+    return;
+  loop->timing_mark = uv__hrtime(UV_CLOCK_PRECISE);
+}
+
+UV_UNUSED(static void uv__timing_mark(uv_loop_t* loop, uv_loop_phase phase)) {
+  uint64_t now;
+
+  if (loop->timing_cb == NULL)
+    return;
+  now = uv__hrtime(UV_CLOCK_PRECISE);
+  loop->timing[phase] += now - loop->timing_mark;
+  loop->timing_mark = now;
+}
+
+/* For the backends: brackets the syscall that blocks for events. */
+UV_UNUSED(static uint64_t uv__timing_wait_start(uv_loop_t* loop)) {
+  if (loop->timing_cb == NULL)
+    return 0;
+  return uv__hrtime(UV_CLOCK_PRECISE);
+}
+
+UV_UNUSED(static void uv__timing_wait_end(uv_loop_t* loop, uint64_t start)) {
+  if (loop->timing_cb == NULL)
+    return;
+  loop->timing[UV_LOOP_PHASE_POLL_WAIT] +=
+      uv__hrtime(UV_CLOCK_PRECISE) - start;
+}
+
 UV_UNUSED(static char* uv__basename_r(const char* path)) {
   char* s;
 
@@ -57,6 +57,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   QUEUE* q;
   uint64_t base;
   uint64_t diff;
+  uint64_t wait_start;
   uv__io_t* w;
   int filter;
   int fflags;
@@ -127,6 +128,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
       spec.tv_nsec = (timeout % 1000) * 1000000;
     }
 
+    wait_start = uv__timing_wait_start(loop);
     nfds = kevent(loop->backend_fd,
                   events,
                   nevents,
@@ -134,6 +136,8 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
                   ARRAY_SIZE(events),
                   timeout == -1 ? NULL : &spec);
 
+    SAVE_ERRNO(uv__timing_wait_end(loop, wait_start));
+
     /* Update loop->time unconditionally. It's tempting to skip the update when
      * timeout == 0 (i.e. non-blocking poll) but there is no guarantee that the
      * operating system didn't reschedule our process while in the syscall.
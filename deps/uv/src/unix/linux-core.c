@@ -143,6 +143,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   uv__io_t* w;
   uint64_t base;
   uint64_t diff;
+  uint64_t wait_start;
   int nevents;
   int count;
   int nfds;
@@ -195,11 +196,14 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   count = 48; /* Benchmarks suggest this gives the best throughput. */
 
   for (;;) {
+    wait_start = uv__timing_wait_start(loop);
     nfds = uv__epoll_wait(loop->backend_fd,
                           events,
                           ARRAY_SIZE(events),
                           timeout);
 
+    SAVE_ERRNO(uv__timing_wait_end(loop, wait_start));
+
     /* Update loop->time unconditionally. It's tempting to skip the update when
      * timeout == 0 (i.e. non-blocking poll) but there is no guarantee that the
      * operating system didn't reschedule our process while in the syscall.
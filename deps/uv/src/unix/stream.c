@@ -502,6 +502,46 @@ void uv__server_io(uv_loop_t* loop, uv__io_t* w, unsigned int events) {
 }
 
 
+int uv_accept_next(uv_stream_t* server) {
+  int err;
+
+  if (server->accepted_fd != -1)
+    return 0;
+
+  if (uv__stream_fd(server) == -1)
+    return -EINVAL;
+
+  if (server->type == UV_TCP && (server->flags & UV_TCP_SINGLE_ACCEPT))
+    return -EAGAIN;  /* Leave the rest to other processes. */
+
+  for (;;) {
+#if defined(UV_HAVE_KQUEUE)
+    if (server->io_watcher.rcount <= 0)
+      return -EAGAIN;
+#endif /* defined(UV_HAVE_KQUEUE) */
+
+    err = uv__accept(uv__stream_fd(server));
+    if (err >= 0)
+      break;
+
+    if (err == -ECONNABORTED)
+      continue;  /* Ignore. Nothing we can do about that. */
+
+    if (err == -EMFILE || err == -ENFILE)
+      err = uv__emfile_trick(server->loop, uv__stream_fd(server));
+
+    if (err == -EWOULDBLOCK)
+      err = -EAGAIN;
+
+    return err;
+  }
+
+  UV_DEC_BACKLOG((&server->io_watcher))
+  server->accepted_fd = err;
+  return 0;
+}
+
+
 #undef UV_DEC_BACKLOG
 
 
@@ -678,19 +718,6 @@ static int uv__handle_fd(uv_handle_t* handle) {
   }
 }
 
-static int uv__getiovmax() {
-#if defined(IOV_MAX)
-  return IOV_MAX;
-#elif defined(_SC_IOV_MAX)
-  static int iovmax = -1;
-  if (iovmax == -1)
-    iovmax = sysconf(_SC_IOV_MAX);
-  return iovmax;
-#else
-  return 1024;
-#endif
-}
-
 static void uv__write(uv_stream_t* stream) {
   struct iovec* iov;
   QUEUE* q;
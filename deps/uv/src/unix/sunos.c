@@ -124,6 +124,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
   uv__io_t* w;
   uint64_t base;
   uint64_t diff;
+  uint64_t wait_start;
   unsigned int nfds;
   unsigned int i;
   int saved_errno;
@@ -163,6 +164,7 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
     /* Work around a kernel bug where nfds is not updated. */
     events[0].portev_source = 0;
 
+    wait_start = uv__timing_wait_start(loop);
     nfds = 1;
     saved_errno = 0;
     if (port_getn(loop->backend_fd,
@@ -179,6 +181,8 @@ void uv__io_poll(uv_loop_t* loop, int timeout) {
         abort();
     }
 
+    SAVE_ERRNO(uv__timing_wait_end(loop, wait_start));
+
     /* Update loop->time unconditionally. It's tempting to skip the update when
      * timeout == 0 (i.e. non-blocking poll) but there is no guarantee that the
      * operating system didn't reschedule our process while in the syscall.
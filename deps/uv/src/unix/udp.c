@@ -28,6 +28,14 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#define UV__UDP_DGRAM_MAXSIZE (64 * 1024)
+
+#if defined(__linux__)
+# define UV__MMSG_MAXWIDTH 20
+static int uv__recvmmsg_avail = 1;
+static int uv__sendmmsg_avail = 1;
+#endif
+
 #if defined(IPV6_JOIN_GROUP) && !defined(IPV6_ADD_MEMBERSHIP)
 # define IPV6_ADD_MEMBERSHIP IPV6_JOIN_GROUP
 #endif
@@ -41,6 +49,10 @@ static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents);
 static void uv__udp_recvmsg(uv_udp_t* handle);
 static void uv__udp_sendmsg(uv_udp_t* handle);
+#if defined(__linux__)
+static void uv__udp_recvmmsg(uv_udp_t* handle);
+static void uv__udp_sendmmsg(uv_udp_t* handle);
+#endif
 static int uv__udp_maybe_deferred_bind(uv_udp_t* handle,
                                        int domain,
                                        unsigned int flags);
@@ -151,6 +163,13 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
   assert(handle->recv_cb != NULL);
   assert(handle->alloc_cb != NULL);
 
+#if defined(__linux__)
+  if ((handle->flags & UV_UDP_PROCESSING_MMSG) && uv__recvmmsg_avail) {
+    uv__udp_recvmmsg(handle);
+    return;
+  }
+#endif
+
   /* Prevent loop starvation when the data comes in as fast as (or faster than)
    * we can read it. XXX Need to rearm fd if we switch to edge-triggered I/O.
    */
@@ -160,7 +179,7 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
   h.msg_name = &peer;
 
   do {
-    handle->alloc_cb((uv_handle_t*) handle, 64 * 1024, &buf);
+    handle->alloc_cb((uv_handle_t*) handle, UV__UDP_DGRAM_MAXSIZE, &buf);
     if (buf.len == 0) {
       handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
       return;
@@ -204,12 +223,175 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 }
 
 
+#if defined(__linux__)
+static void uv__udp_recvmmsg(uv_udp_t* handle) {
+  struct sockaddr_storage peers[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  const struct sockaddr* addr;
+  unsigned int chunks;
+  unsigned int i;
+  size_t chunk_size;
+  uv_buf_t chunk;
+  uv_buf_t buf;
+  int nread;
+  int flags;
+  int count;
+
+  /* Same starvation guard as uv__udp_recvmsg(), counted in datagrams. */
+  count = 32;
+
+  do {
+    handle->alloc_cb((uv_handle_t*) handle,
+                     UV__MMSG_MAXWIDTH * UV__UDP_DGRAM_MAXSIZE,
+                     &buf);
+    if (buf.len == 0) {
+      handle->recv_cb(handle, UV_ENOBUFS, &buf, NULL, 0);
+      return;
+    }
+    assert(buf.base != NULL);
+
+    chunk_size = UV__UDP_DGRAM_MAXSIZE;
+    chunks = buf.len / chunk_size;
+    if (chunks > UV__MMSG_MAXWIDTH)
+      chunks = UV__MMSG_MAXWIDTH;
+    if (chunks == 0) {
+      chunks = 1;
+      chunk_size = buf.len;
+    }
+
+    memset(msgs, 0, chunks * sizeof(msgs[0]));
+    for (i = 0; i < chunks; i++) {
+      iov[i].iov_base = buf.base + i * chunk_size;
+      iov[i].iov_len = chunk_size;
+      msgs[i].msg_hdr.msg_iov = iov + i;
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_name = peers + i;
+      msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+    }
+
+    do {
+      nread = uv__recvmmsg(handle->io_watcher.fd, msgs, chunks, 0, NULL);
+    }
+    while (nread == -1 && errno == EINTR);
+
+    if (nread == -1) {
+      if (errno == ENOSYS) {
+        /* Old kernel. Give the buffer back and use recvmsg() from now on. */
+        uv__recvmmsg_avail = 0;
+        handle->recv_cb(handle, 0, &buf, NULL, 0);
+        if (handle->recv_cb != NULL && handle->io_watcher.fd != -1)
+          uv__udp_recvmsg(handle);
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        handle->recv_cb(handle, 0, &buf, NULL, 0);
+      } else {
+        handle->recv_cb(handle, -errno, &buf, NULL, 0);
+      }
+      return;
+    }
+
+    /* recv_cb callback may decide to pause or close the handle */
+    for (i = 0; i < (unsigned int) nread && handle->recv_cb != NULL; i++) {
+      if (msgs[i].msg_hdr.msg_namelen == 0)
+        addr = NULL;
+      else
+        addr = (const struct sockaddr*) (peers + i);
+
+      flags = UV_UDP_MMSG_CHUNK;
+      if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+        flags |= UV_UDP_PARTIAL;
+
+      chunk = uv_buf_init(iov[i].iov_base, iov[i].iov_len);
+      handle->recv_cb(handle, msgs[i].msg_len, &chunk, addr, flags);
+    }
+
+    /* Hand back the buffer now that all its datagrams have been delivered. */
+    if (handle->recv_cb != NULL)
+      handle->recv_cb(handle, 0, &buf, NULL, 0);
+
+    count -= nread;
+  }
+  /* A short batch means the socket has been drained. */
+  while ((unsigned int) nread == chunks
+      && count > 0
+      && handle->io_watcher.fd != -1
+      && handle->recv_cb != NULL);
+}
+
+
+static void uv__udp_sendmmsg(uv_udp_t* handle) {
+  struct uv__mmsghdr h[UV__MMSG_MAXWIDTH];
+  uv_udp_send_t* req;
+  QUEUE* q;
+  unsigned int pkts;
+  unsigned int i;
+  int npkts;
+  int err;
+
+  while (!QUEUE_EMPTY(&handle->write_queue)) {
+    pkts = 0;
+    for (q = QUEUE_HEAD(&handle->write_queue);
+         pkts < UV__MMSG_MAXWIDTH && q != &handle->write_queue;
+         q = QUEUE_NEXT(q)) {
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      memset(&h[pkts], 0, sizeof(h[pkts]));
+      h[pkts].msg_hdr.msg_name = &req->addr;
+      h[pkts].msg_hdr.msg_namelen = (req->addr.ss_family == AF_INET6 ?
+        sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+      h[pkts].msg_hdr.msg_iov = (struct iovec*) req->bufs;
+      h[pkts].msg_hdr.msg_iovlen = req->nbufs;
+      pkts++;
+    }
+
+    do {
+      npkts = uv__sendmmsg(handle->io_watcher.fd, h, pkts, 0);
+    } while (npkts == -1 && errno == EINTR);
+
+    err = 0;
+    if (npkts == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+
+      if (errno == ENOSYS) {
+        uv__sendmmsg_avail = 0;
+        uv__udp_sendmsg(handle);
+        return;
+      }
+
+      /* sendmmsg() only fails when the first datagram could not be sent. */
+      err = -errno;
+      npkts = 1;
+    }
+
+    /* Like sendmsg(), every datagram is either sent in full or not at all.
+     * Move the ones that went out onto the completed queue.
+     */
+    for (i = 0; i < (unsigned int) npkts; i++) {
+      q = QUEUE_HEAD(&handle->write_queue);
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      req->status = (err != 0 ? err : (ssize_t) h[i].msg_len);
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+    }
+    uv__io_feed(handle->loop, &handle->io_watcher);
+  }
+}
+#endif  /* defined(__linux__) */
+
+
 static void uv__udp_sendmsg(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
   struct msghdr h;
   ssize_t size;
 
+#if defined(__linux__)
+  if ((handle->flags & UV_UDP_PROCESSING_MMSG) && uv__sendmmsg_avail) {
+    uv__udp_sendmmsg(handle);
+    return;
+  }
+#endif
+
   while (!QUEUE_EMPTY(&handle->write_queue)) {
     q = QUEUE_HEAD(&handle->write_queue);
     assert(q != NULL);
@@ -282,7 +464,7 @@ int uv__udp_bind(uv_udp_t* handle,
   fd = -1;
 
   /* Check for bad flags. */
-  if (flags & ~(UV_UDP_IPV6ONLY | UV_UDP_REUSEADDR))
+  if (flags & ~(UV_UDP_IPV6ONLY | UV_UDP_REUSEADDR | UV_UDP_RECVMMSG))
     return -EINVAL;
 
   /* Cannot set IPv6-only mode on non-IPv6 socket. */
@@ -325,6 +507,11 @@ int uv__udp_bind(uv_udp_t* handle,
   if (addr->sa_family == AF_INET6)
     handle->flags |= UV_HANDLE_IPV6;
 
+#if defined(__linux__)
+  if (flags & UV_UDP_RECVMMSG)
+    handle->flags |= UV_UDP_PROCESSING_MMSG;
+#endif
+
   return 0;
 
 out:
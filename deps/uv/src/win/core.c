@@ -371,6 +371,11 @@ int uv_loop_alive(const uv_loop_t* loop) {
 }
 
 
+int uv_loop_set_timing_cb(uv_loop_t* loop, uv_loop_timing_cb cb) {
+  return UV_ENOSYS;
+}
+
+
 int uv_run(uv_loop_t *loop, uv_run_mode mode) {
   DWORD timeout;
   int r;
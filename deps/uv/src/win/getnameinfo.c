@@ -136,6 +136,7 @@ int uv_getnameinfo(uv_loop_t* loop,
 
   uv__work_submit(loop,
                   &req->work_req,
+                  UV_WORK_SLOW_IO,
                   uv__getnameinfo_work,
                   uv__getnameinfo_done);
 
@@ -65,6 +65,14 @@ int uv_accept(uv_stream_t* server, uv_stream_t* client) {
 }
 
 
+int uv_accept_next(uv_stream_t* server) {
+  /* Pending accepts complete through the IOCP one at a time, each with its
+   * own connection callback. There is nothing to pull ahead of time.
+   */
+  return UV_EAGAIN;
+}
+
+
 int uv_read_start(uv_stream_t* handle, uv_alloc_cb alloc_cb,
     uv_read_cb read_cb) {
   int err;
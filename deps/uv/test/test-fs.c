@@ -2071,3 +2071,82 @@ TEST_IMPL(fs_read_file_eof) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+TEST_IMPL(fs_write_alotof_bufs) {
+  const size_t iovcount = 54321;
+  uv_buf_t* iovs;
+  char* buffer;
+  size_t index;
+  size_t total;
+  int r;
+
+  /* Setup. */
+  unlink("test_file");
+
+  loop = uv_default_loop();
+
+  iovs = malloc(sizeof(*iovs) * iovcount);
+  ASSERT(iovs != NULL);
+
+  r = uv_fs_open(loop, &open_req1, "test_file", O_RDWR | O_CREAT,
+      S_IWUSR | S_IRUSR, NULL);
+  ASSERT(r >= 0);
+  ASSERT(open_req1.result >= 0);
+  uv_fs_req_cleanup(&open_req1);
+
+  /* More bufs than IOV_MAX, libuv has to clamp them and writes short. */
+  for (index = 0; index < iovcount; ++index)
+    iovs[index] = uv_buf_init(test_buf, sizeof(test_buf));
+
+  total = 0;
+  index = 0;
+  while (index < iovcount) {
+    r = uv_fs_write(loop, &write_req, open_req1.result,
+                    iovs + index, iovcount - index, -1, NULL);
+    ASSERT(r > 0);
+    ASSERT(r % sizeof(test_buf) == 0);
+    uv_fs_req_cleanup(&write_req);
+    index += r / sizeof(test_buf);
+    total += r;
+  }
+  ASSERT(total == sizeof(test_buf) * iovcount);
+
+  buffer = malloc(sizeof(test_buf) * iovcount);
+  ASSERT(buffer != NULL);
+
+  for (index = 0; index < iovcount; ++index)
+    iovs[index] = uv_buf_init(buffer + index * sizeof(test_buf),
+                              sizeof(test_buf));
+
+  total = 0;
+  index = 0;
+  while (index < iovcount) {
+    r = uv_fs_read(loop, &read_req, open_req1.result,
+                   iovs + index, iovcount - index, total, NULL);
+    ASSERT(r > 0);
+    ASSERT(r % sizeof(test_buf) == 0);
+    uv_fs_req_cleanup(&read_req);
+    index += r / sizeof(test_buf);
+    total += r;
+  }
+  ASSERT(total == sizeof(test_buf) * iovcount);
+
+  for (index = 0; index < iovcount; ++index)
+    ASSERT(memcmp(buffer + index * sizeof(test_buf),
+                  test_buf,
+                  sizeof(test_buf)) == 0);
+
+  r = uv_fs_close(loop, &close_req, open_req1.result, NULL);
+  ASSERT(r == 0);
+  ASSERT(close_req.result == 0);
+  uv_fs_req_cleanup(&close_req);
+
+  /* Cleanup */
+  unlink("test_file");
+  free(buffer);
+  free(iovs);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
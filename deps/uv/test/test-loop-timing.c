@@ -0,0 +1,107 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+static uv_timer_t timer_handle;
+static uv_check_t check_handle;
+static uint64_t totals[UV_LOOP_PHASE_MAX];
+static int timing_cb_called;
+static int check_cb_called;
+
+
+static void timing_cb(uv_loop_t* loop, const uint64_t* timing) {
+  int i;
+
+  ASSERT(loop == uv_default_loop());
+  for (i = 0; i < UV_LOOP_PHASE_MAX; i++)
+    totals[i] += timing[i];
+  timing_cb_called++;
+}
+
+
+static void busy_wait(uint64_t ms) {
+  uint64_t start;
+
+  start = uv_hrtime();
+  while (uv_hrtime() - start < ms * 1000000)
+    ;
+}
+
+
+static void timer_cb(uv_timer_t* handle) {
+  busy_wait(20);
+  uv_close((uv_handle_t*) &check_handle, NULL);
+}
+
+
+static void close_cb(uv_timer_t* handle) {
+  uv_close((uv_handle_t*) handle, NULL);
+}
+
+
+static void check_cb(uv_check_t* handle) {
+  if (check_cb_called++ == 0)
+    busy_wait(30);
+}
+
+
+TEST_IMPL(loop_timing) {
+  uv_loop_t* loop;
+  int r;
+
+  loop = uv_default_loop();
+  r = uv_loop_set_timing_cb(loop, timing_cb);
+#ifdef _WIN32
+  ASSERT(r == UV_ENOSYS);
+  RETURN_SKIP("Loop phase timing is not supported on Windows.");
+#endif
+  ASSERT(r == 0);
+
+  ASSERT(0 == uv_timer_init(loop, &timer_handle));
+  ASSERT(0 == uv_timer_start(&timer_handle, timer_cb, 100, 0));
+  ASSERT(0 == uv_check_init(loop, &check_handle));
+  ASSERT(0 == uv_check_start(&check_handle, check_cb));
+
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(timing_cb_called > 0);
+  ASSERT(check_cb_called > 0);
+
+  /* The check callback spins for 30 ms on the first iteration, the timer
+   * callback for 20 ms and the loop blocks until the timer is due. Allow for
+   * coarse clocks. There are no upper bounds, a loaded machine can take any
+   * amount of time.
+   */
+  ASSERT(totals[UV_LOOP_PHASE_CHECK] >= 25 * 1000000);
+  ASSERT(totals[UV_LOOP_PHASE_TIMERS] >= 15 * 1000000);
+  ASSERT(totals[UV_LOOP_PHASE_POLL_WAIT] >= 40 * 1000000);
+
+  /* No more callbacks once disabled. */
+  timing_cb_called = 0;
+  ASSERT(0 == uv_loop_set_timing_cb(loop, NULL));
+  ASSERT(0 == uv_timer_start(&timer_handle, close_cb, 1, 0));
+  ASSERT(0 == uv_run(loop, UV_RUN_DEFAULT));
+  ASSERT(timing_cb_called == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
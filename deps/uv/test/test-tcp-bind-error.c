@@ -202,6 +202,54 @@ TEST_IMPL(tcp_bind_invalid_flags) {
 }
 
 
+TEST_IMPL(tcp_bind_reuseport) {
+  struct sockaddr_in addr;
+  uv_tcp_t server1, server2, server3;
+  int r;
+
+  ASSERT(0 == uv_ip4_addr("127.0.0.1", TEST_PORT, &addr));
+
+  r = uv_tcp_init(uv_default_loop(), &server1);
+  ASSERT(r == 0);
+  r = uv_tcp_bind(&server1, (const struct sockaddr*) &addr, UV_TCP_REUSEPORT);
+#ifdef _WIN32
+  ASSERT(r == UV_ENOTSUP);
+#else
+  if (r == UV_ENOTSUP) {
+    uv_close((uv_handle_t*) &server1, NULL);
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+    RETURN_SKIP("SO_REUSEPORT is not supported");
+  }
+  ASSERT(r == 0);
+  r = uv_listen((uv_stream_t*) &server1, 128, NULL);
+  ASSERT(r == 0);
+
+  /* Both sockets must opt in. */
+  r = uv_tcp_init(uv_default_loop(), &server2);
+  ASSERT(r == 0);
+  r = uv_tcp_bind(&server2, (const struct sockaddr*) &addr, 0);
+  if (r == 0)
+    r = uv_listen((uv_stream_t*) &server2, 128, NULL);
+  ASSERT(r == UV_EADDRINUSE);
+  uv_close((uv_handle_t*) &server2, NULL);
+
+  r = uv_tcp_init(uv_default_loop(), &server3);
+  ASSERT(r == 0);
+  r = uv_tcp_bind(&server3, (const struct sockaddr*) &addr, UV_TCP_REUSEPORT);
+  ASSERT(r == 0);
+  r = uv_listen((uv_stream_t*) &server3, 128, NULL);
+  ASSERT(r == 0);
+  uv_close((uv_handle_t*) &server3, NULL);
+#endif
+
+  uv_close((uv_handle_t*) &server1, NULL);
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
 TEST_IMPL(tcp_listen_without_bind) {
   int r;
   uv_tcp_t server;
@@ -74,3 +74,79 @@ TEST_IMPL(threadpool_queue_work_einval) {
   MAKE_VALGRIND_HAPPY();
   return 0;
 }
+
+
+static void stats_work_cb(uv_work_t* req) {
+  work_cb_count++;
+}
+
+
+static void stats_fs_cb(uv_fs_t* req) {
+  ASSERT(req->result == 0);
+  uv_fs_req_cleanup(req);
+}
+
+
+TEST_IMPL(threadpool_stats) {
+  uv_threadpool_stats_t stats;
+  uv_work_t reqs[16];
+  uv_fs_t fs_req;
+  unsigned int i;
+  int r;
+
+  for (i = 0; i < ARRAY_SIZE(reqs); i++) {
+    r = uv_queue_work(uv_default_loop(), reqs + i, stats_work_cb, NULL);
+    ASSERT(r == 0);
+  }
+
+  r = uv_fs_stat(uv_default_loop(), &fs_req, ".", stats_fs_cb);
+  ASSERT(r == 0);
+
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+  ASSERT(work_cb_count == ARRAY_SIZE(reqs));
+
+  uv_threadpool_stats(&stats);
+  ASSERT(stats.threads > 0);
+  ASSERT(stats.classes[UV_WORK_CPU].queued == 0);
+  ASSERT(stats.classes[UV_WORK_CPU].dispatched == ARRAY_SIZE(reqs));
+  ASSERT(stats.classes[UV_WORK_CPU].max_wait_time <=
+         stats.classes[UV_WORK_CPU].wait_time);
+  ASSERT(stats.classes[UV_WORK_FAST_IO].queued == 0);
+  ASSERT(stats.classes[UV_WORK_FAST_IO].dispatched == 1);
+  ASSERT(stats.classes[UV_WORK_SLOW_IO].dispatched == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
+
+
+TEST_IMPL(threadpool_queue_work_class) {
+  uv_threadpool_stats_t stats;
+  int r;
+
+  work_req.data = &data;
+  r = uv_queue_work_class(uv_default_loop(),
+                          &work_req,
+                          UV_WORK_CLASS_MAX,
+                          work_cb,
+                          after_work_cb);
+  ASSERT(r == UV_EINVAL);
+
+  r = uv_queue_work_class(uv_default_loop(),
+                          &work_req,
+                          UV_WORK_FAST_IO,
+                          work_cb,
+                          after_work_cb);
+  ASSERT(r == 0);
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(work_cb_count == 1);
+  ASSERT(after_work_cb_count == 1);
+
+  uv_threadpool_stats(&stats);
+  ASSERT(stats.classes[UV_WORK_FAST_IO].dispatched == 1);
+  ASSERT(stats.classes[UV_WORK_CPU].dispatched == 0);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+}
@@ -26,6 +26,11 @@ var EventEmitter = require('events').EventEmitter;
 var HTTPParser = process.binding('http_parser').HTTPParser;
 var assert = require('assert').ok;
 
+var ioCountersBinding = process.binding('io_counters');
+var ioCounters = ioCountersBinding.counters;
+var kHttpClientRequests = ioCountersBinding.kHttpClientRequests;
+var kHttpClientResponses = ioCountersBinding.kHttpClientResponses;
+
 var common = require('_http_common');
 
 var httpSocketSetup = common.httpSocketSetup;
@@ -179,6 +184,7 @@ ClientRequest.prototype.aborted = undefined;
 ClientRequest.prototype._finish = function() {
   DTRACE_HTTP_CLIENT_REQUEST(this, this.connection);
   COUNTER_HTTP_CLIENT_REQUEST();
+  ioCounters[kHttpClientRequests]++;
   OutgoingMessage.prototype._finish.call(this);
 };
 
@@ -410,6 +416,7 @@ function parserOnIncomingClient(res, shouldKeepAlive) {
 
   DTRACE_HTTP_CLIENT_RESPONSE(socket, req);
   COUNTER_HTTP_CLIENT_RESPONSE();
+  ioCounters[kHttpClientResponses]++;
   req.res = res;
   res.req = req;
 
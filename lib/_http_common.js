@@ -26,6 +26,7 @@ var incoming = require('_http_incoming');
 var IncomingMessage = incoming.IncomingMessage;
 var readStart = incoming.readStart;
 var readStop = incoming.readStop;
+var headerBlockToArray = incoming.headerBlockToArray;
 
 var isNumber = require('util').isNumber;
 var debug = require('util').debuglog('http');
@@ -41,22 +42,19 @@ var kOnHeadersComplete = HTTPParser.kOnHeadersComplete | 0;
 var kOnBody = HTTPParser.kOnBody | 0;
 var kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
 
-// Only called in the slow case where slow means
-// that the request headers were either fragmented
-// across multiple TCP packets or too large to be
-// processed in a single run. This method is also
-// called to process trailing HTTP headers.
+// Called to process trailing HTTP headers, `headers` is a header block like
+// the one passed to parserOnHeadersComplete().
 function parserOnHeaders(headers, url) {
   // Once we exceeded headers limit - stop collecting them
   if (this.maxHeaderPairs <= 0 ||
       this._headers.length < this.maxHeaderPairs) {
-    this._headers = this._headers.concat(headers);
+    this._headers = this._headers.concat(headerBlockToArray(headers));
   }
   this._url += url;
 }
 
-// info.headers and info.url are set only if .onHeaders()
-// has not been called for this request.
+// info.headers is a Buffer with the raw header lines, IncomingMessage only
+// turns them into strings when they are looked at.
 //
 // info.url is not set for response parsers but that's not
 // applicable here since all our parsers are request parsers.
@@ -64,17 +62,7 @@ function parserOnHeadersComplete(info) {
   debug('parserOnHeadersComplete', info);
   var parser = this;
   var headers = info.headers;
-  var url = info.url;
-
-  if (!headers) {
-    headers = parser._headers;
-    parser._headers = [];
-  }
-
-  if (!url) {
-    url = parser._url;
-    parser._url = '';
-  }
+  var url = info.url || '';
 
   parser.incoming = new IncomingMessage(parser.socket);
   parser.incoming.httpVersionMajor = info.versionMajor;
@@ -82,14 +70,9 @@ function parserOnHeadersComplete(info) {
   parser.incoming.httpVersion = info.versionMajor + '.' + info.versionMinor;
   parser.incoming.url = url;
 
-  var n = headers.length;
-
   // If parser.maxHeaderPairs <= 0 - assume that there're no limit
-  if (parser.maxHeaderPairs > 0) {
-    n = Math.min(n, parser.maxHeaderPairs);
-  }
-
-  parser.incoming._addHeaderLines(headers, n);
+  var n = parser.maxHeaderPairs > 0 ? parser.maxHeaderPairs : 0;
+  parser.incoming._addHeaderBlock(headers, n);
 
   if (isNumber(info.method)) {
     // server only
@@ -170,11 +153,7 @@ var parsers = new FreeList('parsers', 1000, function() {
   parser._headers = [];
   parser._url = '';
 
-  // Only called in the slow case where slow means
-  // that the request headers were either fragmented
-  // across multiple TCP packets or too large to be
-  // processed in a single run. This method is also
-  // called to process trailing HTTP headers.
+  // Only called to process trailing HTTP headers.
   parser[kOnHeaders] = parserOnHeaders;
   parser[kOnHeadersComplete] = parserOnHeadersComplete;
   parser[kOnBody] = parserOnBody;
@@ -21,6 +21,7 @@
 
 var util = require('util');
 var Stream = require('stream');
+var HTTPParser = process.binding('http_parser').HTTPParser;
 
 function readStart(socket) {
   if (socket && !socket._paused && socket.readable)
@@ -35,6 +36,55 @@ function readStop(socket) {
 exports.readStop = readStop;
 
 
+// Header blocks come from the http_parser binding: a uint32 count, the end
+// offsets of `count` strings and then the strings themselves, alternating
+// between fields and values. All integers are little endian. The top byte
+// of a field's end offset holds the id of the header if the parser knows it,
+// see headerNames below.
+function headerBlockStrings(block) {
+  return block.toString('binary', 4 + 4 * block.readUInt32LE(0, true));
+}
+
+
+function headerEnd(block, i) {
+  return block.readUInt32LE(4 + 4 * i, true) & 0xffffff;
+}
+
+
+function headerBlockToArray(block) {
+  var count = block.readUInt32LE(0, true);
+  var data = headerBlockStrings(block);
+  var lines = new Array(count);
+  var start = 0;
+  for (var i = 0; i < count; i++) {
+    var end = headerEnd(block, i);
+    lines[i] = data.slice(start, end);
+    start = end;
+  }
+  return lines;
+}
+exports.headerBlockToArray = headerBlockToArray;
+
+
+// Known headers, indexed by id. The names are interned by the binding so
+// known headers don't cost a string slice or a toLowerCase() call. Bit 7 of
+// the id says the raw name was spelled exactly like rawHeaderNames[id].
+var headerNames = HTTPParser.headerNames;
+var rawHeaderNames = HTTPParser.rawHeaderNames;
+var headerIds = Object.create(null);
+var headerKinds = [];
+var kCanonicalHeader = 0x80;
+
+var kListHeader = 0;
+var kArrayHeader = 1;
+var kUniqueHeader = 2;
+
+for (var id = 1; id < headerNames.length; id++) {
+  headerIds[headerNames[id]] = id;
+  headerKinds[id] = headerKind(headerNames[id]);
+}
+
+
 /* Abstract base class for ServerRequest and ClientResponse. */
 function IncomingMessage(socket) {
   Stream.Readable.call(this);
@@ -52,6 +102,9 @@ function IncomingMessage(socket) {
   this.complete = false;
   this.headers = {};
   this.rawHeaders = [];
+  // Raw header lines, see _addHeaderBlock()
+  this._headerBlock = null;
+  this._headerLimit = 0;
   this.trailers = {};
   this.rawTrailers = [];
 
@@ -136,6 +189,134 @@ IncomingMessage.prototype._addHeaderLines = function(headers, n) {
 };
 
 
+// .headers and .rawHeaders are parsed from the block on first access. Until
+// then they are accessors on the message itself, so that they stay own
+// properties for Object.keys(), util._extend() and friends. Parsing turns
+// them back into plain data properties.
+var lazyHeaders = {
+  configurable: true,
+  enumerable: true,
+  get: function() {
+    this._parseHeaderBlock();
+    return this.headers;
+  },
+  set: function(val) {
+    this._parseHeaderBlock();
+    this.headers = val;
+  }
+};
+
+var lazyRawHeaders = {
+  configurable: true,
+  enumerable: true,
+  get: function() {
+    this._parseHeaderBlock();
+    return this.rawHeaders;
+  },
+  set: function(val) {
+    this._parseHeaderBlock();
+    this.rawHeaders = val;
+  }
+};
+
+
+// Only the first `n` header lines make it into .headers, 0 means all of them
+IncomingMessage.prototype._addHeaderBlock = function(block, n) {
+  this._headerBlock = block;
+  this._headerLimit = n;
+  Object.defineProperty(this, 'headers', lazyHeaders);
+  Object.defineProperty(this, 'rawHeaders', lazyRawHeaders);
+};
+
+
+IncomingMessage.prototype._parseHeaderBlock = function() {
+  var block = this._headerBlock;
+  var count = block.readUInt32LE(0, true);
+  var n = count;
+  if (this._headerLimit > 0)
+    n = Math.min(n, this._headerLimit);
+  this._headerBlock = null;
+
+  var data = headerBlockStrings(block);
+  var raw = [];
+  var dest = {};
+  Object.defineProperty(this, 'headers', {
+    configurable: true,
+    enumerable: true,
+    writable: true,
+    value: dest
+  });
+  Object.defineProperty(this, 'rawHeaders', {
+    configurable: true,
+    enumerable: true,
+    writable: true,
+    value: raw
+  });
+  var start = 0;
+  for (var i = 0; i < count; i += 2) {
+    var id = block[7 + 4 * i];
+    var end = headerEnd(block, i);
+    var valueEnd = headerEnd(block, i + 1);
+    var field;
+    if (id & kCanonicalHeader)
+      field = rawHeaderNames[id & ~kCanonicalHeader];
+    else
+      field = data.slice(start, end);
+    var value = data.slice(end, valueEnd);
+    raw.push(field, value);
+
+    if (i < n) {
+      id &= ~kCanonicalHeader;
+      if (id !== 0)
+        addHeaderLine(headerKinds[id], headerNames[id], value, dest);
+      else
+        this._addHeaderLine(field, value, dest);
+    }
+    start = valueEnd;
+  }
+};
+
+
+// Returns the value of header `field` (lower case) the way .headers would,
+// but without parsing all headers. Meant for the few headers node itself
+// looks at on every message.
+IncomingMessage.prototype._getHeader = function(field) {
+  var block = this._headerBlock;
+  if (block === null)
+    return this.headers[field];
+
+  var count = block.readUInt32LE(0, true);
+  if (this._headerLimit > 0)
+    count = Math.min(count, this._headerLimit);
+
+  // A known header only ever matches fields that carry its id
+  var id = headerIds[field] || 0;
+  var data = null;
+  var dest = {};
+  var start = 0;
+  for (var i = 0; i < count; i += 2) {
+    var fieldId = block[7 + 4 * i] & ~kCanonicalHeader;
+    var end = headerEnd(block, i);
+    var valueEnd = headerEnd(block, i + 1);
+    if (id !== 0) {
+      if (fieldId === id) {
+        if (data === null)
+          data = headerBlockStrings(block);
+        addHeaderLine(headerKinds[id], field, data.slice(end, valueEnd), dest);
+      }
+    } else if (fieldId === 0 && end - start === field.length) {
+      if (data === null)
+        data = headerBlockStrings(block);
+      if (data.slice(start, end).toLowerCase() === field)
+        this._addHeaderLine(field, data.slice(end, valueEnd), dest);
+    }
+    start = valueEnd;
+  }
+
+  return dest[field];
+};
+
+
 // Add the given (field, value) pair to the message
 //
 // Per RFC2616, section 4.2 it is acceptable to join multiple instances of the
@@ -145,15 +326,15 @@ IncomingMessage.prototype._addHeaderLines = function(headers, n) {
 // always joined.
 IncomingMessage.prototype._addHeaderLine = function(field, value, dest) {
   field = field.toLowerCase();
+  addHeaderLine(headerKind(field), field, value, dest);
+};
+
+
+function headerKind(field) {
   switch (field) {
     // Array headers:
     case 'set-cookie':
-      if (!util.isUndefined(dest[field])) {
-        dest[field].push(value);
-      } else {
-        dest[field] = [value];
-      }
-      break;
+      return kArrayHeader;
 
     // list is taken from:
     // https://mxr.mozilla.org/mozilla/source/netwerk/protocol/http/src/nsHttpHeaderArray.cpp
@@ -170,19 +351,38 @@ IncomingMessage.prototype._addHeaderLine = function(field, value, dest) {
     case 'location':
     case 'max-forwards':
       // drop duplicates
+      return kUniqueHeader;
+
+    default:
+      // make comma-separated list
+      return kListHeader;
+  }
+}
+
+
+function addHeaderLine(kind, field, value, dest) {
+  switch (kind) {
+    case kArrayHeader:
+      if (!util.isUndefined(dest[field])) {
+        dest[field].push(value);
+      } else {
+        dest[field] = [value];
+      }
+      break;
+
+    case kUniqueHeader:
       if (util.isUndefined(dest[field]))
         dest[field] = value;
       break;
 
     default:
-      // make comma-separated list
       if (!util.isUndefined(dest[field]))
         dest[field] += ', ' + value;
       else {
         dest[field] = value;
       }
   }
-};
+}
 
 
 // Call this instead of resume() if we want to just
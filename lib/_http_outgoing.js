@@ -25,6 +25,7 @@ var timers = require('timers');
 var util = require('util');
 
 var common = require('_http_common');
+var net = require('net');
 
 var CRLF = common.CRLF;
 var chunkExpression = common.chunkExpression;
@@ -144,7 +145,8 @@ OutgoingMessage.prototype._writeRaw = function(data, encoding, callback) {
     encoding = null;
   }
 
-  if (data.length === 0) {
+  // Files from sendFile() are empty buffers with the file range attached
+  if (data.length === 0 && !data._sendFile) {
     if (util.isFunction(callback))
       process.nextTick(callback);
     return true;
@@ -460,6 +462,36 @@ OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
 };
 
 
+// Like write() with the `length` bytes of file `fd` starting at `offset`,
+// which plain TCP sockets send with sendfile(2).
+OutgoingMessage.prototype.sendFile = function(fd, offset, length, callback) {
+  var chunk = net._createSendFileChunk(fd, offset, length);
+
+  if (!this._header) {
+    this._implicitHeader();
+  }
+
+  if (!this._hasBody) {
+    debug('This type of response MUST NOT have a body. ' +
+          'Ignoring sendFile() calls.');
+    length = 0;
+  }
+
+  if (length === 0) {
+    if (util.isFunction(callback))
+      process.nextTick(callback);
+    return true;
+  }
+
+  if (this.chunkedEncoding) {
+    this._send(length.toString(16) + CRLF, 'binary', null);
+    this._send(chunk, null, null);
+    return this._send(crlf_buf, null, callback);
+  }
+  return this._send(chunk, null, callback);
+};
+
+
 OutgoingMessage.prototype.addTrailers = function(headers) {
   this._trailer = '';
   var keys = Object.keys(headers);
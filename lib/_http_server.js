@@ -25,6 +25,11 @@ var EventEmitter = require('events').EventEmitter;
 var HTTPParser = process.binding('http_parser').HTTPParser;
 var assert = require('assert').ok;
 
+var ioCountersBinding = process.binding('io_counters');
+var ioCounters = ioCountersBinding.counters;
+var kHttpServerRequests = ioCountersBinding.kHttpServerRequests;
+var kHttpServerResponses = ioCountersBinding.kHttpServerResponses;
+
 var common = require('_http_common');
 var parsers = common.parsers;
 var freeParser = common.freeParser;
@@ -106,7 +111,8 @@ function ServerResponse(req) {
   this.sendDate = true;
 
   if (req.httpVersionMajor < 1 || req.httpVersionMinor < 1) {
-    this.useChunkedEncodingByDefault = chunkExpression.test(req.headers.te);
+    var te = req._getHeader('te');
+    this.useChunkedEncodingByDefault = chunkExpression.test(te);
     this.shouldKeepAlive = false;
   }
 }
@@ -115,6 +121,7 @@ util.inherits(ServerResponse, OutgoingMessage);
 ServerResponse.prototype._finish = function() {
   DTRACE_HTTP_SERVER_RESPONSE(this.connection);
   COUNTER_HTTP_SERVER_RESPONSE();
+  ioCounters[kHttpServerResponses]++;
   OutgoingMessage.prototype._finish.call(this);
 };
 
@@ -439,6 +446,7 @@ function connectionListener(socket) {
     res.shouldKeepAlive = shouldKeepAlive;
     DTRACE_HTTP_SERVER_REQUEST(req, socket);
     COUNTER_HTTP_SERVER_REQUEST();
+    ioCounters[kHttpServerRequests]++;
 
     if (socket._httpMessage) {
       // There are already pending outgoing res, append.
@@ -477,9 +485,10 @@ function connectionListener(socket) {
       }
     }
 
-    if (!util.isUndefined(req.headers.expect) &&
+    var expect = req._getHeader('expect');
+    if (!util.isUndefined(expect) &&
         (req.httpVersionMajor == 1 && req.httpVersionMinor == 1) &&
-        continueExpression.test(req.headers['expect'])) {
+        continueExpression.test(expect)) {
       res._expect_continue = true;
       if (EventEmitter.listenerCount(self, 'checkContinue') > 0) {
         self.emit('checkContinue', req, res);
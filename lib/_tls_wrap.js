@@ -24,7 +24,10 @@
 
 var assert = require('assert');
 var crypto = require('crypto');
+var fs = require('fs');
 var net = require('net');
+var os = require('os');
+var path = require('path');
 var tls = require('tls');
 var util = require('util');
 var listenerCount = require('events').listenerCount;
@@ -317,6 +320,9 @@ TLSSocket.prototype._init = function(socket) {
          listenerCount(this.server, 'OCSPRequest') > 0)) {
       this.ssl.enableSessionCallbacks();
     }
+
+    if (options.asyncHandshake)
+      this.ssl.enableAsyncHandshake();
   } else {
     this.ssl.onhandshakestart = function() {};
     this.ssl.onhandshakedone = this._finishInit.bind(this);
@@ -623,6 +629,18 @@ function Server(/* [options], listener */) {
     sharedCreds.context.setTicketKeys(self.ticketKeys);
   }
 
+  if (util.isString(self.sharedSessionCache)) {
+    this._setSessionCache(self.sharedSessionCache);
+  } else if (self.sharedSessionCache && !require('cluster').isWorker) {
+    // Not a cluster worker, keep the cache to ourselves. Workers agree on a
+    // file through the master, see _setServerData().
+    var file = sessionCacheFile();
+    this._setSessionCache(file);
+    // Windows keeps the cache in shared memory, there is no file to remove
+    if (process.platform !== 'win32')
+      fs.unlinkSync(file);
+  }
+
   // constructor call
   net.Server.call(this, function(raw_socket) {
     var socket = new TLSSocket(raw_socket, {
@@ -633,7 +651,8 @@ function Server(/* [options], listener */) {
       rejectUnauthorized: self.rejectUnauthorized,
       handshakeTimeout: timeout,
       NPNProtocols: self.NPNProtocols,
-      SNICallback: options.SNICallback || SNICallback
+      SNICallback: options.SNICallback || SNICallback,
+      asyncHandshake: options.asyncHandshake
     });
 
     socket.on('secure', function() {
@@ -685,17 +704,40 @@ exports.createServer = function(options, listener) {
 
 
 Server.prototype._getServerData = function() {
-  return {
+  var data = {
     ticketKeys: this._sharedCreds.context.getTicketKeys().toString('hex')
   };
+  if (this.sharedSessionCache && !this._sessionCache) {
+    data.sessionCache = sessionCacheFile();
+    // Workers come and go, the cluster master removes the file once the
+    // last one stops listening
+    data.tempFiles = [data.sessionCache];
+  }
+  return data;
 };
 
 
 Server.prototype._setServerData = function(data) {
   this._sharedCreds.context.setTicketKeys(new Buffer(data.ticketKeys, 'hex'));
+
+  if (data.sessionCache && !this._sessionCache)
+    this._setSessionCache(data.sessionCache);
 };
 
 
+Server.prototype._setSessionCache = function(file) {
+  this._sharedCreds.context.setSessionCache(file,
+                                            this.sharedSessionCacheSize);
+  this._sessionCache = file;
+};
+
+
+function sessionCacheFile() {
+  var name = 'node-tls-sessions-' + crypto.randomBytes(8).toString('hex');
+  return path.join(os.tmpdir(), name);
+}
+
+
 Server.prototype.setOptions = function(options) {
   if (util.isBoolean(options.requestCert)) {
     this.requestCert = options.requestCert;
@@ -722,6 +764,9 @@ Server.prototype.setOptions = function(options) {
   if (options.dhparam) this.dhparam = options.dhparam;
   if (options.sessionTimeout) this.sessionTimeout = options.sessionTimeout;
   if (options.ticketKeys) this.ticketKeys = options.ticketKeys;
+  if (options.sharedSessionCache)
+    this.sharedSessionCache = options.sharedSessionCache;
+  this.sharedSessionCacheSize = options.sharedSessionCacheSize || 4096;
   var secureOptions = options.secureOptions || 0;
   if (options.honorCipherOrder)
     this.honorCipherOrder = true;
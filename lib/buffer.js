@@ -297,6 +297,59 @@ Buffer.prototype.compare = function compare(b) {
 };
 
 
+function indexOf(buffer, val, byteOffset, encoding, forward) {
+  if (util.isString(byteOffset)) {
+    encoding = byteOffset;
+    byteOffset = undefined;
+  }
+
+  if (util.isString(val)) {
+    if (!util.isUndefined(encoding) && !Buffer.isEncoding(encoding))
+      throw new TypeError('Unknown encoding: ' + encoding);
+  } else if (!util.isNumber(val) && !(val instanceof Buffer)) {
+    throw new TypeError('Argument must be a string, number or Buffer');
+  }
+
+  var length = buffer.length;
+  byteOffset = +byteOffset;
+  if (isNaN(byteOffset))
+    byteOffset = forward ? 0 : length;
+  else if (byteOffset < 0)
+    byteOffset += length;
+
+  if (byteOffset < 0) {
+    if (!forward)
+      return -1;
+    byteOffset = 0;
+  } else if (byteOffset > length) {
+    byteOffset = length;
+  }
+
+  return internal.indexOf(buffer,
+                          val,
+                          Math.floor(byteOffset),
+                          encoding,
+                          forward);
+}
+
+
+// indexOf(value, byteOffset = 0, encoding = 'utf8')
+Buffer.prototype.indexOf = function(val, byteOffset, encoding) {
+  return indexOf(this, val, byteOffset, encoding, true);
+};
+
+
+// lastIndexOf(value, byteOffset = buffer.length, encoding = 'utf8')
+Buffer.prototype.lastIndexOf = function(val, byteOffset, encoding) {
+  return indexOf(this, val, byteOffset, encoding, false);
+};
+
+
+Buffer.prototype.includes = function(val, byteOffset, encoding) {
+  return indexOf(this, val, byteOffset, encoding, true) !== -1;
+};
+
+
 // XXX remove in v0.13
 Buffer.prototype.get = util.deprecate(function get(offset) {
   offset = ~~offset;
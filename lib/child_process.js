@@ -323,10 +323,13 @@ function handleMessage(target, message, handle) {
   target.emit(eventName, message, handle);
 }
 
-function setupChannel(target, channel) {
+function setupChannel(target, channel, serialization) {
   target._channel = channel;
   target._handleQueue = null;
 
+  var binary = serialization === 'binary';
+  var ipc = binary ? process.binding('ipc') : null;
+
   var decoder = new StringDecoder('utf8');
   var jsonBuffer = '';
   channel.buffering = false;
@@ -345,10 +348,7 @@ function setupChannel(target, channel) {
         // There will be at most one NODE_HANDLE message in every chunk we
         // read because SCM_RIGHTS messages don't get coalesced. Make sure
         // that we deliver the handle with the right message however.
-        if (message && message.cmd === 'NODE_HANDLE')
-          handleMessage(target, message, recvHandle);
-        else
-          handleMessage(target, message, undefined);
+        deliverMessage(message, recvHandle);
 
         start = i + 1;
       }
@@ -356,14 +356,64 @@ function setupChannel(target, channel) {
       this.buffering = jsonBuffer.length !== 0;
 
     } else {
-      this.buffering = false;
-      target.disconnect();
-      channel.onread = nop;
-      channel.close();
-      maybeClose(target);
+      channelEnded();
     }
   };
 
+  // Binary channels carry frames of a uint32 length followed by a message
+  // serialized by process.binding('ipc'). A partial frame is kept as a list
+  // of chunks until the rest of it has arrived.
+  var pending = null;
+  var pendingLength = 0;
+  var pendingNeeded = 0;
+  if (binary) channel.onread = function(nread, pool, recvHandle) {
+    if (!pool) return channelEnded();
+
+    if (pending !== null) {
+      pending.push(pool);
+      pendingLength += pool.length;
+      if (pendingLength < pendingNeeded)
+        return;
+      pool = Buffer.concat(pending, pendingLength);
+      pending = null;
+    }
+
+    var headerSize = ipc.kHeaderSize;
+    var offset = 0;
+    var needed = headerSize;
+    while (pool.length - offset >= headerSize) {
+      needed = headerSize + pool.readUInt32LE(offset, true);
+      if (pool.length - offset < needed)
+        break;
+      var message = ipc.parse(pool, offset + headerSize, offset + needed);
+      offset += needed;
+      needed = headerSize;
+      deliverMessage(message, recvHandle);
+    }
+
+    if (offset < pool.length) {
+      pending = [pool.slice(offset)];
+      pendingLength = pool.length - offset;
+      pendingNeeded = needed;
+    }
+    this.buffering = pending !== null;
+  };
+
+  function deliverMessage(message, recvHandle) {
+    if (message && message.cmd === 'NODE_HANDLE')
+      handleMessage(target, message, recvHandle);
+    else
+      handleMessage(target, message, undefined);
+  }
+
+  function channelEnded() {
+    channel.buffering = false;
+    target.disconnect();
+    channel.onread = nop;
+    channel.close();
+    maybeClose(target);
+  }
+
   // object where socket lists will live
   channel.sockets = { got: {}, send: {} };
 
@@ -474,8 +524,14 @@ function setupChannel(target, channel) {
     }
 
     var req = { oncomplete: nop };
-    var string = JSON.stringify(message) + '\n';
-    var err = channel.writeUtf8String(req, string, handle);
+    var err;
+    if (binary) {
+      req.buffer = ipc.serialize(message);
+      err = channel.writeBuffer(req, req.buffer, handle);
+    } else {
+      var string = JSON.stringify(message) + '\n';
+      err = channel.writeUtf8String(req, string, handle);
+    }
 
     if (err) {
       if (!swallowErrors)
@@ -578,12 +634,12 @@ exports.fork = function(modulePath /*, args, options*/) {
 };
 
 
-exports._forkChild = function(fd) {
+exports._forkChild = function(fd, serialization) {
   // set process.send()
   var p = createPipe(true);
   p.open(fd);
   p.unref();
-  setupChannel(process, p);
+  setupChannel(process, p, serialization);
 
   var refs = 0;
   process.on('newListener', function(name) {
@@ -985,6 +1041,7 @@ var spawn = exports.spawn = function(/*file, args, options*/) {
     detached: !!(options && options.detached),
     envPairs: envPairs,
     stdio: options ? options.stdio : null,
+    serialization: options ? options.serialization : null,
     uid: options ? options.uid : null,
     gid: options ? options.gid : null
   });
@@ -1104,6 +1161,10 @@ ChildProcess.prototype.spawn = function(options) {
       // If no `stdio` option was given - use default
       stdio = options.stdio || 'pipe';
 
+  var serialization = options.serialization || 'json';
+  if (serialization !== 'json' && serialization !== 'binary')
+    throw new TypeError('serialization must be "json" or "binary"');
+
   stdio = _validateStdio(stdio, false);
 
   ipc = stdio.ipc;
@@ -1114,6 +1175,8 @@ ChildProcess.prototype.spawn = function(options) {
     // Let child process know about opened IPC channel
     options.envPairs = options.envPairs || [];
     options.envPairs.push('NODE_CHANNEL_FD=' + ipcFd);
+    if (serialization !== 'json')
+      options.envPairs.push('NODE_CHANNEL_SERIALIZATION=' + serialization);
   }
 
   this.spawnfile = options.file;
@@ -1183,7 +1246,7 @@ ChildProcess.prototype.spawn = function(options) {
   });
 
   // Add .send() method and start listening for IPC data
-  if (!util.isUndefined(ipc)) setupChannel(this, ipc);
+  if (!util.isUndefined(ipc)) setupChannel(this, ipc, serialization);
 
   return err;
 };
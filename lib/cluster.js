@@ -23,10 +23,17 @@ var EventEmitter = require('events').EventEmitter;
 var assert = require('assert');
 var dgram = require('dgram');
 var fork = require('child_process').fork;
+var fs = require('fs');
 var net = require('net');
 var util = require('util');
 var SCHED_NONE = 1;
 var SCHED_RR = 2;
+var SCHED_REUSEPORT = 3;
+var BALANCE_RR = 'round-robin';
+var BALANCE_CONNECTIONS = 'least-connections';
+var BALANCE_LAG = 'least-lag';
+var LOAD_REPORT_INTERVAL = 200;  // Milliseconds.
+var UV_TCP_REUSEPORT = process.binding('tcp_wrap').UV_TCP_REUSEPORT;
 
 var cluster = new EventEmitter;
 module.exports = cluster;
@@ -110,6 +117,49 @@ SharedHandle.prototype.remove = function(worker) {
 };
 
 
+// Every worker binds and listens on a socket of its own with SO_REUSEPORT
+// set, the kernel distributes the connections. The master binds a socket
+// too but never listens on it. It reserves the address while workers come
+// and go, and it resolves port 0 to the port that all workers should use.
+function ReusePortHandle(key, address, port, addressType, backlog, fd) {
+  this.key = key;
+  this.workers = [];
+  this.handle = null;
+  this.errno = 0;
+  this.sockname = null;
+
+  var rval = net._createServerHandle(address,
+                                     port,
+                                     addressType,
+                                     fd,
+                                     UV_TCP_REUSEPORT);
+  if (util.isNumber(rval)) {
+    this.errno = rval;
+    return;
+  }
+
+  this.handle = rval;
+  this.sockname = {};
+  var err = this.handle.getsockname(this.sockname);
+  // bind() defers EADDRINUSE to listen(), which the master never calls.
+  if (err === 0 && port > 0 && this.sockname.port !== port)
+    err = process.binding('uv').UV_EADDRINUSE;
+  if (err) {
+    this.errno = err;
+    this.handle.close();
+    this.handle = null;
+  }
+}
+
+ReusePortHandle.prototype.add = function(worker, send) {
+  assert(this.workers.indexOf(worker) === -1);
+  this.workers.push(worker);
+  send(this.errno, { reuseport: true, sockname: this.sockname }, null);
+};
+
+ReusePortHandle.prototype.remove = SharedHandle.prototype.remove;
+
+
 // Start a round-robin server. Master accepts connections and distributes
 // them over the workers.
 function RoundRobinHandle(key, address, port, addressType, backlog, fd) {
@@ -118,6 +168,7 @@ function RoundRobinHandle(key, address, port, addressType, backlog, fd) {
   this.free = [];
   this.handles = [];
   this.handle = null;
+  this.balance = cluster.settings.balance || BALANCE_RR;
   this.server = net.createServer(assert.fail);
 
   if (fd >= 0)
@@ -139,18 +190,20 @@ function RoundRobinHandle(key, address, port, addressType, backlog, fd) {
 RoundRobinHandle.prototype.add = function(worker, send) {
   assert(worker.id in this.all === false);
   this.all[worker.id] = worker;
+  worker.load.reported = Date.now();  // Reports start now.
 
   var self = this;
   function done() {
+    var reply = {};
+    if (self.balance !== BALANCE_RR)
+      reply.loadReport = LOAD_REPORT_INTERVAL;  // Worker must report load.
     if (self.handle.getsockname) {
       var out = {};
       var err = self.handle.getsockname(out);
       // TODO(bnoordhuis) Check err.
-      send(null, { sockname: out }, null);
-    }
-    else {
-      send(null, null, null);  // UNIX socket.
+      reply.sockname = out;
     }
+    send(null, reply, null);
     self.handoff(worker);  // In case there are connections pending.
   }
 
@@ -171,7 +224,14 @@ RoundRobinHandle.prototype.remove = function(worker) {
   delete this.all[worker.id];
   var index = this.free.indexOf(worker);
   if (index !== -1) this.free.splice(index, 1);
-  if (Object.getOwnPropertyNames(this.all).length !== 0) return false;
+  if (Object.getOwnPropertyNames(this.all).length !== 0) {
+    // Queued connections may have been waiting for this worker.
+    if (this.handles.length !== 0) {
+      var next = this.next();
+      if (next) this.handoff(next);
+    }
+    return false;
+  }
   for (var handle; handle = this.handles.shift(); handle.close());
   this.handle.close();
   this.handle = null;
@@ -180,21 +240,61 @@ RoundRobinHandle.prototype.remove = function(worker) {
 
 RoundRobinHandle.prototype.distribute = function(err, handle) {
   this.handles.push(handle);
-  var worker = this.free.shift();
+  var worker = this.next();
   if (worker) this.handoff(worker);
 };
 
+// Take the worker that should get the next connection off the free list.
+// Round-robin takes the one that has waited longest. The other policies
+// take the least loaded worker, going by what the workers last reported.
+// Connection counts are exact, so least-connections returns nothing while
+// that worker is still busy acknowledging a previous connection; it picks
+// up the next one from handoff() when it's done. Lag is coarse and goes
+// stale quickly, least-lag settles for the least loaded free worker.
+RoundRobinHandle.prototype.next = function() {
+  if (this.balance === BALANCE_RR)
+    return this.free.shift();
+
+  var now = Date.now();
+  var best = null;
+  var bestFree = null;
+  for (var id in this.all) {
+    var worker = this.all[id];
+    if (!best || compareLoad(this.balance, worker, best, now) < 0)
+      best = worker;
+    if (this.free.indexOf(worker) === -1)
+      continue;
+    if (!bestFree || compareLoad(this.balance, worker, bestFree, now) < 0)
+      bestFree = worker;
+  }
+  if (!bestFree)
+    return;
+  if (this.balance !== BALANCE_LAG &&
+      compareLoad(this.balance, best, bestFree, now) < 0) {
+    return;
+  }
+  return this.free.splice(this.free.indexOf(bestFree), 1)[0];
+};
+
 RoundRobinHandle.prototype.handoff = function(worker) {
   if (worker.id in this.all === false) {
     return;  // Worker is closing (or has closed) the server.
   }
-  var handle = this.handles.shift();
-  if (util.isUndefined(handle)) {
+  if (this.handles.length === 0) {
     this.free.push(worker);  // Add to ready queue again.
     return;
   }
+  if (this.balance !== BALANCE_RR) {
+    // More connections are queued, don't just give them to whichever worker
+    // happened to finish first.
+    this.free.push(worker);
+    worker = this.next();
+    if (!worker) return;
+  }
+  var handle = this.handles.shift();
   var message = { act: 'newconn', key: this.key };
   var self = this;
+  worker.load.handoffs += 1;
   sendHelper(worker.process, message, handle, function(reply) {
     if (reply.accepted)
       handle.close();
@@ -205,6 +305,32 @@ RoundRobinHandle.prototype.handoff = function(worker) {
 };
 
 
+// Connections that a worker is thought to have right now: the number that
+// it last reported, plus the ones that it has been sent since.
+function estimateConnections(worker) {
+  var load = worker.load;
+  return load.connections + Math.max(0, load.handoffs - load.accepted);
+}
+
+// Lag as the worker last reported it. A worker that misses its reports is
+// most likely blocked, its lag keeps growing from when the report was due.
+function estimateLag(worker, now) {
+  var load = worker.load;
+  return Math.max(load.lag, now - load.reported - 2 * LOAD_REPORT_INTERVAL);
+}
+
+// Lag is only known to the millisecond and a few times per second, ties
+// are rare. Weigh it against the connections sent since the last report,
+// or a burst of connections all goes to the same worker.
+function compareLoad(balance, a, b, now) {
+  if (balance === BALANCE_LAG) {
+    return (estimateLag(a, now) + 1) * (estimateConnections(a) + 1) -
+           (estimateLag(b, now) + 1) * (estimateConnections(b) + 1);
+  }
+  return estimateConnections(a) - estimateConnections(b);
+}
+
+
 if (cluster.isMaster)
   masterInit();
 else
@@ -219,7 +345,8 @@ function masterInit() {
   // XXX(bnoordhuis) Fold cluster.schedulingPolicy into cluster.settings?
   var schedulingPolicy = {
     'none': SCHED_NONE,
-    'rr': SCHED_RR
+    'rr': SCHED_RR,
+    'reuseport': SCHED_REUSEPORT
   }[process.env.NODE_CLUSTER_SCHED_POLICY];
 
   if (util.isUndefined(schedulingPolicy)) {
@@ -231,12 +358,33 @@ function masterInit() {
   cluster.schedulingPolicy = schedulingPolicy;
   cluster.SCHED_NONE = SCHED_NONE;  // Leave it to the operating system.
   cluster.SCHED_RR = SCHED_RR;      // Master distributes connections.
+  cluster.SCHED_REUSEPORT = SCHED_REUSEPORT;  // Kernel distributes them.
 
   // Keyed on address:port:etc. When a worker dies, we walk over the handles
   // and remove() the worker from each one. remove() may do a linear scan
   // itself so we might end up with an O(n*m) operation. Ergo, FIXME.
   var handles = {};
 
+  // Server data can list temporary files that all workers of the server
+  // open, like the file behind a TLS session cache. Workers come and go, so
+  // the master removes them once the handle goes away.
+  function removeHandle(key) {
+    var handle = handles[key];
+    delete handles[key];
+    removeTempFiles(handle.data);
+  }
+
+  function removeTempFiles(data) {
+    if (!data || !util.isArray(data.tempFiles)) return;
+    data.tempFiles.forEach(function(file) {
+      try {
+        fs.unlinkSync(file);
+      } catch (e) {
+        // Already gone or never created.
+      }
+    });
+  }
+
   var initialized = false;
   cluster.setupMaster = function(options) {
     var settings = {
@@ -256,6 +404,11 @@ function masterInit() {
     {
       settings.execArgv = settings.execArgv.concat(['--logfile=v8-%p.log']);
     }
+    assert(util.isUndefined(settings.balance) ||
+           settings.balance === BALANCE_RR ||
+           settings.balance === BALANCE_CONNECTIONS ||
+           settings.balance === BALANCE_LAG,
+           'Bad cluster.settings.balance: ' + settings.balance);
     cluster.settings = settings;
     if (initialized === true)
       return process.nextTick(function() {
@@ -263,9 +416,16 @@ function masterInit() {
       });
     initialized = true;
     schedulingPolicy = cluster.schedulingPolicy;  // Freeze policy.
-    assert(schedulingPolicy === SCHED_NONE || schedulingPolicy === SCHED_RR,
+    assert(schedulingPolicy === SCHED_NONE ||
+           schedulingPolicy === SCHED_RR ||
+           schedulingPolicy === SCHED_REUSEPORT,
            'Bad cluster.schedulingPolicy: ' + schedulingPolicy);
 
+    process.on('exit', function() {
+      for (var key in handles)
+        removeTempFiles(handles[key].data);
+    });
+
     process.on('internalMessage', function(message) {
       if (message.cmd !== 'NODE_DEBUG_ENABLED') return;
       var key;
@@ -303,6 +463,7 @@ function masterInit() {
       env: workerEnv,
       silent: cluster.settings.silent,
       execArgv: execArgv,
+      serialization: cluster.settings.serialization,
       gid: cluster.settings.gid,
       uid: cluster.settings.uid
     });
@@ -318,6 +479,13 @@ function masterInit() {
       id: id,
       process: workerProcess
     });
+    worker.load = {
+      handoffs: 0,     // Connections sent to the worker by the master.
+      accepted: 0,     // Of those, the ones the worker has reported.
+      connections: 0,  // Open connections, as last reported.
+      lag: 0,          // Event loop lag in ms, as last reported.
+      reported: 0      // Time of the last report.
+    };
 
     function removeWorker(worker) {
       assert(worker);
@@ -335,7 +503,7 @@ function masterInit() {
 
       for (var key in handles) {
         var handle = handles[key];
-        if (handle.remove(worker)) delete handles[key];
+        if (handle.remove(worker)) removeHandle(key);
       }
     }
 
@@ -423,6 +591,15 @@ function masterInit() {
       worker.suicide = true;
     else if (message.act === 'close')
       close(worker, message);
+    else if (message.act === 'load')
+      load(worker, message);
+  }
+
+  function load(worker, message) {
+    worker.load.accepted = message.accepted;
+    worker.load.connections = message.connections;
+    worker.load.lag = message.lag;
+    worker.load.reported = Date.now();
   }
 
   function online(worker) {
@@ -448,6 +625,15 @@ function masterInit() {
           message.addressType === 'udp6') {
         constructor = SharedHandle;
       }
+      // SO_REUSEPORT only applies to TCP sockets that are bound by address,
+      // not to UDP sockets, UNIX sockets or inherited file descriptors.
+      if (schedulingPolicy === SCHED_REUSEPORT &&
+          message.addressType !== 'udp4' &&
+          message.addressType !== 'udp6' &&
+          message.addressType !== -1 &&
+          !(message.fd >= 0)) {
+        constructor = ReusePortHandle;
+      }
       handles[key] = handle = new constructor(key,
                                               message.address,
                                               message.port,
@@ -465,7 +651,7 @@ function masterInit() {
         ack: message.seq,
         data: handles[key].data
       }, reply);
-      if (errno) delete handles[key];  // Gives other workers a chance to retry.
+      if (errno) removeHandle(key);  // Gives other workers a chance to retry.
       send(worker, reply, handle);
     });
   }
@@ -486,7 +672,7 @@ function masterInit() {
   function close(worker, message) {
     var key = message.key;
     var handle = handles[key];
-    if (handle.remove(worker)) delete handles[key];
+    if (handle.remove(worker)) removeHandle(key);
   }
 
   function send(worker, message, handle, cb) {
@@ -536,10 +722,13 @@ function workerInit() {
     // Set custom data on handle (i.e. tls tickets key)
     if (obj._getServerData) message.data = obj._getServerData();
     send(message, function(reply, handle) {
-      if (obj._setServerData) obj._setServerData(reply.data);
+      // The master drops the server data of a handle that failed to bind.
+      if (obj._setServerData && !reply.errno) obj._setServerData(reply.data);
 
       if (handle)
         shared(reply, handle, cb);  // Shared listen socket.
+      else if (reply.reuseport)
+        reuseport(reply, address, addressType, cb);  // Socket per worker.
       else
         rr(reply, cb);              // Round-robin.
     });
@@ -567,11 +756,29 @@ function workerInit() {
     cb(message.errno, handle);
   }
 
+  // SO_REUSEPORT. Bind to the port that the master reserved.
+  function reuseport(message, address, addressType, cb) {
+    if (message.errno)
+      return cb(message.errno, null);
+
+    var handle = net._createServerHandle(address,
+                                         message.sockname.port,
+                                         addressType,
+                                         null,
+                                         UV_TCP_REUSEPORT);
+    if (util.isNumber(handle))
+      return cb(handle, null);
+    shared(message, handle, cb);
+  }
+
   // Round-robin. Master distributes handles across workers.
   function rr(message, cb) {
     if (message.errno)
       return cb(message.errno, null);
 
+    if (message.loadReport)
+      startLoadReports(message.loadReport);
+
     var key = message.key;
     function listen(backlog) {
       // TODO(bnoordhuis) Send a message to the master that tells it to
@@ -619,6 +826,36 @@ function workerInit() {
     var accepted = !util.isUndefined(server);
     send({ ack: message.seq, accepted: accepted });
     if (accepted) server.onconnection(0, handle);
+    acceptedCount += 1;  // Includes refusals, the master counts those too.
+  }
+
+  // Tells the master how busy this worker is, so it can send connections
+  // to the least loaded worker. Lag is how late the report timer fires.
+  var acceptedCount = 0;
+  var reportingLoad = false;
+  function startLoadReports(interval) {
+    if (reportingLoad) return;
+    reportingLoad = true;
+
+    var due = Date.now() + interval;
+    setTimeout(function report() {
+      if (!process.connected) return;  // Disconnecting, the master is gone.
+      var now = Date.now();
+      var connections = 0;
+      for (var key in handles) {
+        var server = handles[key].owner;
+        // UDP sockets have none.
+        if (server) connections += server._connections | 0;
+      }
+      send({
+        act: 'load',
+        accepted: acceptedCount,
+        connections: connections,
+        lag: Math.max(0, now - due)
+      });
+      due = now + interval;
+      setTimeout(report, interval).unref();
+    }, interval).unref();
   }
 
   Worker.prototype.disconnect = function() {
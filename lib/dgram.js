@@ -66,6 +66,7 @@ function newHandle(type) {
     handle.lookup = lookup6;
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
     return handle;
   }
 
@@ -114,6 +115,9 @@ function Socket(type, listener) {
   // If true - UV_UDP_REUSEADDR flag will be set
   this._reuseAddr = options && options.reuseAddr;
 
+  // If true - UV_UDP_RECVMMSG flag will be set
+  this._batch = options && options.batch;
+
   if (util.isFunction(listener))
     this.on('message', listener);
 }
@@ -128,6 +132,7 @@ exports.createSocket = function(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  socket._handle.onmessages = onMessages;
   // Todo: handle errors
   socket._handle.recvStart();
   socket._receiving = true;
@@ -143,6 +148,7 @@ function replaceHandle(self, newHandle) {
   newHandle.lookup = self._handle.lookup;
   newHandle.bind = self._handle.bind;
   newHandle.send = self._handle.send;
+  newHandle.sendBatch = self._handle.sendBatch;
   newHandle.owner = self;
 
   // Replace the existing handle by the handle we got from master.
@@ -216,6 +222,8 @@ Socket.prototype.bind = function(port /*, address, callback*/) {
       var flags = 0;
       if (self._reuseAddr)
         flags |= constants.UV_UDP_REUSEADDR;
+      if (self._batch)
+        flags |= constants.UV_UDP_RECVMMSG;
 
       var err = self._handle.bind(ip, port || 0, flags);
       if (err) {
@@ -340,6 +348,77 @@ Socket.prototype.send = function(buffer,
 };
 
 
+Socket.prototype.sendBatch = function(buffers, port, address, callback) {
+  var self = this;
+
+  if (!util.isArray(buffers))
+    throw new TypeError('First argument must be an array of buffers.');
+
+  // Convert into a list of our own, the caller's array is left alone.
+  var list = new Array(buffers.length);
+  var length = 0;
+  for (var i = 0; i < buffers.length; i++) {
+    var buffer = buffers[i];
+    if (util.isString(buffer))
+      buffer = new Buffer(buffer);
+    if (!util.isBuffer(buffer))
+      throw new TypeError('First argument must be an array of buffers.');
+    list[i] = buffer;
+    length += buffer.length;
+  }
+  buffers = list;
+
+  port = port | 0;
+  if (port <= 0 || port > 65535)
+    throw new RangeError('Port should be > 0 and < 65536');
+
+  if (!util.isFunction(callback))
+    callback = undefined;
+
+  self._healthCheck();
+
+  if (buffers.length === 0) {
+    if (callback)
+      process.nextTick(function() {
+        callback(null, 0);
+      });
+    return;
+  }
+
+  if (self._bindState == BIND_STATE_UNBOUND)
+    self.bind(0, null);
+
+  if (self._bindState != BIND_STATE_BOUND) {
+    self.once('listening', function() {
+      self.sendBatch(buffers, port, address, callback);
+    });
+    return;
+  }
+
+  // One lookup for the whole batch, the datagrams are handed to libuv back to
+  // back so they can go out with a single sendmmsg() call.
+  self._handle.lookup(address, function(ex, ip) {
+    if (ex) {
+      if (callback) callback(ex);
+      self.emit('error', ex);
+    }
+    else if (self._handle) {
+      var req = { buffers: buffers, length: length };  // Keep reference alive.
+      if (callback) {
+        req.callback = callback;
+        req.oncomplete = afterSend;
+      }
+      var err = self._handle.sendBatch(req, buffers, port, ip, !!callback);
+      if (err && callback) {
+        process.nextTick(function() {
+          callback(errnoException(err, 'send'));
+        });
+      }
+    }
+  });
+};
+
+
 function afterSend(err) {
   this.callback(err ? errnoException(err, 'send') : null, this.length);
 }
@@ -469,6 +548,26 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+// Called with all datagrams of one recvmmsg() batch, packed back to back in
+// `buf`.
+function onMessages(count, handle, buf, lengths, rinfos) {
+  var self = handle.owner;
+  var msgs = new Array(count);
+  var offset = 0;
+
+  for (var i = 0; i < count; i++) {
+    msgs[i] = buf.slice(offset, offset += lengths[i]);
+    rinfos[i].size = lengths[i]; // compatibility
+  }
+
+  if (self.listeners('messages').length > 0)
+    return self.emit('messages', msgs, rinfos);
+
+  for (var i = 0; i < count && self._handle; i++)
+    self.emit('message', msgs[i], rinfos[i]);
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
@@ -220,6 +220,18 @@ fs.readFile = function(path, options, callback_) {
   var fd;
 
   var flag = options.flag || 'r';
+
+  // The binding does open, fstat, read and close in one trip to the thread
+  // pool where it can.
+  if (binding.readFile) {
+    if (!nullCheck(path, callback)) return;
+    binding.readFile(pathModule._makeLong(path),
+                     stringToFlags(flag),
+                     encoding,
+                     callback);
+    return;
+  }
+
   fs.open(path, flag, 438 /*=0666*/, function(er, fd_) {
     if (er) return callback(er);
     fd = fd_;
@@ -565,6 +577,60 @@ fs.writeSync = function(fd, buffer, offset, length, position) {
   return binding.writeString(fd, buffer, offset, length, position);
 };
 
+// usage:
+//  fs.writev(fd, buffers[, position], callback);
+fs.writev = function(fd, buffers, position, callback) {
+  if (util.isFunction(position)) {
+    callback = position;
+    position = null;
+  }
+  if (!util.isArray(buffers))
+    throw new TypeError('buffers must be an array');
+  callback = maybeCallback(callback);
+  var wrapper = function(err, written) {
+    // Retain a reference to buffers so that they can't be GC'ed too soon.
+    callback(err, written || 0, buffers);
+  };
+  return binding.writeBuffers(fd, buffers, position, wrapper);
+};
+
+// usage:
+//  fs.writevSync(fd, buffers[, position]);
+fs.writevSync = function(fd, buffers, position) {
+  if (!util.isArray(buffers))
+    throw new TypeError('buffers must be an array');
+  if (util.isUndefined(position))
+    position = null;
+  return binding.writeBuffers(fd, buffers, position);
+};
+
+// usage:
+//  fs.readv(fd, buffers[, position], callback);
+fs.readv = function(fd, buffers, position, callback) {
+  if (util.isFunction(position)) {
+    callback = position;
+    position = null;
+  }
+  if (!util.isArray(buffers))
+    throw new TypeError('buffers must be an array');
+  callback = maybeCallback(callback);
+  var wrapper = function(err, bytesRead) {
+    // Retain a reference to buffers so that they can't be GC'ed too soon.
+    callback(err, bytesRead || 0, buffers);
+  };
+  return binding.readBuffers(fd, buffers, position, wrapper);
+};
+
+// usage:
+//  fs.readvSync(fd, buffers[, position]);
+fs.readvSync = function(fd, buffers, position) {
+  if (!util.isArray(buffers))
+    throw new TypeError('buffers must be an array');
+  if (util.isUndefined(position))
+    position = null;
+  return binding.readBuffers(fd, buffers, position);
+};
+
 fs.rename = function(oldPath, newPath, callback) {
   callback = makeCallback(callback);
   if (!nullCheck(oldPath, callback)) return;
@@ -1706,6 +1772,58 @@ WriteStream.prototype._write = function(data, encoding, cb) {
 };
 
 
+// Flushes everything that queued up while a write was pending (or the
+// stream was corked) with one writev() instead of one write() per chunk.
+WriteStream.prototype._writev = function(data, cb) {
+  if (!util.isNumber(this.fd))
+    return this.once('open', function() {
+      this._writev(data, cb);
+    });
+
+  var chunks = new Array(data.length);
+  var size = 0;
+  for (var i = 0; i < data.length; i++) {
+    var chunk = data[i].chunk;
+    if (!util.isBuffer(chunk))
+      return this.emit('error', new Error('Invalid data'));
+    chunks[i] = chunk;
+    size += chunk.length;
+  }
+
+  writevAll(this, chunks, this.pos, cb);
+
+  if (!util.isUndefined(this.pos))
+    this.pos += size;
+};
+
+// writev() can write less than asked for, e.g. when there are more chunks
+// than the iovec limit. Keep going with what's left.
+function writevAll(stream, chunks, position, cb) {
+  fs.writev(stream.fd, chunks, position, function(er, bytes) {
+    if (er) {
+      stream.destroy();
+      return cb(er);
+    }
+    stream.bytesWritten += bytes;
+
+    if (util.isNumber(position))
+      position += bytes;
+
+    var i = 0;
+    while (i < chunks.length && bytes >= chunks[i].length)
+      bytes -= chunks[i++].length;
+
+    if (i === chunks.length)
+      return cb();
+
+    chunks = chunks.slice(i);
+    if (bytes > 0)
+      chunks[0] = chunks[0].slice(bytes);
+    writevAll(stream, chunks, position, cb);
+  });
+}
+
+
 WriteStream.prototype.destroy = ReadStream.prototype.destroy;
 WriteStream.prototype.close = ReadStream.prototype.close;
 
@@ -150,6 +150,260 @@ function tryExtensions(p, exts) {
 }
 
 
+// Persistent resolution cache, opt in with NODE_MODULE_RESOLVE_CACHE=file.
+//
+// With large dependency trees much of the startup time goes to the stat()
+// calls _findPath() makes while probing node_modules directories. The cache
+// file remembers every resolution along with the mtime of the directories
+// the probing depended on. As long as none of those changed no file can have
+// appeared or disappeared where it would change the outcome, so the next run
+// reuses the result after a stat() per directory, shared by all requests
+// that depend on it.
+//
+// The file is JSON:
+//   paths:   the paths that are checked or looked up in, and
+//   stamps:  their mtime in ms when last seen, -1 if they didn't exist
+//   lists:   [extensions, path index, ...] of a _findPath() call
+//   entries: '<list index>\0<request>' -> [filename, path index, ...]
+var resolveCacheFile = process.env.NODE_MODULE_RESOLVE_CACHE;
+var resolveCache = null;
+
+function pathStamp(requestPath) {
+  var stats = statPath(requestPath);
+  return stats ? stats.mtime.getTime() : -1;
+}
+
+function ResolveCache(filename, data) {
+  this.filename = filename;
+  this.paths = data.paths;
+  this.stamps = data.stamps;
+  this.lists = [];
+  this.entries = data.entries;
+  this.pathIds = {};
+  this.listIds = {};
+  // Stamps seen by this process, by path index.
+  this.current = [];
+  // Entries resolved by this process, those don't need checking.
+  this.added = {};
+  // Directory -> index of itself or its closest existing ancestor.
+  this.dirs = {};
+  this.dirty = false;
+
+  for (var i = 0; i < this.paths.length; i++)
+    this.pathIds[this.paths[i]] = i;
+
+  // Lists are looked up by their extensions and paths joined together.
+  for (var i = 0; i < data.lists.length; i++) {
+    var list = data.lists[i];
+    var parts = [list[0]];
+    for (var j = 1; j < list.length; j++)
+      parts.push(this.paths[list[j]]);
+    this.lists.push(parts.join('\0'));
+    this.listIds[this.lists[i]] = i;
+  }
+}
+
+ResolveCache.load = function(filename) {
+  filename = path.resolve(filename);
+
+  var cache;
+  try {
+    var data = JSON.parse(fs.readFileSync(filename, 'utf8'));
+    if (data.version === process.version &&
+        util.isArray(data.paths) &&
+        util.isArray(data.stamps) &&
+        util.isArray(data.lists) &&
+        util.isObject(data.entries)) {
+      cache = new ResolveCache(filename, data);
+    }
+  } catch (e) {}
+
+  if (!cache) {
+    cache = new ResolveCache(filename,
+                             { paths: [], stamps: [], lists: [], entries: {} });
+  }
+
+  process.on('exit', function() {
+    cache.save();
+  });
+  return cache;
+};
+
+// Relative lookup paths depend on the working directory, skip those.
+ResolveCache.prototype.listKey = function(paths, exts) {
+  for (var i = 0; i < paths.length; i++) {
+    if (paths[i] !== '' && !path.isAbsolute(paths[i]))
+      return false;
+  }
+  return exts.join(',') + '\0' + paths.join('\0');
+};
+
+ResolveCache.prototype.pathId = function(requestPath) {
+  var id = this.pathIds[requestPath];
+  if (util.isUndefined(id))
+    id = this.pathIds[requestPath] = this.paths.push(requestPath) - 1;
+  return id;
+};
+
+ResolveCache.prototype.check = function(id) {
+  var stamp = this.current[id];
+  if (util.isUndefined(stamp))
+    stamp = this.current[id] = pathStamp(this.paths[id]);
+  return stamp;
+};
+
+// Whether nothing this process has seen contradicts the entry's stamps.
+ResolveCache.prototype.fresh = function(entry) {
+  for (var i = 1; i < entry.length; i++) {
+    var stamp = this.current[entry[i]];
+    if (!util.isUndefined(stamp) && stamp !== this.stamps[entry[i]])
+      return false;
+  }
+  return true;
+};
+
+ResolveCache.prototype.lookup = function(listKey, request) {
+  if (!hasOwnProperty(this.listIds, listKey))
+    return false;
+
+  var key = this.listIds[listKey] + '\0' + request;
+  if (!hasOwnProperty(this.entries, key))
+    return false;
+
+  var entry = this.entries[key];
+  if (!this.added[key]) {
+    for (var i = 1; i < entry.length; i++) {
+      if (this.check(entry[i]) !== this.stamps[entry[i]]) {
+        delete this.entries[key];
+        this.dirty = true;
+        return false;
+      }
+    }
+  }
+  return entry[0];
+};
+
+// Record what probing basePaths depended on: the directories files named
+// after the request would show up in, a directory of that name where a
+// package.json or index file could appear, and the package.json and main
+// script of the package that matched. Anything that doesn't exist yet is
+// covered by the directory it would be created in.
+ResolveCache.prototype.store = function(listKey, request, basePaths, filename) {
+  var self = this;
+  var entry = [filename];
+
+  function add(id) {
+    var stamp = self.check(id);
+    if (util.isUndefined(self.stamps[id]))
+      self.stamps[id] = stamp;
+    if (stamp !== -1 && entry.indexOf(id, 1) === -1)
+      entry.push(id);
+    return stamp;
+  }
+
+  // A missing directory can only come back by way of its parent.
+  function addDir(dir) {
+    if (!hasOwnProperty(self.dirs, dir)) {
+      var anchor = dir;
+      while (self.check(self.pathId(anchor)) === -1 &&
+             path.dirname(anchor) !== anchor) {
+        anchor = path.dirname(anchor);
+      }
+      self.dirs[dir] = self.pathId(anchor);
+    }
+    add(self.dirs[dir]);
+    return self.check(self.pathId(dir));
+  }
+
+  for (var i = 0; i < basePaths.length; i++) {
+    var basePath = basePaths[i];
+    if (addDir(path.dirname(basePath)) !== -1)
+      add(this.pathId(basePath));
+  }
+
+  var pkg = packageMainCache[basePath];
+  if (pkg) {
+    var main = path.resolve(basePath, pkg);
+    add(this.pathId(path.resolve(basePath, 'package.json')));
+    if (addDir(path.dirname(main)) !== -1)
+      add(this.pathId(main));
+  }
+  addDir(path.dirname(filename));
+
+  if (!hasOwnProperty(this.listIds, listKey))
+    this.listIds[listKey] = this.lists.push(listKey) - 1;
+  var key = this.listIds[listKey] + '\0' + request;
+  this.entries[key] = entry;
+  this.added[key] = true;
+  this.dirty = true;
+};
+
+// Write out what's still valid, keeping only the lists and paths in use.
+ResolveCache.prototype.save = function() {
+  if (!this.dirty)
+    return;
+
+  var self = this;
+  var data = {
+    version: process.version,
+    paths: [],
+    stamps: [],
+    lists: [],
+    entries: {}
+  };
+  var pathMap = [];
+  var listMap = [];
+
+  function mapPath(id) {
+    if (util.isUndefined(pathMap[id])) {
+      var stamp = self.current[id];
+      if (util.isUndefined(stamp))
+        stamp = self.stamps[id];
+      pathMap[id] = data.paths.push(self.paths[id]) - 1;
+      data.stamps.push(util.isUndefined(stamp) ? -1 : stamp);
+    }
+    return pathMap[id];
+  }
+
+  function mapList(id) {
+    if (util.isUndefined(listMap[id])) {
+      var parts = self.lists[id].split('\0');
+      var list = [parts[0]];
+      for (var i = 1; i < parts.length; i++)
+        list.push(mapPath(self.pathId(parts[i])));
+      listMap[id] = data.lists.push(list) - 1;
+    }
+    return listMap[id];
+  }
+
+  for (var key in this.entries) {
+    var entry = this.entries[key];
+    if (!this.added[key] && !this.fresh(entry))
+      continue;
+
+    var ids = [entry[0]];
+    for (var i = 1; i < entry.length; i++)
+      ids.push(mapPath(entry[i]));
+
+    var sep = key.indexOf('\0');
+    data.entries[mapList(+key.slice(0, sep)) + key.slice(sep)] = ids;
+  }
+
+  // Rename into place so concurrent processes never see half a file, the
+  // cache is only an optimization so failing to write it is not an error.
+  var tmp = this.filename + '.' + process.pid;
+  try {
+    fs.writeFileSync(tmp, JSON.stringify(data));
+    fs.renameSync(tmp, this.filename);
+  } catch (e) {
+    try {
+      fs.unlinkSync(tmp);
+    } catch (er) {}
+  }
+  this.dirty = false;
+};
+
+
 Module._findPath = function(request, paths) {
   var exts = Object.keys(Module._extensions);
 
@@ -164,11 +418,31 @@ Module._findPath = function(request, paths) {
     return Module._pathCache[cacheKey];
   }
 
+  // Only filled in for the persistent cache.
+  var listKey = false;
+  var basePaths = null;
+  if (resolveCacheFile) {
+    if (!resolveCache)
+      resolveCache = ResolveCache.load(resolveCacheFile);
+    listKey = resolveCache.listKey(paths, exts);
+  }
+  if (listKey !== false) {
+    var cached = resolveCache.lookup(listKey, request);
+    if (cached) {
+      Module._pathCache[cacheKey] = cached;
+      return cached;
+    }
+    basePaths = [];
+  }
+
   // For each path
   for (var i = 0, PL = paths.length; i < PL; i++) {
     var basePath = path.resolve(paths[i], request);
     var filename;
 
+    if (basePaths)
+      basePaths.push(basePath);
+
     if (!trailingSlash) {
       // try to join the request to the path
       filename = tryFile(basePath);
@@ -190,6 +464,8 @@ Module._findPath = function(request, paths) {
 
     if (filename) {
       Module._pathCache[cacheKey] = filename;
+      if (basePaths)
+        resolveCache.store(listKey, request, basePaths, filename);
       return filename;
     }
   }
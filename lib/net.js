@@ -27,6 +27,7 @@ var assert = require('assert');
 var cares = process.binding('cares_wrap');
 var uv = process.binding('uv');
 var Pipe = process.binding('pipe_wrap').Pipe;
+var FS = process.binding('fs');
 
 
 var cluster;
@@ -456,10 +457,22 @@ Socket.prototype._destroy = function(exception, cb) {
     if (this !== process.stderr)
       debug('close handle');
     var isException = exception ? true : false;
-    this._handle.close(function() {
-      debug('emit close');
-      self.emit('close', isException);
-    });
+    var handle = this._handle;
+    var close = function() {
+      handle.close(function() {
+        debug('emit close');
+        self.emit('close', isException);
+      });
+    };
+    if (this._sendingFile) {
+      // sendfile() is still writing to the fd on the thread pool, closing it
+      // now could hand the fd to someone else halfway through. Shut down the
+      // write side so a sendfile() that waits for a stalled peer returns.
+      handle.shutdown({ oncomplete: noop });
+      this._afterSendFile = close;
+    } else {
+      close();
+    }
     this._handle.onread = noop;
     this._handle = null;
   }
@@ -611,6 +624,123 @@ Socket.prototype.write = function(chunk, encoding, cb) {
 };
 
 
+// Sends `length` bytes of file `fd`, starting at `offset`, after the data
+// that's already been written. Plain TCP sockets hand the file to sendfile(2)
+// so the data never passes through JS land.
+Socket.prototype.sendFile = function(fd, offset, length, cb) {
+  // Rides the Writable queue like any other chunk so it stays in order.
+  return stream.Duplex.prototype.write.call(this,
+                                            createSendFileChunk(fd,
+                                                                offset,
+                                                                length),
+                                            cb);
+};
+
+
+function createSendFileChunk(fd, offset, length) {
+  if (!util.isNumber(fd) || fd < 0)
+    throw new TypeError('fd must be a file descriptor');
+  if (!util.isNumber(offset) || offset < 0)
+    throw new TypeError('offset must be a non-negative number');
+  if (!util.isNumber(length) || length < 0)
+    throw new TypeError('length must be a non-negative number');
+
+  var chunk = new Buffer(0);
+  chunk._sendFile = { fd: fd, offset: offset, length: length };
+  return chunk;
+}
+exports._createSendFileChunk = createSendFileChunk;
+
+
+function writeFile(self, file, cb) {
+  // TLS sockets keep the TCP handle but their writes get encrypted first
+  var fd = self._handle.fd;
+  if (util.isNumber(fd) && fd >= 0 && !self.encrypted)
+    sendFile(self, fd, file, cb);
+  else
+    copyFile(self, file, cb);
+}
+
+
+function fileTooShort(self, cb) {
+  self._destroy(new Error('File is shorter than the requested length'), cb);
+}
+
+
+function sendFile(self, fd, file, cb) {
+  var offset = file.offset;
+  var remaining = file.length;
+
+  self._sendingFile = true;
+  next();
+
+  function next() {
+    if (remaining === 0) {
+      self._sendingFile = false;
+      return cb();
+    }
+    FS.sendfile(fd, file.fd, offset, remaining, onsent);
+  }
+
+  function onsent(err, bytes) {
+    self._sendingFile = false;
+    if (self._afterSendFile) {
+      var close = self._afterSendFile;
+      self._afterSendFile = null;
+      return close();
+    }
+
+    if (self.destroyed)
+      return;
+    if (err)
+      return self._destroy(err, cb);
+    if (bytes === 0)
+      return fileTooShort(self, cb);
+
+    timers._unrefActive(self);
+    self._bytesDispatched += bytes;
+    offset += bytes;
+    remaining -= bytes;
+    self._sendingFile = true;
+    next();
+  }
+}
+
+
+// Handles without a file descriptor and TLS sockets get the file read into
+// buffers and written out the normal way.
+function copyFile(self, file, cb) {
+  var fs = require('fs');
+  var offset = file.offset;
+  var remaining = file.length;
+
+  next();
+
+  function next() {
+    if (remaining === 0)
+      return cb();
+
+    var buffer = new Buffer(Math.min(remaining, 64 * 1024));
+    fs.read(file.fd, buffer, 0, buffer.length, offset, function(err, bytes) {
+      if (self.destroyed)
+        return;
+      if (err)
+        return self._destroy(err, cb);
+      if (bytes === 0)
+        return fileTooShort(self, cb);
+
+      offset += bytes;
+      remaining -= bytes;
+      self._writeGeneric(false, buffer.slice(0, bytes), 'buffer', function(er) {
+        if (er)
+          return cb(er);
+        next();
+      });
+    });
+  }
+}
+
+
 Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
   // If we are still connecting, then buffer this for later.
   // The Writable logic will buffer up any more writes while
@@ -633,6 +763,9 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
     return false;
   }
 
+  if (!writev && data._sendFile)
+    return writeFile(this, data._sendFile, cb);
+
   var req = { oncomplete: afterWrite, async: false };
   var err;
 
@@ -675,10 +808,27 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
 
 
 Socket.prototype._writev = function(chunks, cb) {
+  for (var i = 0; i < chunks.length; i++) {
+    if (chunks[i].chunk._sendFile)
+      return writeInOrder(this, chunks, 0, cb);
+  }
   this._writeGeneric(true, chunks, '', cb);
 };
 
 
+// A batch with a file in it is written one chunk at a time.
+function writeInOrder(self, chunks, i, cb) {
+  if (i === chunks.length)
+    return cb();
+  var entry = chunks[i];
+  self._writeGeneric(false, entry.chunk, entry.encoding, function(er) {
+    if (er)
+      return cb(er);
+    writeInOrder(self, chunks, i + 1, cb);
+  });
+}
+
+
 Socket.prototype._write = function(data, encoding, cb) {
   this._writeGeneric(false, data, encoding, cb);
 };
@@ -1024,6 +1174,7 @@ function Server(/* [ options, ] listener */) {
   this._slaves = [];
 
   this.allowHalfOpen = options.allowHalfOpen || false;
+  this.acceptBatch = options.acceptBatch >>> 0 || 1;
 }
 util.inherits(Server, events.EventEmitter);
 exports.Server = Server;
@@ -1038,8 +1189,9 @@ function _listen(handle, backlog) {
   return handle.listen(backlog || 511);
 }
 
+// `flags` is passed on to bind(), e.g. TCP.UV_TCP_REUSEPORT.
 var createServerHandle = exports._createServerHandle =
-    function(address, port, addressType, fd) {
+    function(address, port, addressType, fd, flags) {
   var err = 0;
   // assign handle in listen, and clean up if bind or listen fails
   var handle;
@@ -1075,16 +1227,16 @@ var createServerHandle = exports._createServerHandle =
     debug('bind to ' + (address || 'anycast'));
     if (!address) {
       // Try binding to ipv6 first
-      err = handle.bind6('::', port);
+      err = handle.bind6('::', port, flags);
       if (err) {
         handle.close();
         // Fallback to ipv4
-        return createServerHandle('0.0.0.0', port);
+        return createServerHandle('0.0.0.0', port, 4, null, flags);
       }
     } else if (addressType === 6) {
-      err = handle.bind6(address, port);
+      err = handle.bind6(address, port, flags);
     } else {
-      err = handle.bind(address, port);
+      err = handle.bind(address, port, flags);
     }
   }
 
@@ -1121,6 +1273,9 @@ Server.prototype._listen2 = function(address, port, addressType, backlog, fd) {
   self._handle.onconnection = onconnection;
   self._handle.owner = self;
 
+  if (self.acceptBatch > 1 && self._handle.setAcceptBatch)
+    self._handle.setAcceptBatch(self.acceptBatch);
+
   var err = _listen(self._handle, backlog);
 
   if (err) {
@@ -1280,6 +1435,19 @@ function onconnection(err, clientHandle) {
     return;
   }
 
+  // With acceptBatch > 1 the handles of all connections accepted in one go
+  // are delivered as an array.
+  if (util.isArray(clientHandle)) {
+    for (var i = 0; i < clientHandle.length; i++)
+      acceptConnection(self, clientHandle[i]);
+    return;
+  }
+
+  acceptConnection(self, clientHandle);
+}
+
+
+function acceptConnection(self, clientHandle) {
   if (self.maxConnections && self._connections >= self.maxConnections) {
     clientHandle.close();
     return;
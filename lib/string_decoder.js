@@ -116,6 +116,17 @@ StringDecoder.prototype.write = function(buffer) {
     break;
   }
 
+  // Nothing needs to be held back from a buffer that ends in ASCII, which is
+  // what most text looks like. A three or four byte lead right before it is
+  // malformed but still left to detectIncompleteChar().
+  var last = buffer.length - 1;
+  if (this.encoding === 'utf8' &&
+      buffer[last] < 0x80 &&
+      !(buffer[last - 1] >= 0xe0) &&
+      !(buffer[last - 2] >= 0xf0)) {
+    return charStr + buffer.toString('utf8');
+  }
+
   // determine and set charLength / charReceived
   this.detectIncompleteChar(buffer);
 
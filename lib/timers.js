@@ -20,11 +20,15 @@
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 var Timer = process.binding('timer_wrap').Timer;
+var timerInfo = process.binding('timer_wrap').timerInfo;
 var L = require('_linklist');
 var assert = require('assert').ok;
 
 var kOnTimeout = Timer.kOnTimeout | 0;
 
+// *Must* match Environment::TimerInfo::Fields in src/env.h.
+var kLoopTime = 0;
+
 // Timeout values > TIMEOUT_MAX are set to 1.
 var TIMEOUT_MAX = 2147483647; // 2^31-1
 
@@ -463,8 +467,97 @@ exports.clearImmediate = function(immediate) {
 
 // Internal APIs that need timeouts should use timers._unrefActive instead of
 // timers.active as internal timeouts shouldn't hold the loop open
+//
+// These are mostly socket idle timeouts: lots of them, mostly long, and
+// refreshed on every read and write while they hardly ever fire. They live
+// in a hierarchical timing wheel driven by a single unref'd timer:
+//
+//  - Level n has kWheelSlots slots, each kWheelScale^n ms wide. A timeout
+//    goes into the finest level that can hold it without wrapping and is
+//    rounded up to the slot boundary. It never moves down a level, so it
+//    fires at most 1/kWheelScale of its duration late and never early.
+//
+//  - Refreshing an armed timeout only updates item._idleStart. When its
+//    slot comes up, an item that was refreshed in the meantime is put back
+//    into the wheel for the remaining time instead of firing.
+
+var kWheelSlots = 64;
+var kWheelScale = 8;
+var kWheelLevels = 10;  // kWheelScale^9 * (kWheelSlots - 1) > TIMEOUT_MAX
+
+var wheel, wheelPending, wheelTimer, wheelTime;
+
+
+function initWheel(now) {
+  debug('unref wheel initialized');
+  wheel = new Array(kWheelLevels);
+  for (var level = 0; level < kWheelLevels; level++) {
+    wheel[level] = new Array(kWheelSlots);
+    for (var i = 0; i < kWheelSlots; i++) {
+      wheel[level][i] = {};
+      L.init(wheel[level][i]);
+    }
+  }
+
+  wheelPending = {};
+  L.init(wheelPending);
+
+  wheelTime = now;
+  wheelTimer = new Timer();
+  wheelTimer.unref();
+  wheelTimer.when = -1;
+  wheelTimer[kOnTimeout] = unrefTimeout;
+}
+
 
-var unrefList, unrefTimer;
+function wheelInsert(item, when, now) {
+  // Nothing is due before wheelTimer.when, so the wheel can catch up to now
+  // for free, which keeps short timeouts in the fine levels.
+  if (now > wheelTime && (wheelTimer.when === -1 || now < wheelTimer.when))
+    wheelTime = now;
+
+  var delta = when - wheelTime;
+  if (delta < 1) {
+    when = wheelTime + 1;
+    delta = 1;
+  }
+
+  var level = 0;
+  var width = 1;
+  while (delta >= width * (kWheelSlots - 1) && level < kWheelLevels - 1) {
+    level++;
+    width *= kWheelScale;
+  }
+
+  var slot = Math.ceil(when / width);
+  L.append(wheel[level][slot % kWheelSlots], item);
+
+  when = slot * width;
+  if (wheelTimer.when === -1 || when < wheelTimer.when) {
+    debug('unrefTimer scheduled in %d', when - now);
+    wheelTimer.start(Math.max(when - now, 0), 0);
+    wheelTimer.when = when;
+  }
+}
+
+
+// The time of the first non-empty slot, or -1 if the wheel is empty.
+function wheelNext() {
+  var next = -1;
+  var width = 1;
+  for (var level = 0; level < kWheelLevels; level++, width *= kWheelScale) {
+    var slot = Math.floor(wheelTime / width) + 1;
+    for (var i = 0; i < kWheelSlots; i++, slot++) {
+      if (next !== -1 && slot * width >= next)
+        break;
+      if (!L.isEmpty(wheel[level][slot % kWheelSlots])) {
+        next = slot * width;
+        break;
+      }
+    }
+  }
+  return next;
+}
 
 
 function unrefTimeout() {
@@ -472,20 +565,32 @@ function unrefTimeout() {
 
   debug('unrefTimer fired');
 
-  var diff, domain, first, hasQueue, threw;
-  while (first = L.peek(unrefList)) {
-    diff = now - first._idleStart;
-
-    if (diff < first._idleTimeout) {
-      diff = first._idleTimeout - diff;
-      unrefTimer.start(diff, 0);
-      unrefTimer.when = now + diff;
-      debug('unrefTimer rescheudling for later');
-      return;
+  // Collect everything in the slots that came up since the last time.
+  var width = 1;
+  for (var level = 0; level < kWheelLevels; level++, width *= kWheelScale) {
+    var from = Math.floor(wheelTime / width) + 1;
+    var to = Math.min(Math.floor(now / width), from + kWheelSlots - 1);
+    for (var slot = from; slot <= to; slot++) {
+      var list = wheel[level][slot % kWheelSlots];
+      var item;
+      while (item = L.peek(list))
+        L.append(wheelPending, item);
     }
+  }
+  if (now > wheelTime)
+    wheelTime = now;
 
+  var domain, first, hasQueue, threw, when;
+  while (first = L.peek(wheelPending)) {
     L.remove(first);
 
+    when = first._idleStart + first._idleTimeout;
+    if (when > now) {
+      // Refreshed since it went into the wheel.
+      wheelInsert(first, when, now);
+      continue;
+    }
+
     domain = first.domain;
 
     if (!first._onTimeout) continue;
@@ -509,8 +614,16 @@ function unrefTimeout() {
     }
   }
 
-  debug('unrefList is empty');
-  unrefTimer.when = -1;
+  when = wheelNext();
+  if (when === -1) {
+    debug('unref wheel is empty');
+    wheelTimer.when = -1;
+    return;
+  }
+
+  debug('unrefTimer rescheduling for later');
+  wheelTimer.start(Math.max(when - now, 0), 0);
+  wheelTimer.when = when;
 }
 
 
@@ -519,57 +632,19 @@ exports._unrefActive = function(item) {
   if (!msecs || msecs < 0) return;
   assert(msecs >= 0);
 
-  L.remove(item);
-
-  if (!unrefList) {
-    debug('unrefList initialized');
-    unrefList = {};
-    L.init(unrefList);
-
-    debug('unrefTimer initialized');
-    unrefTimer = new Timer();
-    unrefTimer.unref();
-    unrefTimer.when = -1;
-    unrefTimer[kOnTimeout] = unrefTimeout;
-  }
-
-  var now = Timer.now();
+  // The time the loop last looked at the clock. It's a bit behind if this
+  // callback has been running for a while, which is fine for an idle
+  // timeout and a lot cheaper than Timer.now().
+  var now = timerInfo[kLoopTime];
   item._idleStart = now;
 
-  if (L.isEmpty(unrefList)) {
-    debug('unrefList empty');
-    L.append(unrefList, item);
-
-    unrefTimer.start(msecs, 0);
-    unrefTimer.when = now + msecs;
-    debug('unrefTimer scheduled');
+  // Already in the wheel (or about to fire), it'll pick up the new start
+  // time when its slot comes up.
+  if (item._idleNext && item._idleNext !== item)
     return;
-  }
-
-  var when = now + msecs;
-
-  debug('unrefList find where we can insert');
-
-  var cur, them;
-
-  for (cur = unrefList._idlePrev; cur != unrefList; cur = cur._idlePrev) {
-    them = cur._idleStart + cur._idleTimeout;
 
-    if (when < them) {
-      debug('unrefList inserting into middle of list');
-
-      L.append(cur, item);
-
-      if (unrefTimer.when > when) {
-        debug('unrefTimer is scheduled to fire too late, reschedule');
-        unrefTimer.start(msecs, 0);
-        unrefTimer.when = when;
-      }
-
-      return;
-    }
-  }
+  if (!wheel)
+    initWheel(now);
 
-  debug('unrefList append to end');
-  L.append(unrefList, item);
+  wheelInsert(item, now + msecs, now);
 };
@@ -315,6 +315,17 @@ function Zlib(opts, mode) {
     }
   }
 
+  // The output ring is what a single threadpool work item may fill, a ring
+  // larger than chunkSize lets one work item process a whole input chunk
+  // where it would otherwise take a round trip per chunkSize of output.
+  this._ringSize = opts.ringSize || this._chunkSize;
+  if (opts.ringSize) {
+    if (opts.ringSize < this._chunkSize ||
+        opts.ringSize > exports.Z_MAX_CHUNK) {
+      throw new Error('Invalid ring size: ' + opts.ringSize);
+    }
+  }
+
   if (opts.windowBits) {
     if (opts.windowBits < exports.Z_MIN_WINDOWBITS ||
         opts.windowBits > exports.Z_MAX_WINDOWBITS) {
@@ -380,7 +391,7 @@ function Zlib(opts, mode) {
                     strategy,
                     opts.dictionary);
 
-  this._buffer = new Buffer(this._chunkSize);
+  this._buffer = new Buffer(this._ringSize);
   this._offset = 0;
   this._closed = false;
   this._level = level;
@@ -505,7 +516,7 @@ Zlib.prototype._transform = function(chunk, encoding, cb) {
 
 Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
   var availInBefore = chunk && chunk.length;
-  var availOutBefore = this._chunkSize - this._offset;
+  var availOutBefore = this._ringSize - this._offset;
   var inOff = 0;
 
   var self = this;
@@ -561,10 +572,12 @@ Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
     var have = availOutBefore - availOutAfter;
     assert(have >= 0, 'have should not go down');
 
-    if (have > 0) {
-      var out = self._buffer.slice(self._offset, self._offset + have);
-      self._offset += have;
-      // serve some output to the consumer.
+    // serve some output to the consumer, at most chunkSize bytes at a time.
+    while (have > 0) {
+      var size = Math.min(have, self._chunkSize);
+      var out = self._buffer.slice(self._offset, self._offset + size);
+      self._offset += size;
+      have -= size;
       if (async) {
         self.push(out);
       } else {
@@ -573,11 +586,11 @@ Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
       }
     }
 
-    // exhausted the output buffer, or used all the input create a new one.
-    if (availOutAfter === 0 || self._offset >= self._chunkSize) {
-      availOutBefore = self._chunkSize;
+    // exhausted the output ring, or used all the input create a new one.
+    if (availOutAfter === 0 || self._offset >= self._ringSize) {
+      availOutBefore = self._ringSize;
       self._offset = 0;
-      self._buffer = new Buffer(self._chunkSize);
+      self._buffer = new Buffer(self._ringSize);
     }
 
     if (availOutAfter === 0) {
@@ -597,7 +610,7 @@ Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
                                       availInBefore,
                                       self._buffer,
                                       self._offset,
-                                      self._chunkSize);
+                                      self._ringSize);
       newReq.callback = callback; // this same function
       newReq.buffer = chunk;
       return;
@@ -96,6 +96,9 @@
         'src/node_contextify.cc',
         'src/node_file.cc',
         'src/node_http_parser.cc',
+        'src/node_io_counters.cc',
+        'src/node_ipc.cc',
+        'src/node_loop_timing.cc',
         'src/node_javascript.cc',
         'src/node_main.cc',
         'src/node_os.cc',
@@ -105,9 +108,11 @@
         'src/node_zlib.cc',
         'src/pipe_wrap.cc',
         'src/signal_wrap.cc',
+        'src/slab_allocator.cc',
         'src/smalloc.cc',
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
+        'src/string_bytes_simd.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
         'src/timer_wrap.cc',
@@ -129,6 +134,7 @@
         'src/node_file.h',
         'src/node_http_parser.h',
         'src/node_internals.h',
+        'src/node_io_counters.h',
         'src/node_javascript.h',
         'src/node_root_certs.h',
         'src/node_version.h',
@@ -136,12 +142,14 @@
         'src/node_wrap.h',
         'src/pipe_wrap.h',
         'src/queue.h',
+        'src/slab_allocator.h',
         'src/smalloc.h',
         'src/tty_wrap.h',
         'src/tcp_wrap.h',
         'src/udp_wrap.h',
         'src/req_wrap.h',
         'src/string_bytes.h',
+        'src/string_bytes_simd.h',
         'src/stream_wrap.h',
         'src/tree.h',
         'src/util.h',
@@ -170,9 +178,11 @@
             'src/node_crypto.cc',
             'src/node_crypto_bio.cc',
             'src/node_crypto_clienthello.cc',
+            'src/node_crypto_session_cache.cc',
             'src/node_crypto.h',
             'src/node_crypto_bio.h',
             'src/node_crypto_clienthello.h',
+            'src/node_crypto_session_cache.h',
             'src/tls_wrap.cc',
             'src/tls_wrap.h'
           ],
@@ -81,6 +81,8 @@ inline v8::Handle<v8::Value> AsyncWrap::MakeDomainCallback(
   v8::Local<v8::Value> domain_v = context->Get(env()->domain_string());
   v8::Local<v8::Object> domain;
 
+  env()->timer_info()->set_loop_time(env()->event_loop());
+
   v8::TryCatch try_catch;
   try_catch.SetVerbose(true);
 
@@ -170,6 +172,8 @@ inline v8::Handle<v8::Value> AsyncWrap::MakeCallback(
   v8::Local<v8::Object> context = object();
   v8::Local<v8::Object> process = env()->process_object();
 
+  env()->timer_info()->set_loop_time(env()->event_loop());
+
   v8::TryCatch try_catch;
   try_catch.SetVerbose(true);
 
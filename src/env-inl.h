@@ -188,6 +188,23 @@ inline void Environment::TickInfo::set_last_threw(bool value) {
   last_threw_ = value;
 }
 
+inline Environment::TimerInfo::TimerInfo() {
+  for (int i = 0; i < kFieldsCount; ++i)
+    fields_[i] = 0;
+}
+
+inline double* Environment::TimerInfo::fields() {
+  return fields_;
+}
+
+inline int Environment::TimerInfo::fields_count() const {
+  return kFieldsCount;
+}
+
+inline void Environment::TimerInfo::set_loop_time(uv_loop_t* loop) {
+  fields_[kLoopTime] = static_cast<double>(uv_now(loop));
+}
+
 inline Environment* Environment::New(v8::Local<v8::Context> context) {
   Environment* env = new Environment(context);
   env->AssignToContext(context);
@@ -210,6 +227,7 @@ inline Environment* Environment::GetCurrent(v8::Local<v8::Context> context) {
 inline Environment::Environment(v8::Local<v8::Context> context)
     : isolate_(context->GetIsolate()),
       isolate_data_(IsolateData::GetOrCreate(context->GetIsolate())),
+      write_slab_allocator_(kWriteSlabSize),
       using_smalloc_alloc_cb_(false),
       using_domains_(false),
       printed_error_(false),
@@ -303,6 +321,18 @@ inline Environment::TickInfo* Environment::tick_info() {
   return &tick_info_;
 }
 
+inline Environment::TimerInfo* Environment::timer_info() {
+  return &timer_info_;
+}
+
+inline SlabAllocator* Environment::read_slab_allocator() {
+  return &read_slab_allocator_;
+}
+
+inline SlabAllocator* Environment::write_slab_allocator() {
+  return &write_slab_allocator_;
+}
+
 inline bool Environment::using_smalloc_alloc_cb() const {
   return using_smalloc_alloc_cb_;
 }
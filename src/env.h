@@ -28,6 +28,7 @@
 #include "uv.h"
 #include "v8.h"
 #include "queue.h"
+#include "slab_allocator.h"
 
 #include <stdint.h>
 
@@ -75,18 +76,22 @@ namespace node {
   V(byte_length_string, "byteLength")                                         \
   V(callback_string, "callback")                                              \
   V(change_string, "change")                                                  \
+  V(chunks_string, "chunks")                                                  \
   V(close_string, "close")                                                    \
   V(code_string, "code")                                                      \
   V(compare_string, "compare")                                                \
+  V(cpu_string, "cpu")                                                        \
   V(ctime_string, "ctime")                                                    \
   V(cwd_string, "cwd")                                                        \
   V(debug_port_string, "debugPort")                                           \
   V(debug_string, "debug")                                                    \
   V(detached_string, "detached")                                              \
   V(dev_string, "dev")                                                        \
+  V(dispatched_string, "dispatched")                                          \
   V(disposed_string, "_disposed")                                             \
   V(domain_string, "domain")                                                  \
   V(exchange_string, "exchange")                                              \
+  V(fast_io_string, "fast_io")                                                \
   V(idle_string, "idle")                                                      \
   V(irq_string, "irq")                                                        \
   V(enter_string, "enter")                                                    \
@@ -120,6 +125,7 @@ namespace node {
   V(hostmaster_string, "hostmaster")                                          \
   V(ignore_string, "ignore")                                                  \
   V(immediate_callback_string, "_immediateCallback")                          \
+  V(index_of_string, "indexOf")                                               \
   V(infoaccess_string, "infoAccess")                                          \
   V(inherit_string, "inherit")                                                \
   V(ino_string, "ino")                                                        \
@@ -134,6 +140,7 @@ namespace node {
   V(mac_string, "mac")                                                        \
   V(mark_sweep_compact_string, "mark-sweep-compact")                          \
   V(max_buffer_string, "maxBuffer")                                           \
+  V(max_wait_time_string, "max_wait_time")                                    \
   V(message_string, "message")                                                \
   V(method_string, "method")                                                  \
   V(minttl_string, "minttl")                                                  \
@@ -159,6 +166,7 @@ namespace node {
   V(onhandshakedone_string, "onhandshakedone")                                \
   V(onhandshakestart_string, "onhandshakestart")                              \
   V(onmessage_string, "onmessage")                                            \
+  V(onmessages_string, "onmessages")                                          \
   V(onnewsession_string, "onnewsession")                                      \
   V(onnewsessiondone_string, "onnewsessiondone")                              \
   V(onocspresponse_string, "onocspresponse")                                  \
@@ -179,6 +187,7 @@ namespace node {
   V(priority_string, "priority")                                              \
   V(processed_string, "processed")                                            \
   V(prototype_string, "prototype")                                            \
+  V(queued_string, "queued")                                                  \
   V(raw_string, "raw")                                                        \
   V(rdev_string, "rdev")                                                      \
   V(readable_string, "readable")                                              \
@@ -200,6 +209,10 @@ namespace node {
   V(should_keep_alive_string, "shouldKeepAlive")                              \
   V(signal_string, "signal")                                                  \
   V(size_string, "size")                                                      \
+  V(slab_bytes_string, "slab_bytes")                                          \
+  V(slab_size_string, "slab_size")                                            \
+  V(slabs_string, "slabs")                                                    \
+  V(slow_io_string, "slow_io")                                                \
   V(smalloc_p_string, "_smalloc_p")                                           \
   V(sni_context_err_string, "Invalid SNI context")                            \
   V(sni_context_string, "sni_context")                                        \
@@ -213,6 +226,7 @@ namespace node {
   V(subjectaltname_string, "subjectaltname")                                  \
   V(sys_string, "sys")                                                        \
   V(syscall_string, "syscall")                                                \
+  V(threads_string, "threads")                                                \
   V(tick_callback_string, "_tickCallback")                                    \
   V(tick_domain_cb_string, "_tickDomainCallback")                             \
   V(timeout_string, "timeout")                                                \
@@ -224,14 +238,18 @@ namespace node {
   V(tls_sni_string, "tls_sni")                                                \
   V(tls_string, "tls")                                                        \
   V(tls_ticket_string, "tlsTicket")                                           \
+  V(to_json_string, "toJSON")                                                 \
+  V(total_chunks_string, "total_chunks")                                      \
   V(total_heap_size_executable_string, "total_heap_size_executable")          \
   V(total_heap_size_string, "total_heap_size")                                \
   V(total_physical_size_string, "total_physical_size")                        \
+  V(total_slabs_string, "total_slabs")                                        \
   V(type_string, "type")                                                      \
   V(uid_string, "uid")                                                        \
   V(unknown_string, "<unknown>")                                              \
   V(upgrade_string, "upgrade")                                                \
   V(url_string, "url")                                                        \
+  V(used_bytes_string, "used_bytes")                                          \
   V(used_heap_size_string, "used_heap_size")                                  \
   V(user_string, "user")                                                      \
   V(uv_string, "uv")                                                          \
@@ -241,6 +259,7 @@ namespace node {
   V(version_major_string, "versionMajor")                                     \
   V(version_minor_string, "versionMinor")                                     \
   V(version_string, "version")                                                \
+  V(wait_time_string, "wait_time")                                            \
   V(weight_string, "weight")                                                  \
   V(windows_verbatim_arguments_string, "windowsVerbatimArguments")            \
   V(wrap_string, "wrap")                                                      \
@@ -357,6 +376,28 @@ class Environment {
     DISALLOW_COPY_AND_ASSIGN(TickInfo);
   };
 
+  // The loop's notion of the current time, uv_now(), for lib/timers.js to
+  // read without calling into C++. Updated whenever the loop calls into JS.
+  class TimerInfo {
+   public:
+    inline double* fields();
+    inline int fields_count() const;
+    inline void set_loop_time(uv_loop_t* loop);
+
+   private:
+    friend class Environment;  // So we can call the constructor.
+    inline TimerInfo();
+
+    enum Fields {
+      kLoopTime,
+      kFieldsCount
+    };
+
+    double fields_[kFieldsCount];
+
+    DISALLOW_COPY_AND_ASSIGN(TimerInfo);
+  };
+
   static inline Environment* GetCurrent(v8::Isolate* isolate);
   static inline Environment* GetCurrent(v8::Local<v8::Context> context);
 
@@ -389,6 +430,7 @@ class Environment {
   inline AsyncListener* async_listener();
   inline DomainFlag* domain_flag();
   inline TickInfo* tick_info();
+  inline TimerInfo* timer_info();
 
   static inline Environment* from_cares_timer_handle(uv_timer_t* handle);
   inline uv_timer_t* cares_timer_handle();
@@ -396,6 +438,9 @@ class Environment {
   inline ares_channel* cares_channel_ptr();
   inline ares_task_list* cares_task_list();
 
+  inline SlabAllocator* read_slab_allocator();
+  inline SlabAllocator* write_slab_allocator();
+
   inline bool using_smalloc_alloc_cb() const;
   inline void set_using_smalloc_alloc_cb(bool value);
 
@@ -437,6 +482,9 @@ class Environment {
 
  private:
   static const int kIsolateSlot = NODE_ISOLATE_SLOT;
+  // Write slabs hold string data until the kernel takes it, keep them small
+  // so a slow peer pins less memory.
+  static const size_t kWriteSlabSize = 64 * 1024;
 
   class GCInfo;
   class IsolateData;
@@ -459,9 +507,12 @@ class Environment {
   AsyncListener async_listener_count_;
   DomainFlag domain_flag_;
   TickInfo tick_info_;
+  TimerInfo timer_info_;
   uv_timer_t cares_timer_handle_;
   ares_channel cares_channel_;
   ares_task_list cares_task_list_;
+  SlabAllocator read_slab_allocator_;
+  SlabAllocator write_slab_allocator_;
   bool using_smalloc_alloc_cb_;
   bool using_domains_;
   QUEUE gc_tracker_queue_;
@@ -24,6 +24,7 @@
 #include "node_constants.h"
 #include "node_file.h"
 #include "node_http_parser.h"
+#include "node_io_counters.h"
 #include "node_javascript.h"
 #include "node_version.h"
 
@@ -1002,6 +1003,8 @@ Handle<Value> MakeDomainCallback(Environment* env,
   Local<Object> object, domain;
   Local<Value> domain_v;
 
+  env->timer_info()->set_loop_time(env->event_loop());
+
   TryCatch try_catch;
   try_catch.SetVerbose(true);
 
@@ -1107,6 +1110,8 @@ Handle<Value> MakeCallback(Environment* env,
 
   Local<Object> process = env->process_object();
 
+  env->timer_info()->set_loop_time(env->event_loop());
+
   TryCatch try_catch;
   try_catch.SetVerbose(true);
 
@@ -2846,6 +2851,11 @@ void Load(Environment* env) {
   // The node.js file returns a function 'f'
   atexit(AtExit);
 
+  // The loop time is from when the loop was created, the main script
+  // shouldn't start its timeouts from there.
+  uv_update_time(env->event_loop());
+  env->timer_info()->set_loop_time(env->event_loop());
+
   TryCatch try_catch;
 
   // Disable verbose mode to stop FatalException() handler from trying
@@ -2956,7 +2966,13 @@ static void PrintHelp() {
          "                       prefixed to the module search path.\n"
          "NODE_MODULE_CONTEXTS   Set to 1 to load modules in their own\n"
          "                       global contexts.\n"
+         "NODE_MODULE_RESOLVE_CACHE\n"
+         "                       File to cache module resolutions in\n"
+         "                       across runs.\n"
          "NODE_DISABLE_COLORS    Set to 1 to disable colors in the REPL\n"
+         "NODE_IO_COUNTERS_FILE  File to keep the I/O counters in, %%p is\n"
+         "                       replaced with the pid, which is appended\n"
+         "                       to the name if there is no %%p.\n"
          "\n"
          "Documentation can be found at http://nodejs.org/\n");
 }
@@ -3606,6 +3622,18 @@ int Start(int argc, char** argv) {
   const char** exec_argv;
   Init(&argc, const_cast<const char**>(argv), &exec_argc, &exec_argv);
 
+  // Done before anything runs so no I/O goes uncounted in the file.
+  const char* io_counters_file = getenv("NODE_IO_COUNTERS_FILE");
+  if (io_counters_file != NULL && io_counters_file[0] != '\0') {
+    int err = io_counters::MapFile(io_counters_file);
+    if (err != 0) {
+      fprintf(stderr,
+              "node: cannot map NODE_IO_COUNTERS_FILE %s: %s\n",
+              io_counters_file,
+              uv_strerror(err));
+    }
+  }
+
 #if HAVE_OPENSSL
   // V8 on Windows doesn't have a good source of entropy. Seed it from
   // OpenSSL's pool.
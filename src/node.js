@@ -55,6 +55,7 @@
     startup.processStdio();
     startup.processKillAndExit();
     startup.processSignalHandlers();
+    startup.processIoCounters();
 
     startup.processChannel();
 
@@ -628,6 +629,22 @@
     };
   };
 
+  startup.processIoCounters = function() {
+    var binding;
+
+    process.ioCounters = function() {
+      if (!binding)
+        binding = process.binding('io_counters');
+
+      var names = binding.names;
+      var counters = binding.counters;
+      var result = {};
+      for (var i = 0; i < names.length; i++)
+        result[names[i]] = counters[i];
+      return result;
+    };
+  };
+
   startup.processSignalHandlers = function() {
     // Load events module in order to access prototype elements on process like
     // process.addListener.
@@ -688,8 +705,11 @@
       var fd = parseInt(process.env.NODE_CHANNEL_FD, 10);
       assert(fd >= 0);
 
+      var serialization = process.env.NODE_CHANNEL_SERIALIZATION;
+
       // Make sure it's not accidentally inherited by child processes.
       delete process.env.NODE_CHANNEL_FD;
+      delete process.env.NODE_CHANNEL_SERIALIZATION;
 
       var cp = NativeModule.require('child_process');
 
@@ -698,7 +718,7 @@
       // FIXME is this really necessary?
       process.binding('tcp_wrap');
 
-      cp._forkChild(fd);
+      cp._forkChild(fd, serialization);
       assert(process.send);
     }
   };
@@ -27,6 +27,7 @@
 #include "env-inl.h"
 #include "smalloc.h"
 #include "string_bytes.h"
+#include "string_bytes_simd.h"
 #include "v8-profiler.h"
 #include "v8.h"
 
@@ -620,6 +621,156 @@ void Compare(const FunctionCallbackInfo<Value> &args) {
 }
 
 
+// Horspool's skip table only pays for itself when there's a fair way to go.
+static const size_t kHorspoolMinDistance = 256;
+
+
+static int64_t IndexOfForward(const char* haystack,
+                              size_t hlen,
+                              const char* needle,
+                              size_t nlen,
+                              size_t offset) {
+  if (nlen == 0)
+    return offset;
+  if (nlen > hlen || offset > hlen - nlen)
+    return -1;
+
+  if (nlen == 1) {
+    const void* p = memchr(haystack + offset, needle[0], hlen - offset);
+    return p == NULL ? -1 : static_cast<const char*>(p) - haystack;
+  }
+
+  const size_t end = hlen - nlen;
+  size_t i = offset +
+      simd::Find(haystack + offset, hlen - offset, needle, nlen);
+  if (i <= end && memcmp(haystack + i, needle, nlen) == 0)
+    return i;
+
+  if (i <= end && end - i >= kHorspoolMinDistance) {
+    const unsigned char* h = reinterpret_cast<const unsigned char*>(haystack);
+    const unsigned char* n = reinterpret_cast<const unsigned char*>(needle);
+    const unsigned char last = n[nlen - 1];
+    size_t skip[256];
+    for (size_t k = 0; k < 256; k++)
+      skip[k] = nlen;
+    for (size_t k = 0; k < nlen - 1; k++)
+      skip[n[k]] = nlen - 1 - k;
+    while (i <= end) {
+      const unsigned char c = h[i + nlen - 1];
+      if (c == last && memcmp(h + i, n, nlen - 1) == 0)
+        return i;
+      i += skip[c];
+    }
+    return -1;
+  }
+
+  while (i <= end) {
+    const void* p = memchr(haystack + i, needle[0], end - i + 1);
+    if (p == NULL)
+      return -1;
+    i = static_cast<const char*>(p) - haystack;
+    if (memcmp(haystack + i + 1, needle + 1, nlen - 1) == 0)
+      return i;
+    i += 1;
+  }
+  return -1;
+}
+
+
+// Matches start at offset at the latest.
+static int64_t IndexOfBackward(const char* haystack,
+                               size_t hlen,
+                               const char* needle,
+                               size_t nlen,
+                               size_t offset) {
+  if (nlen > hlen)
+    return -1;
+  size_t i = MIN(offset, hlen - nlen);
+  if (nlen == 0)
+    return i;
+
+  const unsigned char* h = reinterpret_cast<const unsigned char*>(haystack);
+  const unsigned char* n = reinterpret_cast<const unsigned char*>(needle);
+  const unsigned char first = n[0];
+
+  if (nlen > 1 && i >= kHorspoolMinDistance) {
+    // Horspool again, with the table for the needle read back to front.
+    size_t skip[256];
+    for (size_t k = 0; k < 256; k++)
+      skip[k] = nlen;
+    for (size_t k = nlen - 1; k > 0; k--)
+      skip[n[k]] = k;
+    for (;;) {
+      const unsigned char c = h[i];
+      if (c == first && memcmp(h + i + 1, n + 1, nlen - 1) == 0)
+        return i;
+      if (i < skip[c])
+        return -1;
+      i -= skip[c];
+    }
+  }
+
+  for (;;) {
+    if (h[i] == first && memcmp(h + i + 1, n + 1, nlen - 1) == 0)
+      return i;
+    if (i == 0)
+      return -1;
+    i -= 1;
+  }
+}
+
+
+// indexOf(buffer, value, byteOffset, encoding, forward)
+// lib/buffer.js has checked the value and clamped byteOffset to the buffer.
+void IndexOf(const FunctionCallbackInfo<Value>& args) {
+  ARGS_THIS(args[0].As<Object>())
+  const int64_t offset = args[2]->IntegerValue();
+  const bool forward = args[4]->IsTrue();
+  assert(offset >= 0 && static_cast<uint64_t>(offset) <= obj_length);
+
+  const char* needle;
+  size_t nlen;
+  char byte;
+  char stack_storage[1024];
+  char* heap_storage = NULL;
+
+  if (args[1]->IsNumber()) {
+    byte = static_cast<char>(args[1]->Uint32Value() & 255);
+    needle = &byte;
+    nlen = 1;
+  } else if (HasInstance(args[1])) {
+    needle = Data(args[1]);
+    nlen = Length(args[1]);
+  } else {
+    Environment* env = Environment::GetCurrent(args.GetIsolate());
+    HandleScope scope(env->isolate());
+    Local<String> str = args[1]->ToString();
+    enum encoding enc = ParseEncoding(env->isolate(), args[3], UTF8);
+    size_t storage = StringBytes::StorageSize(env->isolate(), str, enc);
+    char* data = stack_storage;
+    if (storage > sizeof(stack_storage))
+      data = heap_storage = new char[storage];
+    nlen = StringBytes::Write(env->isolate(),
+                              data,
+                              enc == UCS2 ? storage / 2 : storage,
+                              str,
+                              enc,
+                              NULL);
+    needle = data;
+  }
+
+  int64_t result;
+  if (forward)
+    result = IndexOfForward(obj_data, obj_length, needle, nlen, offset);
+  else
+    result = IndexOfBackward(obj_data, obj_length, needle, nlen, offset);
+
+  delete[] heap_storage;
+  // Buffers are capped at kMaxLength so the offset always fits.
+  args.GetReturnValue().Set(static_cast<int32_t>(result));
+}
+
+
 // pass Buffer object to load prototype methods
 void SetupBufferJS(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
@@ -680,6 +831,11 @@ void SetupBufferJS(const FunctionCallbackInfo<Value>& args) {
                     env->isolate(), Compare)->GetFunction();
   compare->SetName(env->compare_string());
   internal->Set(env->compare_string(), compare);
+
+  Local<Function> index_of = FunctionTemplate::New(
+                    env->isolate(), IndexOf)->GetFunction();
+  index_of->SetName(env->index_of_string());
+  internal->Set(env->index_of_string(), index_of);
 }
 
 
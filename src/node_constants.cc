@@ -1111,6 +1111,7 @@ void DefineSystemConstants(Handle<Object> target) {
 
 void DefineUVConstants(Handle<Object> target) {
   NODE_DEFINE_CONSTANT(target, UV_UDP_REUSEADDR);
+  NODE_DEFINE_CONSTANT(target, UV_UDP_RECVMMSG);
 }
 
 void DefineConstants(Handle<Object> target) {
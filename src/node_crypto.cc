@@ -24,6 +24,7 @@
 #include "node_crypto.h"
 #include "node_crypto_bio.h"
 #include "node_crypto_groups.h"
+#include "node_crypto_session_cache.h"
 #include "tls_wrap.h"  // TLSCallbacks
 
 #include "async-wrap.h"
@@ -116,6 +117,9 @@ const char* root_certs[] = {
 
 X509_STORE* root_cert_store;
 
+// SSL_CTX ex_data slot of the shared session cache, see SetSessionCache()
+static int session_cache_index = -1;
+
 // Just to generate static methods
 template class SSLWrap<TLSCallbacks>;
 template void SSLWrap<TLSCallbacks>::AddMethods(Environment* env,
@@ -280,6 +284,9 @@ void SecureContext::Initialize(Environment* env, Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "loadPKCS12", SecureContext::LoadPKCS12);
   NODE_SET_PROTOTYPE_METHOD(t, "getTicketKeys", SecureContext::GetTicketKeys);
   NODE_SET_PROTOTYPE_METHOD(t, "setTicketKeys", SecureContext::SetTicketKeys);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "setSessionCache",
+                            SecureContext::SetSessionCache);
   NODE_SET_PROTOTYPE_METHOD(t,
                             "getCertificate",
                             SecureContext::GetCertificate<true>);
@@ -957,6 +964,46 @@ void SecureContext::SetTicketKeys(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// The cache belongs to the SSL_CTX rather than to the SecureContext: it has
+// to stay around as long as connections created from the context do.
+static void FreeSessionCache(void* parent,
+                             void* ptr,
+                             CRYPTO_EX_DATA* ad,
+                             int idx,
+                             long argl,
+                             void* argp) {
+  delete static_cast<SessionCache*>(ptr);
+}
+
+
+static SessionCache* GetSessionCache(SSL* s) {
+  return static_cast<SessionCache*>(
+      SSL_CTX_get_ex_data(s->session_ctx, session_cache_index));
+}
+
+
+void SecureContext::SetSessionCache(const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(args.GetIsolate());
+  SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
+  Environment* env = wrap->env();
+
+  if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsUint32())
+    return env->ThrowTypeError("Bad argument");
+
+  // Handshakes on the thread pool may be using the current one
+  if (SSL_CTX_get_ex_data(wrap->ctx_, session_cache_index) != NULL)
+    return env->ThrowError("Session cache already set");
+
+  node::Utf8Value path(args[0]);
+  int err;
+  SessionCache* cache = SessionCache::Open(*path, args[1]->Uint32Value(), &err);
+  if (cache == NULL)
+    return env->ThrowUVException(err, "open", NULL, *path);
+
+  SSL_CTX_set_ex_data(wrap->ctx_, session_cache_index, cache);
+}
+
+
 template <bool primary>
 void SecureContext::GetCertificate(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
@@ -1048,6 +1095,17 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
   SSL_SESSION* sess = w->next_sess_;
   w->next_sess_ = NULL;
 
+  // Sessions established by other processes
+  SessionCache* cache = GetSessionCache(s);
+  if (sess == NULL && cache != NULL) {
+    unsigned char serialized[SessionCache::kMaxDataSize];
+    size_t size = cache->Lookup(key, len, serialized, sizeof(serialized));
+    if (size != 0) {
+      const unsigned char* p = serialized;
+      sess = d2i_SSL_SESSION(NULL, &p, size);
+    }
+  }
+
   return sess;
 }
 
@@ -1055,13 +1113,29 @@ SSL_SESSION* SSLWrap<Base>::GetSessionCallback(SSL* s,
 template <class Base>
 int SSLWrap<Base>::NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   Base* w = static_cast<Base*>(SSL_get_app_data(s));
-  Environment* env = w->ssl_env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
+
+  SessionCache* cache = GetSessionCache(s);
+  if (cache != NULL) {
+    unsigned char serialized[SessionCache::kMaxDataSize];
+    int size = i2d_SSL_SESSION(sess, NULL);
+    if (size > 0 && size <= static_cast<int>(sizeof(serialized))) {
+      unsigned char* p = serialized;
+      i2d_SSL_SESSION(sess, &p);
+      cache->Store(sess->session_id,
+                   sess->session_id_length,
+                   serialized,
+                   size,
+                   SSL_SESSION_get_time(sess) + SSL_SESSION_get_timeout(sess));
+    }
+  }
 
   if (!w->session_callbacks_)
     return 0;
 
+  Environment* env = w->ssl_env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
   // Check if session is small enough to be stored
   int size = i2d_SSL_SESSION(sess, NULL);
   if (size > SecureContext::kMaxSessionSize)
@@ -1283,6 +1357,7 @@ void SSLWrap<Base>::GetPeerCertificate(
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   Environment* env = w->ssl_env();
 
   ClearErrorOnReturn clear_error_on_return;
@@ -1391,6 +1466,7 @@ void SSLWrap<Base>::GetSession(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(env->isolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   SSL_SESSION* sess = SSL_get_session(w->ssl_);
   if (sess == NULL)
@@ -1413,6 +1489,7 @@ void SSLWrap<Base>::SetSession(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(env->isolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   if (args.Length() < 1 ||
       (!args[0]->IsString() && !Buffer::HasInstance(args[0]))) {
@@ -1445,6 +1522,7 @@ void SSLWrap<Base>::LoadSession(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   Environment* env = w->ssl_env();
 
   if (args.Length() >= 1 && Buffer::HasInstance(args[0])) {
@@ -1477,6 +1555,7 @@ template <class Base>
 void SSLWrap<Base>::IsSessionReused(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   bool yes = SSL_session_reused(w->ssl_);
   args.GetReturnValue().Set(yes);
 }
@@ -1486,6 +1565,7 @@ template <class Base>
 void SSLWrap<Base>::EndParser(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   w->hello_parser_.End();
 }
 
@@ -1495,6 +1575,7 @@ void SSLWrap<Base>::Renegotiate(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   ClearErrorOnReturn clear_error_on_return;
   (void) &clear_error_on_return;  // Silence unused variable warning.
@@ -1509,6 +1590,7 @@ void SSLWrap<Base>::Shutdown(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   int rv = SSL_shutdown(w->ssl_);
   args.GetReturnValue().Set(rv);
@@ -1520,6 +1602,7 @@ void SSLWrap<Base>::GetTLSTicket(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   Environment* env = w->ssl_env();
 
   SSL_SESSION* sess = SSL_get_session(w->ssl_);
@@ -1539,6 +1622,7 @@ void SSLWrap<Base>::NewSessionDone(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   w->new_session_wait_ = false;
   w->NewSessionDoneCb();
 }
@@ -1551,6 +1635,7 @@ void SSLWrap<Base>::SetOCSPResponse(
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   if (args.Length() < 1 || !Buffer::HasInstance(args[0]))
     return w->env()->ThrowTypeError("Must give a Buffer as first argument");
 
@@ -1566,6 +1651,7 @@ void SSLWrap<Base>::RequestOCSP(
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   SSL_set_tlsext_status_type(w->ssl_, TLSEXT_STATUSTYPE_ocsp);
 #endif  // NODE__HAVE_TLSEXT_STATUS_CB
@@ -1580,6 +1666,7 @@ void SSLWrap<Base>::SetMaxSendFragment(
   CHECK(args.Length() >= 1 && args[0]->IsNumber());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   int rv = SSL_set_max_send_fragment(w->ssl_, args[0]->Int32Value());
   args.GetReturnValue().Set(rv);
@@ -1591,6 +1678,7 @@ template <class Base>
 void SSLWrap<Base>::IsInitFinished(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   bool yes = SSL_is_init_finished(w->ssl_);
   args.GetReturnValue().Set(yes);
 }
@@ -1601,6 +1689,7 @@ void SSLWrap<Base>::VerifyError(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   // XXX(bnoordhuis) The UNABLE_TO_GET_ISSUER_CERT error when there is no
   // peer certificate is questionable but it's compatible with what was
@@ -1666,6 +1755,7 @@ void SSLWrap<Base>::GetCurrentCipher(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
   Environment* env = w->ssl_env();
 
   OPENSSL_CONST SSL_CIPHER* c = SSL_get_current_cipher(w->ssl_);
@@ -1688,19 +1778,18 @@ int SSLWrap<Base>::AdvertiseNextProtoCallback(SSL* s,
                                               const unsigned char** data,
                                               unsigned int* len,
                                               void* arg) {
-  Base* w = static_cast<Base*>(arg);
-  Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
+  // Not `arg`, that is whichever connection last initialized the shared
+  // context. This may also run on the thread pool, so stick to the raw
+  // protocol list and leave the persistent handle alone.
+  Base* w = static_cast<Base*>(SSL_get_app_data(s));
 
-  if (w->npn_protos_.IsEmpty()) {
+  if (w->npn_protos_data_ == NULL) {
     // No initialization - no NPN protocols
     *data = reinterpret_cast<const unsigned char*>("");
     *len = 0;
   } else {
-    Local<Object> obj = PersistentToLocal(env->isolate(), w->npn_protos_);
-    *data = reinterpret_cast<const unsigned char*>(Buffer::Data(obj));
-    *len = Buffer::Length(obj);
+    *data = w->npn_protos_data_;
+    *len = w->npn_protos_length_;
   }
 
   return SSL_TLSEXT_ERR_OK;
@@ -1768,6 +1857,7 @@ void SSLWrap<Base>::GetNegotiatedProto(
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   if (w->is_client()) {
     if (w->selected_npn_proto_.IsEmpty() == false) {
@@ -1794,11 +1884,15 @@ void SSLWrap<Base>::SetNPNProtocols(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(args.GetIsolate());
 
   Base* w = Unwrap<Base>(args.Holder());
+  w->SyncHandshakeWork();
 
   if (args.Length() < 1 || !Buffer::HasInstance(args[0]))
     return w->env()->ThrowTypeError("Must give a Buffer as first argument");
 
   w->npn_protos_.Reset(args.GetIsolate(), args[0].As<Object>());
+  w->npn_protos_data_ =
+      reinterpret_cast<const unsigned char*>(Buffer::Data(args[0]));
+  w->npn_protos_length_ = Buffer::Length(args[0]);
 }
 #endif  // OPENSSL_NPN_NEGOTIATED
 
@@ -1808,9 +1902,10 @@ template <class Base>
 int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
   Base* w = static_cast<Base*>(arg);
   Environment* env = w->env();
-  HandleScope handle_scope(env->isolate());
 
   if (w->is_client()) {
+    HandleScope handle_scope(env->isolate());
+
     // Incoming response
     const unsigned char* resp;
     int len = SSL_get_tlsext_status_ocsp_resp(s, &resp);
@@ -1829,10 +1924,13 @@ int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
     // Somehow, client is expecting different return value here
     return 1;
   } else {
-    // Outgoing response
+    // Outgoing response, `arg` is whichever connection last initialized the
+    // shared context.
+    w = static_cast<Base*>(SSL_get_app_data(s));
     if (w->ocsp_response_.IsEmpty())
       return SSL_TLSEXT_ERR_NOACK;
 
+    HandleScope handle_scope(env->isolate());
     Local<Object> obj = PersistentToLocal(env->isolate(), w->ocsp_response_);
     char* resp = Buffer::Data(obj);
     size_t len = Buffer::Length(obj);
@@ -5030,6 +5128,9 @@ void InitCryptoOnce() {
   CRYPTO_set_locking_callback(crypto_lock_cb);
   CRYPTO_THREADID_set_callback(crypto_threadid_cb);
 
+  session_cache_index =
+      SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, FreeSessionCache);
+
   // Turn off compression. Saves memory and protects against CRIME attacks.
 #if !defined(OPENSSL_NO_COMP)
 #if OPENSSL_VERSION_NUMBER < 0x00908000L
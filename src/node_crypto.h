@@ -105,6 +105,8 @@ class SecureContext : public BaseObject {
   static void LoadPKCS12(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSessionCache(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   template <bool primary>
   static void GetCertificate(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -143,7 +145,8 @@ class SecureContext : public BaseObject {
 };
 
 // SSLWrap implicitly depends on the inheriting class' handle having an
-// internal pointer to the Base class.
+// internal pointer to the Base class. Its JS methods call
+// Base::SyncHandshakeWork() before they touch `ssl_`.
 template <class Base>
 class SSLWrap {
  public:
@@ -158,6 +161,10 @@ class SSLWrap {
         next_sess_(NULL),
         session_callbacks_(false),
         new_session_wait_(false) {
+#ifdef OPENSSL_NPN_NEGOTIATED
+    npn_protos_data_ = NULL;
+    npn_protos_length_ = 0;
+#endif  // OPENSSL_NPN_NEGOTIATED
     ssl_ = SSL_new(sc->ctx_);
     assert(ssl_ != NULL);
   }
@@ -257,6 +264,10 @@ class SSLWrap {
 #ifdef OPENSSL_NPN_NEGOTIATED
   v8::Persistent<v8::Object> npn_protos_;
   v8::Persistent<v8::Value> selected_npn_proto_;
+  // Contents of `npn_protos_`, AdvertiseNextProtoCallback() must not touch
+  // V8 as it may run on a worker thread.
+  const unsigned char* npn_protos_data_;
+  unsigned int npn_protos_length_;
 #endif  // OPENSSL_NPN_NEGOTIATED
 
   friend class SecureContext;
@@ -277,6 +288,8 @@ class Connection : public SSLWrap<Connection>, public AsyncWrap {
 
   static void Initialize(Environment* env, v8::Handle<v8::Object> target);
   void NewSessionDoneCb();
+  // Handshakes always run on the loop thread, nothing to wait for
+  inline void SyncHandshakeWork() {}
 
 #ifdef OPENSSL_NPN_NEGOTIATED
   v8::Persistent<v8::Object> npnProtos_;
@@ -0,0 +1,473 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "node_crypto_session_cache.h"
+#include "node_internals.h"
+#include "uv.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+# include <errno.h>
+# include <fcntl.h>
+# include <sched.h>
+# include <signal.h>
+# include <sys/file.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif  // !_WIN32
+
+namespace node {
+namespace crypto {
+
+// How often a waiter checks whether the owner of a lock is still around
+static const unsigned int kSpinsPerOwnerCheck = 256;
+
+#ifdef _WIN32
+
+static uint32_t CurrentProcess() {
+  return GetCurrentProcessId();
+}
+
+
+static bool ProcessExited(uint32_t pid) {
+  HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, pid);
+  if (process == NULL)
+    return GetLastError() == ERROR_INVALID_PARAMETER;
+  bool exited = WaitForSingleObject(process, 0) == WAIT_OBJECT_0;
+  CloseHandle(process);
+  return exited;
+}
+
+
+static uint32_t CompareAndSwap(volatile uint32_t* ptr,
+                               uint32_t oldval,
+                               uint32_t newval) {
+  return InterlockedCompareExchange(reinterpret_cast<volatile LONG*>(ptr),
+                                    newval,
+                                    oldval);
+}
+
+
+static void Release(volatile uint32_t* ptr) {
+  InterlockedExchange(reinterpret_cast<volatile LONG*>(ptr), 0);
+}
+
+
+static void FullBarrier() {
+  MemoryBarrier();
+}
+
+
+static void YieldThread() {
+  SwitchToThread();
+}
+
+
+static int TranslateError(DWORD error) {
+  switch (error) {
+    case ERROR_ACCESS_DENIED:
+      return UV_EACCES;
+    case ERROR_NOT_ENOUGH_MEMORY:
+    case ERROR_COMMITMENT_LIMIT:
+      return UV_ENOMEM;
+    case ERROR_INVALID_HANDLE:  // The name is taken by another kind of object
+      return UV_EINVAL;
+    default:
+      return UV_EIO;
+  }
+}
+
+
+// The cache lives in a section backed by the paging file and named after
+// `path`, no file is created. The section goes away when the last process
+// that uses it closes it, there is nothing to clean up.
+SessionCache* SessionCache::Open(const char* path, size_t entries, int* err) {
+  uint64_t sets = (entries + kWays - 1) / kWays;
+  if (sets == 0)
+    sets = 1;
+
+  // Object names can't contain backslashes
+  static const WCHAR prefix[] = L"Local\\node-tls-sessions:";
+  const size_t prefix_length = ARRAY_SIZE(prefix) - 1;
+  WCHAR name[MAX_PATH];
+  memcpy(name, prefix, sizeof(prefix));
+  if (MultiByteToWideChar(CP_UTF8,
+                          0,
+                          path,
+                          -1,
+                          name + prefix_length,
+                          ARRAY_SIZE(name) - prefix_length) == 0) {
+    *err = UV_ENAMETOOLONG;
+    return NULL;
+  }
+  for (WCHAR* c = name + prefix_length; *c != L'\0'; c++) {
+    if (*c == L'\\')
+      *c = L'/';
+  }
+
+  uint64_t size = MappingSize(sets);
+  HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE,
+                                      NULL,
+                                      PAGE_READWRITE,
+                                      static_cast<DWORD>(size >> 32),
+                                      static_cast<DWORD>(size),
+                                      name);
+  if (mapping == NULL) {
+    *err = TranslateError(GetLastError());
+    return NULL;
+  }
+
+  void* base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+  if (base == NULL) {
+    *err = TranslateError(GetLastError());
+    CloseHandle(mapping);
+    return NULL;
+  }
+
+  // An existing section keeps its geometry. It may be bigger or smaller than
+  // what we asked for.
+  MEMORY_BASIC_INFORMATION info;
+  if (VirtualQuery(base, &info, sizeof(info)) == 0) {
+    *err = TranslateError(GetLastError());
+    UnmapViewOfFile(base);
+    CloseHandle(mapping);
+    return NULL;
+  }
+
+  Header* h = static_cast<Header*>(base);
+  if (h->magic == kMagic)
+    sets = h->sets;
+
+  if (info.RegionSize < MappingSize(sets) || !InitHeader(h, sets)) {
+    *err = UV_EINVAL;
+    UnmapViewOfFile(base);
+    CloseHandle(mapping);
+    return NULL;
+  }
+
+  // The name only stays around for as long as somebody holds the handle
+  SessionCache* cache = new SessionCache(base, info.RegionSize);
+  cache->mapping_ = mapping;
+  return cache;
+}
+
+
+SessionCache::~SessionCache() {
+  UnmapViewOfFile(base_);
+  CloseHandle(mapping_);
+}
+
+#else  // !_WIN32
+
+static uint32_t CurrentProcess() {
+  return getpid();
+}
+
+
+static bool ProcessExited(uint32_t pid) {
+  return kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+
+static uint32_t CompareAndSwap(volatile uint32_t* ptr,
+                               uint32_t oldval,
+                               uint32_t newval) {
+  return __sync_val_compare_and_swap(ptr, oldval, newval);
+}
+
+
+static void Release(volatile uint32_t* ptr) {
+  __sync_lock_release(ptr);
+}
+
+
+static void FullBarrier() {
+  __sync_synchronize();
+}
+
+
+static void YieldThread() {
+  sched_yield();
+}
+
+
+SessionCache* SessionCache::Open(const char* path, size_t entries, int* err) {
+  uint64_t sets = (entries + kWays - 1) / kWays;
+  if (sets == 0)
+    sets = 1;
+
+  int fd = open(path, O_RDWR | O_CREAT, 0600);
+  if (fd == -1) {
+    *err = -errno;
+    return NULL;
+  }
+
+  // One process at a time sets up the file, or two that start together with
+  // different sizes could each map more than the other left it. The mapping
+  // keeps the lock alive after close(), it has to be released explicitly.
+  int r;
+  do {
+    r = flock(fd, LOCK_EX);
+  } while (r == -1 && errno == EINTR);
+  if (r == -1)
+    goto fail_errno;
+
+  // An existing cache keeps its geometry
+  struct stat s;
+  Header header;
+  header.magic = 0;
+  if (fstat(fd, &s) == -1)
+    goto fail_errno;
+  if (s.st_size >= static_cast<off_t>(sizeof(header))) {
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header))
+      goto fail_errno;
+    if (header.magic == kMagic && header.version == kVersion)
+      sets = header.sets;
+    else if (header.magic != 0)
+      goto fail_inval;
+  }
+
+  size_t size;
+  size = MappingSize(sets);
+  if (header.magic == 0) {
+    // New, or left half made by a process that died before writing the
+    // header. Nobody has mapped it, start from scratch.
+    if (ftruncate(fd, 0) == -1 || ftruncate(fd, size) == -1)
+      goto fail_errno;
+  } else if (s.st_size < static_cast<off_t>(size)) {
+    goto fail_inval;
+  }
+
+  void* base;
+  base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED)
+    goto fail_errno;
+
+  if (!InitHeader(static_cast<Header*>(base), sets)) {
+    munmap(base, size);
+    goto fail_inval;
+  }
+
+  flock(fd, LOCK_UN);
+  close(fd);
+  return new SessionCache(base, size);
+
+ fail_errno:
+  *err = -errno;
+  close(fd);
+  return NULL;
+
+ fail_inval:
+  *err = UV_EINVAL;
+  close(fd);
+  return NULL;
+}
+
+
+SessionCache::~SessionCache() {
+  munmap(base_, size_);
+}
+
+#endif  // _WIN32
+
+
+SessionCache::SessionCache(void* base, size_t size)
+    : base_(base),
+      size_(size),
+      header_(static_cast<Header*>(base)),
+      entries_(reinterpret_cast<Entry*>(static_cast<char*>(base) +
+                                        sizeof(Header))) {
+}
+
+
+size_t SessionCache::MappingSize(uint64_t sets) {
+  return sizeof(Header) + sets * kWays * sizeof(Entry);
+}
+
+
+// The mapping starts out zeroed: all locks released and all entries empty.
+// Whoever maps it first only has to fill in the header.
+bool SessionCache::InitHeader(Header* h, uint64_t sets) {
+  if (h->magic != kMagic) {
+    h->version = kVersion;
+    h->sets = sets;
+    FullBarrier();
+    CompareAndSwap(&h->magic, 0, kMagic);
+  }
+  return h->magic == kMagic && h->version == kVersion && h->sets == sets;
+}
+
+
+SessionCache::Entry* SessionCache::FindSet(const unsigned char* id,
+                                           size_t id_size,
+                                           uint32_t* stripe) {
+  // FNV-1a, session ids are random but may be chosen by the client
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < id_size; i++) {
+    hash ^= id[i];
+    hash *= 16777619u;
+  }
+
+  uint64_t set = hash % header_->sets;
+  *stripe = set % kStripes;
+  return entries_ + set * kWays;
+}
+
+
+// A lock holds the id of the process that owns it. Holders only copy a few
+// kilobytes, so a lock that stays taken for long may belong to a process
+// that died in the middle of it; a waiter that finds the owner gone takes
+// the lock over. Store() writes entries so that one it did not finish reads
+// as an empty slot.
+void SessionCache::Lock(uint32_t stripe) {
+  volatile uint32_t* lock = &header_->locks[stripe];
+  uint32_t self = CurrentProcess();
+
+  for (unsigned int spins = 1; ; spins++) {
+    uint32_t owner = *lock;
+    if (owner == 0) {
+      if (CompareAndSwap(lock, 0, self) == 0)
+        return;
+      continue;
+    }
+
+    if (spins % kSpinsPerOwnerCheck == 0 &&
+        owner != self &&
+        ProcessExited(owner) &&
+        CompareAndSwap(lock, owner, self) == owner) {
+      return;
+    }
+
+    YieldThread();
+  }
+}
+
+
+void SessionCache::Unlock(uint32_t stripe) {
+  Release(&header_->locks[stripe]);
+}
+
+
+void SessionCache::Store(const unsigned char* id,
+                         size_t id_size,
+                         const unsigned char* data,
+                         size_t size,
+                         time_t expires) {
+  if (id_size == 0 || id_size > kMaxIdSize || size > kMaxDataSize)
+    return;
+
+  uint32_t stripe;
+  Entry* set = FindSet(id, id_size, &stripe);
+  uint64_t now = time(NULL);
+
+  Lock(stripe);
+
+  // Same session, then a free or expired slot, then the one expiring first
+  Entry* entry = NULL;
+  bool entry_free = false;
+  for (size_t i = 0; i < kWays; i++) {
+    Entry* e = set + i;
+    if (e->id_size == id_size && memcmp(e->id, id, id_size) == 0) {
+      entry = e;
+      break;
+    }
+    if (entry_free)
+      continue;
+    if (e->id_size == 0 || e->expires <= now) {
+      entry = e;
+      entry_free = true;
+    } else if (entry == NULL || e->expires < entry->expires) {
+      entry = e;
+    }
+  }
+
+  // The id goes in last, see Lock()
+  entry->id_size = 0;
+  FullBarrier();
+  entry->expires = expires;
+  entry->size = size;
+  memcpy(entry->id, id, id_size);
+  memcpy(entry->data, data, size);
+  FullBarrier();
+  entry->id_size = id_size;
+
+  Unlock(stripe);
+}
+
+
+size_t SessionCache::Lookup(const unsigned char* id,
+                            size_t id_size,
+                            unsigned char* out,
+                            size_t out_size) {
+  if (id_size == 0 || id_size > kMaxIdSize)
+    return 0;
+
+  uint32_t stripe;
+  Entry* set = FindSet(id, id_size, &stripe);
+  uint64_t now = time(NULL);
+  size_t size = 0;
+
+  Lock(stripe);
+
+  for (size_t i = 0; i < kWays; i++) {
+    Entry* e = set + i;
+    if (e->id_size != id_size || memcmp(e->id, id, id_size) != 0)
+      continue;
+
+    if (e->expires <= now) {
+      e->id_size = 0;
+    } else if (e->size <= out_size) {
+      size = e->size;
+      memcpy(out, e->data, size);
+    }
+    break;
+  }
+
+  Unlock(stripe);
+
+  return size;
+}
+
+
+void SessionCache::Remove(const unsigned char* id, size_t id_size) {
+  if (id_size == 0 || id_size > kMaxIdSize)
+    return;
+
+  uint32_t stripe;
+  Entry* set = FindSet(id, id_size, &stripe);
+
+  Lock(stripe);
+
+  for (size_t i = 0; i < kWays; i++) {
+    Entry* e = set + i;
+    if (e->id_size == id_size && memcmp(e->id, id, id_size) == 0) {
+      e->id_size = 0;
+      break;
+    }
+  }
+
+  Unlock(stripe);
+}
+
+}  // namespace crypto
+}  // namespace node
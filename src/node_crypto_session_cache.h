@@ -0,0 +1,105 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_NODE_CRYPTO_SESSION_CACHE_H_
+#define SRC_NODE_CRYPTO_SESSION_CACHE_H_
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint32_t, uint64_t
+#include <time.h>  // time_t
+
+namespace node {
+namespace crypto {
+
+// TLS session cache kept in a file mapping, so that every process that opens
+// the same file resumes the sessions the others have established. Entries
+// live in small sets picked by a hash of the session id; each group of sets
+// is guarded by a spin lock in the mapping itself, which makes the cache safe
+// to use from several processes and threads at once. A lock left behind by
+// a process that died is recovered. Expired entries are dropped lazily, a
+// full set evicts the entry that expires first.
+class SessionCache {
+ public:
+  // Bytes available to a serialized session
+  static const size_t kMaxDataSize = 2000;
+  static const size_t kMaxIdSize = 32;
+
+  // Maps `path`, creating it for `entries` sessions if it does not exist.
+  // Returns NULL and sets `*err` to a libuv error code on failure.
+  static SessionCache* Open(const char* path, size_t entries, int* err);
+  ~SessionCache();
+
+  void Store(const unsigned char* id,
+             size_t id_size,
+             const unsigned char* data,
+             size_t size,
+             time_t expires);
+
+  // Copies the session into `out`, returns its size or 0 if there is none
+  size_t Lookup(const unsigned char* id,
+                size_t id_size,
+                unsigned char* out,
+                size_t out_size);
+
+  void Remove(const unsigned char* id, size_t id_size);
+
+ private:
+  static const uint32_t kMagic = 0x6e746c73;  // 'ntls'
+  static const uint32_t kVersion = 2;
+  static const size_t kWays = 4;
+  static const size_t kStripes = 64;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sets;
+    volatile uint32_t locks[kStripes];  // Process id of the owner or 0
+  };
+
+  struct Entry {
+    uint64_t expires;
+    uint32_t id_size;
+    uint32_t size;
+    unsigned char id[kMaxIdSize];
+    unsigned char data[kMaxDataSize];
+  };
+
+  SessionCache(void* base, size_t size);
+
+  static size_t MappingSize(uint64_t sets);
+  static bool InitHeader(Header* h, uint64_t sets);
+  Entry* FindSet(const unsigned char* id, size_t id_size, uint32_t* stripe);
+  void Lock(uint32_t stripe);
+  void Unlock(uint32_t stripe);
+
+  void* const base_;
+  const size_t size_;
+  Header* const header_;
+  Entry* const entries_;
+#ifdef _WIN32
+  void* mapping_;
+#endif  // _WIN32
+};
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // SRC_NODE_CRYPTO_SESSION_CACHE_H_
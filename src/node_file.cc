@@ -23,6 +23,7 @@
 #include "node_file.h"
 #include "node_buffer.h"
 #include "node_internals.h"
+#include "node_io_counters.h"
 #include "node_stat_watcher.h"
 
 #include "env.h"
@@ -41,6 +42,8 @@
 
 #if defined(__MINGW32__) || defined(_MSC_VER)
 # include <io.h>
+#else
+# include <unistd.h>
 #endif
 
 namespace node {
@@ -48,6 +51,7 @@ namespace node {
 using v8::Array;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Exception;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -114,10 +118,42 @@ static inline bool IsInt64(double x) {
 }
 
 
+// sendfile(2) reads the file and writes the socket in one go, the bytes count
+// on both sides. uv_fs_sendfile() keeps the destination in req->file.
+static void CountSendfile(const uv_fs_t* req) {
+  io_counters::Count(io_counters::kFsBytesRead, req->result);
+  switch (uv_guess_handle(req->file)) {
+    case UV_TCP:
+      io_counters::Count(io_counters::kTcpBytesWritten, req->result);
+      break;
+    case UV_NAMED_PIPE:
+      io_counters::Count(io_counters::kPipeBytesWritten, req->result);
+      break;
+    default:
+      break;
+  }
+}
+
+
+// Every request is an op, whether it succeeded or not.
+static void CountRequest(const uv_fs_t* req) {
+  io_counters::Count(io_counters::kFsOps);
+  if (req->result <= 0)
+    return;
+  if (req->fs_type == UV_FS_READ)
+    io_counters::Count(io_counters::kFsBytesRead, req->result);
+  else if (req->fs_type == UV_FS_WRITE)
+    io_counters::Count(io_counters::kFsBytesWritten, req->result);
+  else if (req->fs_type == UV_FS_SENDFILE)
+    CountSendfile(req);
+}
+
+
 static void After(uv_fs_t *req) {
   FSReqWrap* req_wrap = static_cast<FSReqWrap*>(req->data);
   assert(&req_wrap->req_ == req);
   req_wrap->ReleaseEarly();  // Free memory that's no longer used now.
+  CountRequest(req);
 
   Environment* env = req_wrap->env();
   HandleScope handle_scope(env->isolate());
@@ -205,6 +241,10 @@ static void After(uv_fs_t *req) {
         argv[1] = Integer::New(env->isolate(), req->result);
         break;
 
+      case UV_FS_SENDFILE:
+        argv[1] = Integer::New(env->isolate(), req->result);
+        break;
+
       case UV_FS_READDIR:
         {
           char *namebuf = static_cast<char*>(req->ptr);
@@ -251,6 +291,32 @@ struct fs_req_wrap {
 };
 
 
+// uv_buf_t's for the vectored calls, pointing into an array of buffers.
+// The buffers themselves have to be kept alive by the caller.
+struct fs_bufs_wrap {
+  explicit fs_bufs_wrap(size_t count)
+      : bufs(count > ARRAY_SIZE(bufsml) ? new uv_buf_t[count] : bufsml),
+        count(count) {}
+  ~fs_bufs_wrap() { if (bufs != bufsml) delete[] bufs; }
+  // Returns false if one of the elements is not a buffer.
+  bool Fill(Local<Array> array) {
+    for (size_t i = 0; i < count; i++) {
+      Local<Value> chunk = array->Get(i);
+      if (!Buffer::HasInstance(chunk))
+        return false;
+      bufs[i] = uv_buf_init(Buffer::Data(chunk), Buffer::Length(chunk));
+    }
+    return true;
+  }
+  // Ensure that copy ctor and assignment operator are not used.
+  fs_bufs_wrap(const fs_bufs_wrap& bufs);
+  fs_bufs_wrap& operator=(const fs_bufs_wrap& bufs);
+  uv_buf_t bufsml[16];
+  uv_buf_t* bufs;
+  size_t count;
+};
+
+
 #define ASYNC_DEST_CALL(func, callback, dest_path, ...)                       \
   Environment* env = Environment::GetCurrent(args.GetIsolate());              \
   FSReqWrap* req_wrap;                                                        \
@@ -287,6 +353,7 @@ struct fs_req_wrap {
                          &req_wrap.req,                                       \
                          __VA_ARGS__,                                         \
                          NULL);                                               \
+  CountRequest(&req_wrap.req);                                                \
   if (err < 0) {                                                              \
     if (dest != NULL &&                                                       \
         (err == UV_EEXIST ||                                                  \
@@ -729,6 +796,219 @@ static void ReadDir(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+#ifndef _WIN32
+// Reads a whole file for fs.readFile(): open(), fstat(), read() until done
+// and close() without going back to JS land in between. Read() runs on the
+// thread pool.
+class FileReader {
+ public:
+  FileReader(const char* path, int flags)
+      : path_(strdup(path)),
+        flags_(flags),
+        err_(0),
+        syscall_(NULL),
+        too_large_(false),
+        data_(NULL),
+        size_(0) {
+  }
+
+  ~FileReader() {
+    free(path_);
+    free(data_);
+  }
+
+  void Read() {
+    int fd;
+    int flags = flags_;
+#ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#endif
+    do {
+      fd = open(path_, flags, 0666);
+    } while (fd == -1 && errno == EINTR);
+
+    if (fd == -1)
+      return Fail("open");
+
+    struct stat s;
+    if (fstat(fd, &s) == 0)
+      ReadAll(fd, s.st_size);
+    else
+      Fail("fstat");
+
+    if (close(fd) == -1 && err_ == 0 && !too_large_)
+      Fail("close");
+  }
+
+  // Returns the error or undefined if the file was read.
+  Local<Value> Error(Environment* env) const {
+    if (too_large_) {
+      return Exception::RangeError(FIXED_ONE_BYTE_STRING(env->isolate(),
+          "File size is greater than possible Buffer: 0x3FFFFFFF bytes"));
+    }
+    if (err_ != 0) {
+      const char* path = strcmp(syscall_, "open") == 0 ? path_ : NULL;
+      return UVException(env->isolate(), err_, NULL, syscall_, path);
+    }
+    return Undefined(env->isolate());
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Hands the data over as a Buffer or as a string in `encoding`.
+  Local<Value> Result(Environment* env, enum encoding encoding) {
+    if (encoding != BUFFER)
+      return StringBytes::Encode(env->isolate(), data_, size_, encoding);
+    if (size_ == 0)
+      return Buffer::New(env, 0);
+    Local<Object> buffer = Buffer::Use(env, data_, size_);
+    data_ = NULL;
+    return buffer;
+  }
+
+ private:
+  // A size of 0 means it's unknown, the kernel lies about many files.
+  void ReadAll(int fd, int64_t size) {
+    if (size > static_cast<int64_t>(Buffer::kMaxLength)) {
+      too_large_ = true;
+      return;
+    }
+
+    bool known_size = size > 0;
+    size_t capacity = known_size ? size : 8192;
+    data_ = static_cast<char*>(malloc(capacity));
+    if (data_ == NULL)
+      return Fail("read", ENOMEM);
+
+    for (;;) {
+      if (size_ == capacity) {
+        if (known_size)
+          break;
+        if (capacity >= Buffer::kMaxLength) {
+          too_large_ = true;
+          return;
+        }
+        capacity = MIN(2 * capacity, Buffer::kMaxLength);
+        char* data = static_cast<char*>(realloc(data_, capacity));
+        if (data == NULL)
+          return Fail("read", ENOMEM);
+        data_ = data;
+      }
+
+      ssize_t n;
+      do {
+        n = read(fd, data_ + size_, capacity - size_);
+      } while (n == -1 && errno == EINTR);
+
+      if (n == -1)
+        return Fail("read");
+      if (n == 0)
+        break;
+      size_ += n;
+    }
+  }
+
+  void Fail(const char* syscall, int err = errno) {
+    err_ = -err;
+    syscall_ = syscall;
+  }
+
+  char* path_;
+  int flags_;
+  int err_;
+  const char* syscall_;
+  bool too_large_;
+  char* data_;
+  size_t size_;
+};
+
+
+class ReadFileWrap : public ReqWrap<uv_work_t> {
+ public:
+  ReadFileWrap(Environment* env,
+               const char* path,
+               int flags,
+               enum encoding encoding)
+      : ReqWrap<uv_work_t>(env, Object::New(env->isolate())),
+        reader_(path, flags),
+        encoding_(encoding) {
+  }
+
+  static void Work(uv_work_t* req) {
+    ReadFileWrap* req_wrap = static_cast<ReadFileWrap*>(req->data);
+    req_wrap->reader_.Read();
+  }
+
+  static void After(uv_work_t* req, int status) {
+    ReadFileWrap* req_wrap = static_cast<ReadFileWrap*>(req->data);
+    assert(status == 0);
+
+    Environment* env = req_wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    // A single op for the counters, even though it's open(), read() and
+    // close() underneath.
+    io_counters::Count(io_counters::kFsOps);
+    io_counters::Count(io_counters::kFsBytesRead, req_wrap->reader_.size());
+
+    Local<Value> argv[2];
+    int argc = 1;
+    argv[0] = req_wrap->reader_.Error(env);
+    if (argv[0]->IsUndefined()) {
+      argv[0] = Null(env->isolate());
+      argv[1] = req_wrap->reader_.Result(env, req_wrap->encoding_);
+      argc = 2;
+    }
+
+    req_wrap->MakeCallback(env->oncomplete_string(), argc, argv);
+    delete req_wrap;
+  }
+
+ private:
+  FileReader reader_;
+  enum encoding encoding_;
+};
+
+
+// readFile(path, flags, encoding, callback)
+static void ReadFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (args.Length() < 1)
+    return TYPE_ERROR("path required");
+  if (args.Length() < 2)
+    return TYPE_ERROR("flags required");
+  if (!args[0]->IsString())
+    return TYPE_ERROR("path must be a string");
+  if (!args[1]->IsInt32())
+    return TYPE_ERROR("flags must be an int");
+
+  node::Utf8Value path(args[0]);
+  int flags = args[1]->Int32Value();
+  enum encoding encoding = ParseEncoding(env->isolate(), args[2], BUFFER);
+
+  if (!args[3]->IsFunction())
+    return TYPE_ERROR("callback required");
+
+  ReadFileWrap* req_wrap = new ReadFileWrap(env, *path, flags, encoding);
+  req_wrap->object()->Set(env->oncomplete_string(), args[3]);
+  req_wrap->Dispatched();
+  // It's file system work even though it's done in one go
+  int err = uv_queue_work_class(env->event_loop(),
+                                &req_wrap->req_,
+                                UV_WORK_FAST_IO,
+                                ReadFileWrap::Work,
+                                ReadFileWrap::After);
+  assert(err == 0);
+  args.GetReturnValue().Set(req_wrap->persistent());
+}
+#endif  // !_WIN32
+
+
 static void Open(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
   HandleScope scope(env->isolate());
@@ -808,6 +1088,39 @@ static void WriteBuffer(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Wrapper for writev(2).
+//
+// bytesWritten = writeBuffers(fd, buffers, position, callback)
+// 0 fd        integer. file descriptor
+// 1 buffers   array of buffers to write, in order
+// 2 position  if integer, position to write at in the file.
+//             if null, write from the current position
+static void WriteBuffers(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (args.Length() < 2 || !args[0]->IsInt32() || !args[1]->IsArray())
+    return THROW_BAD_ARGS;
+
+  int fd = args[0]->Int32Value();
+  Local<Array> chunks = args[1].As<Array>();
+  int64_t pos = GET_OFFSET(args[2]);
+  Local<Value> cb = args[3];
+
+  fs_bufs_wrap bufs(chunks->Length());
+  if (!bufs.Fill(chunks))
+    return env->ThrowTypeError("Array elements all need to be buffers");
+
+  if (cb->IsFunction()) {
+    ASYNC_CALL(write, cb, fd, bufs.bufs, bufs.count, pos)
+    return;
+  }
+
+  SYNC_CALL(write, NULL, fd, bufs.bufs, bufs.count, pos)
+  args.GetReturnValue().Set(SYNC_RESULT);
+}
+
+
 // Wrapper for write(2).
 //
 // bytesWritten = write(fd, string, position, enc, callback)
@@ -877,6 +1190,49 @@ static void WriteString(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+/*
+ * Wrapper for sendfile(2).
+ *
+ * 0 out_fd     integer. file descriptor to write to, usually a socket
+ * 1 in_fd      integer. file descriptor to read from
+ * 2 in_offset  integer. offset in in_fd to start reading from
+ * 3 length     integer. number of bytes to send
+ * 4 callback   optional
+ *
+ * Returns (or calls back with) the number of bytes sent, which can be less
+ * than length.
+ */
+static void Sendfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (args.Length() < 4 ||
+      !args[0]->IsInt32() ||
+      !args[1]->IsInt32() ||
+      !args[2]->IsNumber() ||
+      !args[3]->IsNumber()) {
+    return THROW_BAD_ARGS;
+  }
+
+  int out_fd = args[0]->Int32Value();
+  int in_fd = args[1]->Int32Value();
+  int64_t in_offset = args[2]->IntegerValue();
+  int64_t length = args[3]->IntegerValue();
+
+  if (in_offset < 0 || length < 0)
+    return env->ThrowRangeError("Offset and length must not be negative");
+
+  Local<Value> cb = args[4];
+
+  if (cb->IsFunction()) {
+    ASYNC_CALL(sendfile, cb, out_fd, in_fd, in_offset, length)
+  } else {
+    SYNC_CALL(sendfile, 0, out_fd, in_fd, in_offset, length)
+    args.GetReturnValue().Set(SYNC_RESULT);
+  }
+}
+
+
 /*
  * Wrapper for read(2).
  *
@@ -940,6 +1296,41 @@ static void Read(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+/*
+ * Wrapper for readv(2).
+ *
+ * bytesRead = fs.readBuffers(fd, buffers, position, callback)
+ *
+ * 0 fd        integer. file descriptor
+ * 1 buffers   array of buffers, filled in order
+ * 2 position  file position - null for current position
+ *
+ */
+static void ReadBuffers(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  if (args.Length() < 2 || !args[0]->IsInt32() || !args[1]->IsArray())
+    return THROW_BAD_ARGS;
+
+  int fd = args[0]->Int32Value();
+  Local<Array> chunks = args[1].As<Array>();
+  int64_t pos = GET_OFFSET(args[2]);
+  Local<Value> cb = args[3];
+
+  fs_bufs_wrap bufs(chunks->Length());
+  if (!bufs.Fill(chunks))
+    return env->ThrowTypeError("Array elements all need to be buffers");
+
+  if (cb->IsFunction()) {
+    ASYNC_CALL(read, cb, fd, bufs.bufs, bufs.count, pos);
+  } else {
+    SYNC_CALL(read, 0, fd, bufs.bufs, bufs.count, pos)
+    args.GetReturnValue().Set(SYNC_RESULT);
+  }
+}
+
+
 /* fs.chmod(path, mode);
  * Wrapper for chmod(1) / EIO_CHMOD
  */
@@ -1128,6 +1519,11 @@ void InitFs(Handle<Object> target,
   NODE_SET_METHOD(target, "close", Close);
   NODE_SET_METHOD(target, "open", Open);
   NODE_SET_METHOD(target, "read", Read);
+  NODE_SET_METHOD(target, "readBuffers", ReadBuffers);
+#ifndef _WIN32
+  NODE_SET_METHOD(target, "readFile", ReadFile);
+#endif
+  NODE_SET_METHOD(target, "sendfile", Sendfile);
   NODE_SET_METHOD(target, "fdatasync", Fdatasync);
   NODE_SET_METHOD(target, "fsync", Fsync);
   NODE_SET_METHOD(target, "rename", Rename);
@@ -1143,6 +1539,7 @@ void InitFs(Handle<Object> target,
   NODE_SET_METHOD(target, "readlink", ReadLink);
   NODE_SET_METHOD(target, "unlink", Unlink);
   NODE_SET_METHOD(target, "writeBuffer", WriteBuffer);
+  NODE_SET_METHOD(target, "writeBuffers", WriteBuffers);
   NODE_SET_METHOD(target, "writeString", WriteString);
 
   NODE_SET_METHOD(target, "chmod", Chmod);
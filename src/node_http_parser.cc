@@ -63,6 +63,7 @@ using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
 using v8::Object;
 using v8::String;
@@ -163,6 +164,280 @@ struct StringPtr {
 };
 
 
+// Header names the parser recognizes. A header's id is its position in this
+// list, starting at 1, and JS land finds the names as HTTPParser.headerNames
+// (lower case) and HTTPParser.rawHeaderNames (as written below). Keep the
+// list short, ids have to fit in seven bits.
+#define HTTP_KNOWN_HEADER_MAP(V)                                              \
+  V("Accept")                                                                 \
+  V("Accept-Charset")                                                         \
+  V("Accept-Encoding")                                                        \
+  V("Accept-Language")                                                        \
+  V("Accept-Ranges")                                                          \
+  V("Access-Control-Request-Headers")                                         \
+  V("Access-Control-Request-Method")                                          \
+  V("Age")                                                                    \
+  V("Authorization")                                                          \
+  V("Cache-Control")                                                          \
+  V("Connection")                                                             \
+  V("Content-Disposition")                                                    \
+  V("Content-Encoding")                                                       \
+  V("Content-Language")                                                       \
+  V("Content-Length")                                                         \
+  V("Content-Range")                                                          \
+  V("Content-Type")                                                           \
+  V("Cookie")                                                                 \
+  V("Date")                                                                   \
+  V("DNT")                                                                    \
+  V("ETag")                                                                   \
+  V("Expect")                                                                 \
+  V("Expires")                                                                \
+  V("From")                                                                   \
+  V("Host")                                                                   \
+  V("If-Match")                                                               \
+  V("If-Modified-Since")                                                      \
+  V("If-None-Match")                                                          \
+  V("If-Range")                                                               \
+  V("If-Unmodified-Since")                                                    \
+  V("Keep-Alive")                                                             \
+  V("Last-Modified")                                                          \
+  V("Location")                                                               \
+  V("Max-Forwards")                                                           \
+  V("Origin")                                                                 \
+  V("Pragma")                                                                 \
+  V("Proxy-Authorization")                                                    \
+  V("Proxy-Connection")                                                       \
+  V("Range")                                                                  \
+  V("Referer")                                                                \
+  V("Sec-WebSocket-Key")                                                      \
+  V("Sec-WebSocket-Version")                                                  \
+  V("Server")                                                                 \
+  V("Set-Cookie")                                                             \
+  V("TE")                                                                     \
+  V("Trailer")                                                                \
+  V("Transfer-Encoding")                                                      \
+  V("Upgrade")                                                                \
+  V("User-Agent")                                                             \
+  V("Vary")                                                                   \
+  V("Via")                                                                    \
+  V("WWW-Authenticate")                                                       \
+  V("X-Forwarded-For")                                                        \
+  V("X-Forwarded-Proto")                                                      \
+  V("X-Real-IP")                                                              \
+  V("X-Requested-With")                                                       \
+
+
+static const char* const known_headers[] = {
+  NULL,
+#define V(name) name,
+  HTTP_KNOWN_HEADER_MAP(V)
+#undef V
+};
+
+static const unsigned kKnownHeaderCount = ARRAY_SIZE(known_headers) - 1;
+
+
+static inline char ToLowerASCII(char c) {
+  return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+
+// Open addressed hash table over the known header names, keyed on the
+// length and the first and last character. The table is sparse enough that
+// nearly every name sits in its home slot so a lookup is one probe and one
+// compare; a miss usually stops at an empty slot without touching the name.
+class KnownHeaders {
+ public:
+  // Bit 7 of an id is set when the name was written exactly as in
+  // HTTP_KNOWN_HEADER_MAP, JS land can use the interned raw name then.
+  static const unsigned char kCanonical = 0x80;
+
+  static void Initialize() {
+    if (initialized_)
+      return;
+    for (unsigned id = 1; id <= kKnownHeaderCount; id++) {
+      const char* name = known_headers[id];
+      unsigned slot = Hash(name, strlen(name));
+      while (slots_[slot] != 0)
+        slot = (slot + 1) % kSlots;
+      slots_[slot] = id;
+    }
+    initialized_ = true;
+  }
+
+  // Returns the id of header `name`, 0 if it's not a known header.
+  static unsigned char Lookup(const char* name, size_t size) {
+    if (size == 0 || size > kMaxLength)
+      return 0;
+    for (unsigned slot = Hash(name, size); slots_[slot] != 0;
+         slot = (slot + 1) % kSlots) {
+      unsigned char id = slots_[slot];
+      unsigned char match = Compare(known_headers[id], name, size);
+      if (match != 0)
+        return id | (match == 2 ? kCanonical : 0);
+    }
+    return 0;
+  }
+
+ private:
+  static const unsigned kSlots = 256;
+  static const size_t kMaxLength = 32;
+
+  static unsigned Hash(const char* name, size_t size) {
+    return (size * 37 +
+            ToLowerASCII(name[0]) * 7 +
+            ToLowerASCII(name[size - 1]) * 3) % kSlots;
+  }
+
+  // 0 if `name` isn't `known`, 1 if it is modulo case, 2 if it's identical.
+  static unsigned char Compare(const char* known,
+                               const char* name,
+                               size_t size) {
+    unsigned char result = 2;
+    for (size_t i = 0; i < size; i++) {
+      if (known[i] == '\0')
+        return 0;
+      if (known[i] != name[i]) {
+        if (ToLowerASCII(known[i]) != ToLowerASCII(name[i]))
+          return 0;
+        result = 1;
+      }
+    }
+    return known[size] == '\0' ? result : 0;
+  }
+
+  static unsigned char slots_[kSlots];
+  static bool initialized_;
+};
+
+unsigned char KnownHeaders::slots_[KnownHeaders::kSlots];
+bool KnownHeaders::initialized_;
+
+
+// Collects the header fields and values of a message into one contiguous
+// block, JS land only turns the ones it looks at into strings. The block is
+// handed over as a Buffer laid out as:
+//
+//     uint32 count, uint32 end[count], field0 value0 field1 value1 ...
+//
+// where the low 24 bits of `end[i]` are the offset just past string `i` in
+// the data that follows the index and all integers are little endian. The
+// top byte of a field's `end` is its KnownHeaders id, 0 for other headers.
+struct HeaderBlock {
+  HeaderBlock() : data_(NULL),
+                  size_(0),
+                  capacity_(0),
+                  ends_(NULL),
+                  count_(0),
+                  ends_capacity_(0) {
+  }
+
+
+  ~HeaderBlock() {
+    free(data_);
+    free(ends_);
+  }
+
+
+  void Reset() {
+    // Don't hold on to the memory of an unusually large header block
+    if (capacity_ > kRetainedSize) {
+      free(data_);
+      data_ = NULL;
+      capacity_ = 0;
+    }
+    size_ = 0;
+    count_ = 0;
+  }
+
+
+  // Fields and values alternate, consecutive calls for the same kind of
+  // string extend it.
+  void Update(bool value, const char* str, size_t size) {
+    bool in_value = count_ % 2 == 0 && count_ != 0;
+    bool in_field = count_ % 2 == 1;
+    if (value ? !in_value : !in_field) {
+      if (in_field)
+        Classify();
+      if (count_ == ends_capacity_) {
+        ends_capacity_ = ends_capacity_ == 0 ? 64 : 2 * ends_capacity_;
+        ends_ = static_cast<uint32_t*>(
+            realloc(ends_, ends_capacity_ * sizeof(*ends_)));
+        if (ends_ == NULL)
+          FatalError("node::HeaderBlock::Update()", "Out Of Memory");
+      }
+      count_++;
+    }
+
+    if (size_ + size > capacity_) {
+      while (size_ + size > capacity_)
+        capacity_ = capacity_ == 0 ? 1024 : 2 * capacity_;
+      data_ = static_cast<char*>(realloc(data_, capacity_));
+      if (data_ == NULL)
+        FatalError("node::HeaderBlock::Update()", "Out Of Memory");
+    }
+
+    memcpy(data_ + size_, str, size);
+    size_ += size;
+    // http_parser caps the header size well below this
+    assert(size_ <= kOffsetMask);
+    ends_[count_ - 1] = size_;
+  }
+
+
+  // Tags the field that was just completed with its KnownHeaders id.
+  void Classify() {
+    size_t start = count_ < 2 ? 0 : ends_[count_ - 2];
+    size_t end = ends_[count_ - 1];
+    uint32_t id = KnownHeaders::Lookup(data_ + start, end - start);
+    ends_[count_ - 1] = end | (id << kIdShift);
+  }
+
+
+  // Number of complete field/value pairs
+  size_t pairs() const {
+    return count_ / 2;
+  }
+
+
+  Local<Object> ToBuffer(Environment* env) const {
+    // A trailing field without a value is dropped
+    size_t count = 2 * pairs();
+    size_t size = count == 0 ? 0 : ends_[count - 1];
+    size_t index_size = 4 * (count + 1);
+
+    Local<Object> buf = Buffer::New(env, index_size + size);
+    unsigned char* out = reinterpret_cast<unsigned char*>(Buffer::Data(buf));
+    WriteUInt32LE(out, count);
+    for (size_t i = 0; i < count; i++)
+      WriteUInt32LE(out + 4 * (i + 1), ends_[i]);
+    memcpy(out + index_size, data_, size);
+
+    return buf;
+  }
+
+
+  static void WriteUInt32LE(unsigned char* out, uint32_t val) {
+    out[0] = val & 0xff;
+    out[1] = (val >> 8) & 0xff;
+    out[2] = (val >> 16) & 0xff;
+    out[3] = (val >> 24) & 0xff;
+  }
+
+
+  static const size_t kRetainedSize = 16 * 1024;
+  static const uint32_t kIdShift = 24;
+  static const uint32_t kOffsetMask = (1 << kIdShift) - 1;
+
+  char* data_;
+  size_t size_;
+  size_t capacity_;
+  uint32_t* ends_;
+  size_t count_;
+  size_t ends_capacity_;
+};
+
+
 class Parser : public BaseObject {
  public:
   Parser(Environment* env, Local<Object> wrap, enum http_parser_type type)
@@ -181,7 +456,7 @@ class Parser : public BaseObject {
 
 
   HTTP_CB(on_message_begin) {
-    num_fields_ = num_values_ = 0;
+    headers_.Reset();
     url_.Reset();
     status_message_.Reset();
     return 0;
@@ -201,39 +476,13 @@ class Parser : public BaseObject {
 
 
   HTTP_DATA_CB(on_header_field) {
-    if (num_fields_ == num_values_) {
-      // start of new field name
-      num_fields_++;
-      if (num_fields_ == ARRAY_SIZE(fields_)) {
-        // ran out of space - flush to javascript land
-        Flush();
-        num_fields_ = 1;
-        num_values_ = 0;
-      }
-      fields_[num_fields_ - 1].Reset();
-    }
-
-    assert(num_fields_ < static_cast<int>(ARRAY_SIZE(fields_)));
-    assert(num_fields_ == num_values_ + 1);
-
-    fields_[num_fields_ - 1].Update(at, length);
-
+    headers_.Update(false, at, length);
     return 0;
   }
 
 
   HTTP_DATA_CB(on_header_value) {
-    if (num_values_ != num_fields_) {
-      // start of new header value
-      num_values_++;
-      values_[num_values_ - 1].Reset();
-    }
-
-    assert(num_values_ < static_cast<int>(ARRAY_SIZE(values_)));
-    assert(num_values_ == num_fields_);
-
-    values_[num_values_ - 1].Update(at, length);
-
+    headers_.Update(true, at, length);
     return 0;
   }
 
@@ -247,16 +496,10 @@ class Parser : public BaseObject {
 
     Local<Object> message_info = Object::New(env()->isolate());
 
-    if (have_flushed_) {
-      // Slow case, flush remaining headers.
-      Flush();
-    } else {
-      // Fast case, pass headers and URL to JS land.
-      message_info->Set(env()->headers_string(), CreateHeaders());
-      if (parser_.type == HTTP_REQUEST)
-        message_info->Set(env()->url_string(), url_.ToString(env()));
-    }
-    num_fields_ = num_values_ = 0;
+    message_info->Set(env()->headers_string(), headers_.ToBuffer(env()));
+    if (parser_.type == HTTP_REQUEST)
+      message_info->Set(env()->url_string(), url_.ToString(env()));
+    headers_.Reset();
 
     // METHOD
     if (parser_.type == HTTP_REQUEST) {
@@ -329,7 +572,7 @@ class Parser : public BaseObject {
   HTTP_CB(on_message_complete) {
     HandleScope scope(env()->isolate());
 
-    if (num_fields_)
+    if (headers_.pairs() != 0)
       Flush();  // Flush trailing HTTP headers.
 
     Local<Object> obj = object();
@@ -369,14 +612,6 @@ class Parser : public BaseObject {
   void Save() {
     url_.Save();
     status_message_.Save();
-
-    for (int i = 0; i < num_fields_; i++) {
-      fields_[i].Save();
-    }
-
-    for (int i = 0; i < num_values_; i++) {
-      values_[i].Save();
-    }
   }
 
 
@@ -492,21 +727,7 @@ class Parser : public BaseObject {
 
  private:
 
-  Local<Array> CreateHeaders() {
-    // num_values_ is either -1 or the entry # of the last header
-    // so num_values_ == 0 means there's a single header
-    Local<Array> headers = Array::New(env()->isolate(), 2 * num_values_);
-
-    for (int i = 0; i < num_values_; ++i) {
-      headers->Set(2 * i, fields_[i].ToString(env()));
-      headers->Set(2 * i + 1, values_[i].ToString(env()));
-    }
-
-    return headers;
-  }
-
-
-  // spill headers and request path to JS land
+  // spill trailing headers to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
 
@@ -517,9 +738,10 @@ class Parser : public BaseObject {
       return;
 
     Local<Value> argv[2] = {
-      CreateHeaders(),
+      headers_.ToBuffer(env()),
       url_.ToString(env())
     };
+    headers_.Reset();
 
     Local<Value> r = cb.As<Function>()->Call(obj, ARRAY_SIZE(argv), argv);
 
@@ -527,7 +749,6 @@ class Parser : public BaseObject {
       got_exception_ = true;
 
     url_.Reset();
-    have_flushed_ = true;
   }
 
 
@@ -535,21 +756,15 @@ class Parser : public BaseObject {
     http_parser_init(&parser_, type);
     url_.Reset();
     status_message_.Reset();
-    num_fields_ = 0;
-    num_values_ = 0;
-    have_flushed_ = false;
+    headers_.Reset();
     got_exception_ = false;
   }
 
 
   http_parser parser_;
-  StringPtr fields_[32];  // header fields
-  StringPtr values_[32];  // header values
+  HeaderBlock headers_;
   StringPtr url_;
   StringPtr status_message_;
-  int num_fields_;
-  int num_values_;
-  bool have_flushed_;
   bool got_exception_;
   Local<Object> current_buffer_;
   size_t current_buffer_len_;
@@ -570,6 +785,13 @@ const struct http_parser_settings Parser::settings = {
 };
 
 
+static Local<String> InternalizedString(Isolate* isolate, const char* str) {
+  return String::NewFromOneByte(isolate,
+                                reinterpret_cast<const uint8_t*>(str),
+                                String::kInternalizedString);
+}
+
+
 void InitHttpParser(Handle<Object> target,
                     Handle<Value> unused,
                     Handle<Context> context,
@@ -595,11 +817,30 @@ void InitHttpParser(Handle<Object> target,
 
   Local<Array> methods = Array::New(env->isolate());
 #define V(num, name, string)                                                  \
-    methods->Set(num, FIXED_ONE_BYTE_STRING(env->isolate(), #string));
+    methods->Set(num, InternalizedString(env->isolate(), #string));
   HTTP_METHOD_MAP(V)
 #undef V
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "methods"), methods);
 
+  KnownHeaders::Initialize();
+  Local<Array> header_names = Array::New(env->isolate(), kKnownHeaderCount);
+  Local<Array> raw_header_names = Array::New(env->isolate(),
+                                             kKnownHeaderCount);
+  for (unsigned id = 1; id <= kKnownHeaderCount; id++) {
+    const char* name = known_headers[id];
+    char lower[64];
+    size_t size = strlen(name);
+    assert(size < sizeof(lower));
+    for (size_t i = 0; i < size; i++)
+      lower[i] = ToLowerASCII(name[i]);
+    lower[size] = '\0';
+    header_names->Set(id, InternalizedString(env->isolate(), lower));
+    raw_header_names->Set(id, InternalizedString(env->isolate(), name));
+  }
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "headerNames"), header_names);
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "rawHeaderNames"),
+         raw_header_names);
+
   NODE_SET_PROTOTYPE_METHOD(t, "close", Parser::Close);
   NODE_SET_PROTOTYPE_METHOD(t, "execute", Parser::Execute);
   NODE_SET_PROTOTYPE_METHOD(t, "finish", Parser::Finish);
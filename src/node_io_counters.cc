@@ -0,0 +1,156 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "node_io_counters.h"
+#include "node.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stdio.h>  // snprintf()
+#include <string.h>  // memcpy(), strncpy()
+#include <string>
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+namespace io_counters {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Handle;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+using v8::kExternalDoubleArray;
+
+static const char* const counter_names[kCounterCount] = {
+#define V(Name, name) #name,
+  NODE_IO_COUNTERS(V)
+#undef V
+};
+
+// Where the counters live until MapFile() moves them.
+static double anonymous_counters[kCounterCount];
+
+double* counters = anonymous_counters;
+
+
+int MapFile(const char* filename) {
+#if defined(_WIN32)
+  return UV_ENOSYS;
+#else
+  // "%p" is replaced with the pid, so that forked workers don't all end up
+  // truncating and writing to the same file. Without one, the pid goes at
+  // the end, the environment is inherited and the file is never shared.
+  std::string path(filename);
+  char pid[32];
+  snprintf(pid, sizeof(pid), "%d", static_cast<int>(getpid()));
+  size_t pos = path.find("%p");
+  if (pos == std::string::npos)
+    path.append(".").append(pid);
+  for (; pos != std::string::npos; pos = path.find("%p", pos))
+    path.replace(pos, 2, pid);
+
+  int flags = O_RDWR | O_CREAT | O_TRUNC;
+#ifdef O_CLOEXEC
+  flags |= O_CLOEXEC;
+#endif
+  int fd;
+  do {
+    fd = open(path.c_str(), flags, 0644);
+  } while (fd == -1 && errno == EINTR);
+
+  if (fd == -1)
+    return -errno;
+
+  Header* header;
+  double* values;
+  const size_t size = sizeof(*header) +
+                      kCounterCount * (sizeof(*values) + kNameSize);
+  void* base = MAP_FAILED;
+  int err = 0;
+  if (ftruncate(fd, size) == 0)
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED)
+    err = -errno;
+  close(fd);
+
+  if (err != 0)
+    return err;
+
+  header = static_cast<Header*>(base);
+  values = reinterpret_cast<double*>(header + 1);
+  char* names = reinterpret_cast<char*>(values + kCounterCount);
+
+  header->version = kVersion;
+  header->count = kCounterCount;
+  header->pid = getpid();
+  header->name_size = kNameSize;
+  for (int i = 0; i < kCounterCount; i += 1)
+    strncpy(names + i * kNameSize, counter_names[i], kNameSize - 1);
+  memcpy(values, counters, kCounterCount * sizeof(*values));
+  // Last, so that a reader that sees the magic sees a complete header.
+  memcpy(header->magic, "NODEIOC", sizeof(header->magic));
+
+  counters = values;
+  return 0;
+#endif
+}
+
+
+void Initialize(Handle<Object> target,
+                Handle<Value> unused,
+                Handle<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<Array> names = Array::New(env->isolate(), kCounterCount);
+  for (int i = 0; i < kCounterCount; i += 1)
+    names->Set(i, OneByteString(env->isolate(), counter_names[i]));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "names"), names);
+
+#define V(Name, name) NODE_DEFINE_CONSTANT(target, k ## Name);
+  NODE_IO_COUNTERS(V)
+#undef V
+
+  // MapFile() runs before any JS does, the pointer doesn't change after.
+  Local<Object> counters_object = Object::New(env->isolate());
+  counters_object->SetIndexedPropertiesToExternalArrayData(
+      counters,
+      kExternalDoubleArray,
+      kCounterCount);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "counters"),
+              counters_object);
+}
+
+}  // namespace io_counters
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(io_counters, node::io_counters::Initialize)
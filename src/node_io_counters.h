@@ -0,0 +1,115 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_NODE_IO_COUNTERS_H_
+#define SRC_NODE_IO_COUNTERS_H_
+
+#include "uv.h"
+
+#include <stdint.h>
+
+namespace node {
+namespace io_counters {
+
+// Running totals of I/O done by the process, kept in a block of doubles that
+// JS reads directly and that can be put in a file for other processes to
+// read, see MapFile(). Only the main thread updates them.
+#define NODE_IO_COUNTERS(V)                                                   \
+  V(TcpBytesRead, tcpBytesRead)                                               \
+  V(TcpBytesWritten, tcpBytesWritten)                                         \
+  V(TcpReads, tcpReads)                                                       \
+  V(TcpWrites, tcpWrites)                                                     \
+  V(TcpConnections, tcpConnections)                                           \
+  V(PipeBytesRead, pipeBytesRead)                                             \
+  V(PipeBytesWritten, pipeBytesWritten)                                       \
+  V(PipeReads, pipeReads)                                                     \
+  V(PipeWrites, pipeWrites)                                                   \
+  V(PipeConnections, pipeConnections)                                         \
+  V(UdpBytesReceived, udpBytesReceived)                                       \
+  V(UdpBytesSent, udpBytesSent)                                               \
+  V(UdpDatagramsReceived, udpDatagramsReceived)                               \
+  V(UdpDatagramsSent, udpDatagramsSent)                                       \
+  V(FsBytesRead, fsBytesRead)                                                 \
+  V(FsBytesWritten, fsBytesWritten)                                           \
+  V(FsOps, fsOps)                                                             \
+  V(TlsHandshakes, tlsHandshakes)                                             \
+  V(HttpServerRequests, httpServerRequests)                                   \
+  V(HttpServerResponses, httpServerResponses)                                 \
+  V(HttpClientRequests, httpClientRequests)                                   \
+  V(HttpClientResponses, httpClientResponses)                                 \
+
+enum Counter {
+#define V(Name, name) k ## Name,
+  NODE_IO_COUNTERS(V)
+#undef V
+  kCounterCount
+};
+
+// Layout of the block, this is what external readers see:
+//
+//   offset     size       field
+//   0          8          magic, "NODEIOC\0"
+//   8          4          version, currently 1
+//   12         4          number of counters, n
+//   16         4          pid
+//   20         4          size of a name slot, currently 32
+//   24         8 * n      counter values, native byte order doubles
+//   24 + 8n    32 * n     counter names, NUL padded
+//
+// Counters are only ever added to the end of the list, readers should go by
+// the names rather than the indices.
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t count;
+  uint32_t pid;
+  uint32_t name_size;
+};
+
+static const uint32_t kVersion = 1;
+static const uint32_t kNameSize = 32;
+
+extern double* counters;
+
+inline void Count(Counter counter, double amount = 1) {
+  counters[counter] += amount;
+}
+
+// Streams are either TCP sockets or pipes as far as the counters go.
+inline void CountStream(const uv_stream_t* stream,
+                        Counter tcp,
+                        Counter pipe,
+                        double amount = 1) {
+  if (stream->type == UV_TCP)
+    Count(tcp, amount);
+  else if (stream->type == UV_NAMED_PIPE)
+    Count(pipe, amount);
+}
+
+// Moves the counters into a file that is mapped shared, so that another
+// process can mmap() it and watch them. Returns 0 or a libuv error code.
+// Not supported on Windows.
+int MapFile(const char* filename);
+
+}  // namespace io_counters
+}  // namespace node
+
+#endif  // SRC_NODE_IO_COUNTERS_H_
@@ -0,0 +1,545 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Binary serialization for the IPC channel of child processes forked with
+// { serialization: 'binary' }. A message is a tagged tree of values:
+//
+//   null, true, false        tag only
+//   int32, double            tag + value, native byte order
+//   string                   tag + uint32 length + latin1 or UTF-16 units
+//   buffer                   tag + uint32 length + raw bytes
+//   array                    tag + uint32 count + values
+//   object                   tag + uint32 count + (string key, value) pairs
+//
+// Both ends of the channel are on the same machine, so nothing gets
+// swapped. Values are picked the way JSON.stringify() picks them, except
+// that buffers go out as raw bytes and numbers go out unchanged.
+
+#include "node.h"
+#include "node_buffer.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>  // malloc(), realloc(), free()
+#include <string.h>  // memcpy()
+
+namespace node {
+namespace ipc {
+
+using v8::Array;
+using v8::BooleanObject;
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::Handle;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::NumberObject;
+using v8::Object;
+using v8::String;
+using v8::StringObject;
+using v8::Value;
+
+enum Tag {
+  kNull,
+  kTrue,
+  kFalse,
+  kInt32,
+  kDouble,
+  kOneByteString,
+  kTwoByteString,
+  kBuffer,
+  kArray,
+  kObject
+};
+
+// Deep enough for any sane message, shallow enough for the C++ stack.
+static const int kMaxDepth = 1000;
+static const size_t kHeaderSize = 4;
+
+
+class Serializer {
+ public:
+  explicit Serializer(Environment* env)
+      : env_(env),
+        data_(NULL),
+        length_(0),
+        capacity_(0),
+        depth_(0) {
+  }
+
+  ~Serializer() {
+    free(data_);
+  }
+
+  // Returns the frame, length header included, and hands over ownership.
+  char* Release(size_t* length) {
+    assert(length_ >= kHeaderSize);
+    uint32_t size = length_ - kHeaderSize;
+    data_[0] = size & 0xff;
+    data_[1] = (size >> 8) & 0xff;
+    data_[2] = (size >> 16) & 0xff;
+    data_[3] = (size >> 24) & 0xff;
+    char* data = data_;
+    *length = length_;
+    data_ = NULL;
+    length_ = capacity_ = 0;
+    return data;
+  }
+
+  void WriteHeader() {
+    Reserve(kHeaderSize);
+    length_ += kHeaderSize;
+  }
+
+  // Returns false with an exception pending if |value| can't be sent.
+  bool WriteValue(Local<Value> value) {
+    return Prepare(&value, String::Empty(env_->isolate())) &&
+           WritePrepared(value);
+  }
+
+ private:
+  static bool IsBuffer(Local<Value> value) {
+    return Buffer::HasInstance(value) && !value->IsTypedArray();
+  }
+
+  // Calls toJSON() and unwraps Number, String and Boolean objects, which is
+  // what JSON.stringify() does before it decides how to write a value.
+  // Returns false with an exception pending if toJSON() throws.
+  bool Prepare(Local<Value>* value, Local<Value> key) {
+    // Buffers go out as raw bytes, not through Buffer.prototype.toJSON().
+    if (!(*value)->IsObject() || IsBuffer(*value))
+      return true;
+
+    if (!ToJSON(value, key))
+      return false;
+    if ((*value)->IsNumberObject())
+      *value = Number::New(env_->isolate(),
+                           value->As<NumberObject>()->ValueOf());
+    else if ((*value)->IsStringObject())
+      *value = value->As<StringObject>()->ValueOf();
+    else if ((*value)->IsBooleanObject())
+      *value = v8::Boolean::New(env_->isolate(),
+                                value->As<BooleanObject>()->ValueOf());
+    return true;
+  }
+
+  bool WritePrepared(Local<Value> value) {
+    if (IsBuffer(value))
+      return WriteBuffer(value.As<Object>());
+
+    if (value->IsInt32()) {
+      int32_t n = value->Int32Value();
+      WriteTag(kInt32);
+      WriteRaw(&n, sizeof(n));
+    } else if (value->IsNumber()) {
+      double n = value->NumberValue();
+      WriteTag(kDouble);
+      WriteRaw(&n, sizeof(n));
+    } else if (value->IsString()) {
+      WriteString(value.As<String>());
+    } else if (value->IsTrue()) {
+      WriteTag(kTrue);
+    } else if (value->IsFalse()) {
+      WriteTag(kFalse);
+    } else if (Skip(value)) {
+      WriteTag(kNull);
+    } else if (value->IsArray()) {
+      return WriteArray(value.As<Array>());
+    } else if (value->IsObject()) {
+      return WriteObject(value.As<Object>());
+    } else {
+      WriteTag(kNull);
+    }
+    return true;
+  }
+
+  bool WriteBuffer(Local<Object> obj) {
+    size_t length = Buffer::Length(obj);
+    if (length > UINT32_MAX) {
+      env_->ThrowRangeError("Buffer too large to send");
+      return false;
+    }
+    WriteTag(kBuffer);
+    WriteUint32(length);
+    WriteRaw(Buffer::Data(obj), length);
+    return true;
+  }
+
+  // What JSON.stringify() leaves out of objects (and turns into null in
+  // arrays).
+  static bool Skip(Local<Value> value) {
+    return value->IsUndefined() ||
+           value->IsNull() ||
+           value->IsFunction() ||
+           value->IsSymbol();
+  }
+
+  bool ToJSON(Local<Value>* value, Local<Value> key) {
+    Local<Object> obj = value->As<Object>();
+    Local<Value> fn = obj->Get(env_->to_json_string());
+    if (!fn->IsFunction())
+      return true;
+    Local<Value> arg = key->ToString();
+    v8::TryCatch try_catch;
+    Local<Value> result = fn.As<Function>()->Call(obj, 1, &arg);
+    if (try_catch.HasCaught()) {
+      try_catch.ReThrow();
+      return false;
+    }
+    *value = result;
+    return true;
+  }
+
+  bool Enter(Local<Object> obj) {
+    if (depth_ == kMaxDepth) {
+      env_->ThrowRangeError("Message is nested too deeply");
+      return false;
+    }
+    for (int i = 0; i < depth_; i++) {
+      if (stack_[i]->StrictEquals(obj)) {
+        env_->ThrowTypeError("Converting circular structure");
+        return false;
+      }
+    }
+    stack_[depth_++] = obj;
+    return true;
+  }
+
+  void Leave() {
+    depth_--;
+  }
+
+  bool WriteArray(Local<Array> array) {
+    if (!Enter(array))
+      return false;
+    uint32_t count = array->Length();
+    WriteTag(kArray);
+    WriteUint32(count);
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> value = array->Get(i);
+      if (!Prepare(&value, Integer::NewFromUnsigned(env_->isolate(), i)) ||
+          !WritePrepared(value)) {
+        return false;
+      }
+    }
+    Leave();
+    return true;
+  }
+
+  bool WriteObject(Local<Object> obj) {
+    if (!Enter(obj))
+      return false;
+    Local<Array> keys = obj->GetOwnPropertyNames();
+    uint32_t count = keys->Length();
+    WriteTag(kObject);
+    // Patched once we know how many properties were left out.
+    size_t count_offset = length_;
+    WriteUint32(count);
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> key = keys->Get(i);
+      Local<Value> value = obj->Get(key);
+      // Filter on what toJSON() returned, like JSON.stringify()
+      if (!Prepare(&value, key))
+        return false;
+      if (Skip(value) && !value->IsNull())
+        continue;
+      WriteString(key->ToString());
+      if (!WritePrepared(value))
+        return false;
+      written++;
+    }
+    memcpy(data_ + count_offset, &written, sizeof(written));
+    Leave();
+    return true;
+  }
+
+  void WriteString(Local<String> string) {
+    uint32_t length = string->Length();
+    int flags = String::NO_NULL_TERMINATION;
+    if (string->IsOneByte()) {
+      WriteTag(kOneByteString);
+      WriteUint32(length);
+      Reserve(length);
+      string->WriteOneByte(reinterpret_cast<uint8_t*>(data_ + length_),
+                           0,
+                           length,
+                           flags);
+      length_ += length;
+    } else {
+      WriteTag(kTwoByteString);
+      WriteUint32(length);
+      Reserve(length * sizeof(uint16_t));
+      // The frame can start anywhere, don't bother aligning.
+      uint16_t stack_units[256];
+      uint16_t* units = stack_units;
+      if (length > ARRAY_SIZE(stack_units))
+        units = new uint16_t[length];
+      string->Write(units, 0, length, flags);
+      WriteRaw(units, length * sizeof(*units));
+      if (units != stack_units)
+        delete[] units;
+    }
+  }
+
+  void WriteTag(Tag tag) {
+    Reserve(1);
+    data_[length_++] = tag;
+  }
+
+  void WriteUint32(uint32_t n) {
+    WriteRaw(&n, sizeof(n));
+  }
+
+  void WriteRaw(const void* data, size_t length) {
+    Reserve(length);
+    memcpy(data_ + length_, data, length);
+    length_ += length;
+  }
+
+  void Reserve(size_t n) {
+    if (length_ + n <= capacity_)
+      return;
+    size_t capacity = capacity_ == 0 ? 256 : capacity_;
+    while (capacity < length_ + n)
+      capacity *= 2;
+    data_ = static_cast<char*>(realloc(data_, capacity));
+    if (data_ == NULL)
+      FatalError("node::ipc::Serializer", "Out Of Memory");
+    capacity_ = capacity;
+  }
+
+  Environment* const env_;
+  char* data_;
+  size_t length_;
+  size_t capacity_;
+  int depth_;
+  Local<Object> stack_[kMaxDepth];
+
+  DISALLOW_COPY_AND_ASSIGN(Serializer);
+};
+
+
+class Deserializer {
+ public:
+  Deserializer(Environment* env, const char* data, size_t length)
+      : env_(env),
+        data_(data),
+        length_(length),
+        offset_(0) {
+  }
+
+  bool done() const { return offset_ == length_; }
+
+  // Returns an empty handle if the message is malformed.
+  Local<Value> ReadValue(int depth) {
+    Isolate* isolate = env_->isolate();
+    uint8_t tag;
+
+    if (depth == kMaxDepth || !ReadRaw(&tag, sizeof(tag)))
+      return Local<Value>();
+
+    switch (tag) {
+      case kNull:
+        return v8::Null(isolate);
+      case kTrue:
+        return v8::True(isolate);
+      case kFalse:
+        return v8::False(isolate);
+      case kInt32: {
+        int32_t n;
+        if (!ReadRaw(&n, sizeof(n)))
+          break;
+        return Integer::New(isolate, n);
+      }
+      case kDouble: {
+        double n;
+        if (!ReadRaw(&n, sizeof(n)))
+          break;
+        return Number::New(isolate, n);
+      }
+      case kOneByteString:
+      case kTwoByteString:
+        return ReadString(tag, String::kNormalString);
+      case kBuffer: {
+        uint32_t length;
+        if (!ReadUint32(&length) || length > length_ - offset_)
+          break;
+        Local<Object> buffer = Buffer::New(env_, data_ + offset_, length);
+        offset_ += length;
+        return buffer;
+      }
+      case kArray: {
+        uint32_t count;
+        if (!ReadUint32(&count) || count > length_ - offset_)
+          break;
+        Local<Array> array = Array::New(isolate, count);
+        for (uint32_t i = 0; i < count; i++) {
+          Local<Value> value = ReadValue(depth + 1);
+          if (value.IsEmpty())
+            return value;
+          array->Set(i, value);
+        }
+        return array;
+      }
+      case kObject: {
+        uint32_t count;
+        if (!ReadUint32(&count) || count > length_ - offset_)
+          break;
+        Local<Object> obj = Object::New(isolate);
+        for (uint32_t i = 0; i < count; i++) {
+          uint8_t key_tag;
+          if (!ReadRaw(&key_tag, sizeof(key_tag)))
+            return Local<Value>();
+          Local<Value> key = ReadString(key_tag, String::kInternalizedString);
+          if (key.IsEmpty())
+            return key;
+          Local<Value> value = ReadValue(depth + 1);
+          if (value.IsEmpty())
+            return value;
+          // An own property even for "__proto__", like JSON.parse()
+          obj->ForceSet(key, value);
+        }
+        return obj;
+      }
+    }
+
+    return Local<Value>();
+  }
+
+ private:
+  Local<Value> ReadString(uint8_t tag, String::NewStringType type) {
+    uint32_t length;
+    if (!ReadUint32(&length))
+      return Local<Value>();
+
+    if (tag == kOneByteString) {
+      if (length > length_ - offset_)
+        return Local<Value>();
+      const uint8_t* data = reinterpret_cast<const uint8_t*>(data_ + offset_);
+      offset_ += length;
+      return String::NewFromOneByte(env_->isolate(), data, type, length);
+    }
+
+    if (tag != kTwoByteString || length > (length_ - offset_) / 2)
+      return Local<Value>();
+
+    uint16_t stack_units[256];
+    uint16_t* units = stack_units;
+    if (length > ARRAY_SIZE(stack_units))
+      units = new uint16_t[length];
+    ReadRaw(units, length * sizeof(*units));
+    Local<String> string =
+        String::NewFromTwoByte(env_->isolate(), units, type, length);
+    if (units != stack_units)
+      delete[] units;
+    return string;
+  }
+
+  bool ReadUint32(uint32_t* n) {
+    return ReadRaw(n, sizeof(*n));
+  }
+
+  bool ReadRaw(void* data, size_t length) {
+    if (length > length_ - offset_)
+      return false;
+    memcpy(data, data_ + offset_, length);
+    offset_ += length;
+    return true;
+  }
+
+  Environment* const env_;
+  const char* const data_;
+  const size_t length_;
+  size_t offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(Deserializer);
+};
+
+
+// frame = serialize(message)
+//
+// Returns a buffer with the length-prefixed frame for |message|. The length
+// is a little endian uint32.
+static void Serialize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  Serializer serializer(env);
+  serializer.WriteHeader();
+  if (!serializer.WriteValue(args[0]))
+    return;
+
+  size_t length;
+  char* data = serializer.Release(&length);
+  if (length > Buffer::kMaxLength) {
+    free(data);
+    return env->ThrowRangeError("Message too large to send");
+  }
+  args.GetReturnValue().Set(Buffer::Use(env, data, length));
+}
+
+
+// message = parse(buffer, start, end)
+//
+// Decodes the frame payload in buffer[start:end].
+static void Parse(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  assert(Buffer::HasInstance(args[0]));
+  Local<Object> buffer = args[0].As<Object>();
+  size_t start = args[1]->Uint32Value();
+  size_t end = args[2]->Uint32Value();
+  assert(start <= end && end <= Buffer::Length(buffer));
+
+  Deserializer deserializer(env, Buffer::Data(buffer) + start, end - start);
+  Local<Value> message = deserializer.ReadValue(0);
+  if (message.IsEmpty() || !deserializer.done())
+    return env->ThrowError("Malformed IPC message");
+
+  args.GetReturnValue().Set(message);
+}
+
+
+void Initialize(Handle<Object> target,
+                Handle<Value> unused,
+                Handle<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  NODE_SET_METHOD(target, "serialize", Serialize);
+  NODE_SET_METHOD(target, "parse", Parse);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kHeaderSize"),
+              Integer::NewFromUnsigned(env->isolate(), kHeaderSize));
+}
+
+}  // namespace ipc
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(ipc, node::ipc::Initialize)
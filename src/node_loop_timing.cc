@@ -0,0 +1,171 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Histograms of how long each phase of an event loop iteration takes, fed
+// by uv_loop_set_timing_cb(). The histograms live in arrays of doubles that
+// JS reads directly, so looking at them costs nothing and recording costs a
+// few clock reads per iteration, and only while timing is on.
+//
+// Bucket 0 counts iterations where the phase took less than a microsecond,
+// bucket n > 0 the ones that took [2^(n-1), 2^n) microseconds. The last
+// bucket takes everything longer.
+
+#include "node.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <string.h>  // memset()
+
+namespace node {
+namespace loop_timing {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Handle;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+using v8::kExternalDoubleArray;
+
+// The libuv phases, plus one for the time the loop spent doing anything
+// other than waiting for I/O. That's the one to watch for saturation.
+enum Phases {
+  kBusy = UV_LOOP_PHASE_MAX,
+  kPhaseCount
+};
+
+static const int kBuckets = 32;
+
+// *Must* match the order of uv_loop_phase in uv.h.
+static const char* const phase_names[kPhaseCount] = {
+  "timers",
+  "pending",
+  "idle",
+  "prepare",
+  "pollWait",
+  "pollIO",
+  "check",
+  "closing",
+  "busy"
+};
+
+// Only the main event loop is timed, so there's one set of these.
+static double histogram[kPhaseCount * kBuckets];
+// Nanoseconds per phase, then the number of iterations.
+static double totals[kPhaseCount + 1];
+
+
+static inline int Bucket(uint64_t ns) {
+  uint64_t us = ns / 1000;
+  if (us == 0)
+    return 0;
+  int bucket;
+#if defined(__GNUC__)
+  bucket = 64 - __builtin_clzll(us);
+#else
+  for (bucket = 0; us != 0; us >>= 1)
+    bucket += 1;
+#endif
+  return bucket < kBuckets ? bucket : kBuckets - 1;
+}
+
+
+static void Record(int phase, uint64_t ns) {
+  histogram[phase * kBuckets + Bucket(ns)] += 1;
+  totals[phase] += ns;
+}
+
+
+static void OnIteration(uv_loop_t* loop, const uint64_t* timing) {
+  uint64_t busy = 0;
+  for (int phase = 0; phase < UV_LOOP_PHASE_MAX; phase += 1) {
+    Record(phase, timing[phase]);
+    if (phase != UV_LOOP_PHASE_POLL_WAIT)
+      busy += timing[phase];
+  }
+  Record(kBusy, busy);
+  totals[kPhaseCount] += 1;
+}
+
+
+static void Start(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  int err = uv_loop_set_timing_cb(env->event_loop(), OnIteration);
+  args.GetReturnValue().Set(err);
+}
+
+
+static void Stop(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  int err = uv_loop_set_timing_cb(env->event_loop(), NULL);
+  args.GetReturnValue().Set(err);
+}
+
+
+static void Reset(const FunctionCallbackInfo<Value>& args) {
+  memset(histogram, 0, sizeof(histogram));
+  memset(totals, 0, sizeof(totals));
+}
+
+
+void Initialize(Handle<Object> target,
+                Handle<Value> unused,
+                Handle<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  NODE_SET_METHOD(target, "start", Start);
+  NODE_SET_METHOD(target, "stop", Stop);
+  NODE_SET_METHOD(target, "reset", Reset);
+
+  Local<Array> phases = Array::New(env->isolate(), kPhaseCount);
+  for (int i = 0; i < kPhaseCount; i += 1)
+    phases->Set(i, OneByteString(env->isolate(), phase_names[i]));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "phases"), phases);
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kBuckets"),
+              Integer::New(env->isolate(), kBuckets));
+
+  Local<Object> histogram_object = Object::New(env->isolate());
+  histogram_object->SetIndexedPropertiesToExternalArrayData(
+      histogram,
+      kExternalDoubleArray,
+      ARRAY_SIZE(histogram));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "histogram"),
+              histogram_object);
+
+  Local<Object> totals_object = Object::New(env->isolate());
+  totals_object->SetIndexedPropertiesToExternalArrayData(
+      totals,
+      kExternalDoubleArray,
+      ARRAY_SIZE(totals));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "totals"),
+              totals_object);
+}
+
+}  // namespace loop_timing
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(loop_timing, node::loop_timing::Initialize)
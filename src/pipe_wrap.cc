@@ -26,6 +26,7 @@
 #include "handle_wrap.h"
 #include "node.h"
 #include "node_buffer.h"
+#include "node_io_counters.h"
 #include "node_wrap.h"
 #include "req_wrap.h"
 #include "stream_wrap.h"
@@ -216,6 +217,7 @@ void PipeWrap::OnConnection(uv_stream_t* handle, int status) {
   uv_stream_t* client_handle = reinterpret_cast<uv_stream_t*>(&wrap->handle_);
   if (uv_accept(handle, client_handle))
     return;
+  io_counters::Count(io_counters::kPipeConnections);
 
   // Successful accept. Call the onconnection callback in JavaScript land.
   argv[1] = client_obj;
@@ -0,0 +1,188 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "slab_allocator.h"
+#include "node.h"
+#include "util.h"
+
+#include <assert.h>
+#include <stdlib.h>  // malloc(), free()
+
+namespace node {
+
+static inline size_t RoundUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+
+const size_t SlabAllocator::kDefaultSlabSize;
+
+
+SlabAllocator::SlabAllocator(size_t slab_size)
+    : slab_size_(slab_size),
+      current_(NULL),
+      slab_count_(0),
+      slab_bytes_(0),
+      used_bytes_(0),
+      chunk_count_(0),
+      total_slabs_(0),
+      total_chunks_(0) {
+  QUEUE_INIT(&slabs_);
+}
+
+
+SlabAllocator::~SlabAllocator() {
+  if (current_ != NULL) {
+    Slab* slab = current_;
+    current_ = NULL;
+    Unref(slab);
+  }
+
+  // Whatever is left is kept alive by chunks that have not been released
+  // yet. Detach them, they free themselves when their last chunk goes away.
+  while (!QUEUE_EMPTY(&slabs_)) {
+    QUEUE* q = QUEUE_HEAD(&slabs_);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);
+    QUEUE_DATA(q, Slab, member)->allocator = NULL;
+  }
+}
+
+
+char* SlabAllocator::Allocate(size_t size) {
+  Chunk* chunk;
+  size_t needed = sizeof(*chunk) + RoundUp(size, sizeof(*chunk));
+
+  Slab* slab;
+  if (needed > slab_size_) {
+    // Too big to share. Give it a slab of its own and leave current_ alone,
+    // the chunk takes over the reference so the slab goes with the chunk.
+    slab = NewSlab(needed);
+  } else {
+    if (current_ == NULL || current_->size - current_->offset < needed) {
+      Slab* old = current_;
+      current_ = NewSlab(slab_size_);
+      if (old != NULL)
+        Unref(old);
+    }
+    slab = current_;
+    slab->refs += 1;
+  }
+
+  chunk = reinterpret_cast<Chunk*>(slab->data() + slab->offset);
+  chunk->slab = slab;
+  slab->offset += needed;
+  slab->last = chunk->data();
+
+  used_bytes_ += needed;
+  chunk_count_ += 1;
+  total_chunks_ += 1;
+
+  return slab->last;
+}
+
+
+void SlabAllocator::Shrink(char* data, size_t size) {
+  Chunk* chunk = Chunk::From(data);
+  Slab* slab = chunk->slab;
+  assert(slab->allocator == this);
+
+  if (slab != current_ || slab->last != data)
+    return;
+
+  size_t offset = (data - slab->data()) + RoundUp(size, sizeof(*chunk));
+  assert(offset <= slab->offset);
+  used_bytes_ -= slab->offset - offset;
+  slab->offset = offset;
+}
+
+
+void SlabAllocator::GetStats(Stats* stats) const {
+  stats->slab_size = slab_size_;
+  stats->slabs = slab_count_;
+  stats->slab_bytes = slab_bytes_;
+  stats->used_bytes = used_bytes_;
+  stats->chunks = chunk_count_;
+  stats->total_slabs = total_slabs_;
+  stats->total_chunks = total_chunks_;
+}
+
+
+void SlabAllocator::Free(char* data, void* hint) {
+  Chunk* chunk = Chunk::From(data);
+  Slab* slab = chunk->slab;
+  SlabAllocator* allocator = slab->allocator;
+
+  if (allocator != NULL) {
+    allocator->chunk_count_ -= 1;
+
+    // Rewind when this is the most recent chunk of the current slab, that
+    // way the next allocation reuses its space.
+    if (slab == allocator->current_ && slab->last == data) {
+      size_t offset = reinterpret_cast<char*>(chunk) - slab->data();
+      allocator->used_bytes_ -= slab->offset - offset;
+      slab->offset = offset;
+      slab->last = NULL;
+    }
+  }
+
+  Unref(slab);
+}
+
+
+SlabAllocator::Slab* SlabAllocator::NewSlab(size_t size) {
+  Slab* slab = static_cast<Slab*>(malloc(sizeof(*slab) + size));
+  if (slab == NULL)
+    FatalError("node::SlabAllocator::NewSlab(size_t)", "Out Of Memory");
+
+  slab->allocator = this;
+  slab->size = size;
+  slab->offset = 0;
+  slab->last = NULL;
+  slab->refs = 1;  // Reference held by the allocator while it's current.
+  QUEUE_INSERT_TAIL(&slabs_, &slab->member);
+
+  slab_count_ += 1;
+  slab_bytes_ += size;
+  total_slabs_ += 1;
+
+  return slab;
+}
+
+
+void SlabAllocator::Unref(Slab* slab) {
+  assert(slab->refs > 0);
+  if (--slab->refs > 0)
+    return;
+
+  SlabAllocator* allocator = slab->allocator;
+  if (allocator != NULL) {
+    assert(allocator->current_ != slab);
+    allocator->slab_count_ -= 1;
+    allocator->slab_bytes_ -= slab->size;
+    allocator->used_bytes_ -= slab->offset;
+  }
+
+  QUEUE_REMOVE(&slab->member);
+  free(slab);
+}
+
+}  // namespace node
@@ -0,0 +1,110 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_SLAB_ALLOCATOR_H_
+#define SRC_SLAB_ALLOCATOR_H_
+
+#include "queue.h"
+#include "util.h"
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint64_t
+
+namespace node {
+
+// Carves read buffers out of large, shared slabs. Every chunk handed out
+// holds a reference on its slab; the slab is returned to the system once the
+// allocator has moved on to a newer slab and the last chunk pointing into it
+// has been released, usually from a smalloc free callback. Requests larger
+// than the slab size get a slab of their own that is freed with the chunk.
+class SlabAllocator {
+ public:
+  struct Stats {
+    size_t slab_size;
+    size_t slabs;
+    size_t slab_bytes;
+    size_t used_bytes;
+    size_t chunks;
+    uint64_t total_slabs;
+    uint64_t total_chunks;
+  };
+
+  static const size_t kDefaultSlabSize = 1024 * 1024;
+
+  explicit SlabAllocator(size_t slab_size = kDefaultSlabSize);
+  ~SlabAllocator();
+
+  // Reserve `size` bytes. The returned chunk is owned by the caller until it
+  // is passed to Free().
+  char* Allocate(size_t size);
+
+  // Give back the unused tail of a chunk. Only the most recently allocated
+  // chunk can actually be shrunk, for all others this is a no-op.
+  void Shrink(char* data, size_t size);
+
+  void GetStats(Stats* stats) const;
+
+  // Matches smalloc::FreeCallback, `hint` is ignored.
+  static void Free(char* data, void* hint = NULL);
+
+ private:
+  struct Slab {
+    SlabAllocator* allocator;  // NULL when the allocator has been destroyed.
+    QUEUE member;
+    size_t size;
+    size_t offset;
+    char* last;
+    unsigned int refs;
+
+    inline char* data() { return reinterpret_cast<char*>(this + 1); }
+  };
+
+  // Every chunk is prefixed with a pointer back to the slab it was carved
+  // from. That keeps Free() independent of the allocator, which is important
+  // because Buffers can outlive the allocator.
+  struct Chunk {
+    Slab* slab;
+
+    inline char* data() { return reinterpret_cast<char*>(this + 1); }
+    static inline Chunk* From(char* data) {
+      return reinterpret_cast<Chunk*>(data) - 1;
+    }
+  };
+
+  Slab* NewSlab(size_t size);
+  static void Unref(Slab* slab);
+
+  const size_t slab_size_;
+  Slab* current_;
+  QUEUE slabs_;
+  size_t slab_count_;
+  size_t slab_bytes_;
+  size_t used_bytes_;
+  size_t chunk_count_;
+  uint64_t total_slabs_;
+  uint64_t total_chunks_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlabAllocator);
+};
+
+}  // namespace node
+
+#endif  // SRC_SLAB_ALLOCATOR_H_
@@ -25,8 +25,10 @@
 #include "handle_wrap.h"
 #include "node_buffer.h"
 #include "node_counters.h"
+#include "node_io_counters.h"
 #include "pipe_wrap.h"
 #include "req_wrap.h"
+#include "slab_allocator.h"
 #include "tcp_wrap.h"
 #include "udp_wrap.h"
 #include "util.h"
@@ -46,6 +48,7 @@ using v8::FunctionCallbackInfo;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
 using v8::Number;
 using v8::Object;
@@ -56,6 +59,13 @@ using v8::Undefined;
 using v8::Value;
 
 
+void StreamWrap::Initialize(Handle<Object> target,
+                            Handle<Value> unused,
+                            Handle<Context> context) {
+  NODE_SET_METHOD(target, "getSlabStatistics", GetSlabStatistics);
+}
+
+
 StreamWrap::StreamWrap(Environment* env,
                        Local<Object> object,
                        uv_stream_t* stream,
@@ -157,6 +167,13 @@ void StreamWrap::OnReadCommon(uv_stream_t* handle,
     } else if (wrap->is_named_pipe()) {
       NODE_COUNT_PIPE_BYTES_RECV(nread);
     }
+    io_counters::CountStream(handle,
+                             io_counters::kTcpBytesRead,
+                             io_counters::kPipeBytesRead,
+                             nread);
+    io_counters::CountStream(handle,
+                             io_counters::kTcpReads,
+                             io_counters::kPipeReads);
   }
 
   wrap->callbacks()->DoRead(handle, nread, buf, pending);
@@ -194,6 +211,9 @@ void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
 
   StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+  io_counters::CountStream(wrap->stream(),
+                           io_counters::kTcpWrites,
+                           io_counters::kPipeWrites);
 
   assert(args[0]->IsObject());
   assert(Buffer::HasInstance(args[1]));
@@ -208,24 +228,40 @@ void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   uv_buf_t buf;
   WriteBuffer(buf_obj, &buf);
 
-  // Try writing immediately without allocation
+  // IPC pipes can send a handle along with the data, see WriteStringImpl().
+  uv_handle_t* send_handle = NULL;
+  Local<Object> send_handle_obj;
+  if (wrap->is_named_pipe_ipc() && args[2]->IsObject()) {
+    send_handle_obj = args[2].As<Object>();
+    send_handle = Unwrap<HandleWrap>(send_handle_obj)->GetHandle();
+  }
+
   uv_buf_t* bufs = &buf;
   size_t count = 1;
-  int err = wrap->callbacks()->TryWrite(&bufs, &count);
-  if (err != 0)
-    goto done;
-  if (count == 0)
-    goto done;
-  assert(count == 1);
+  int err;
+  if (send_handle == NULL) {
+    // Try writing immediately without allocation
+    err = wrap->callbacks()->TryWrite(&bufs, &count);
+    if (err != 0)
+      goto done;
+    if (count == 0)
+      goto done;
+    assert(count == 1);
+  }
 
   // Allocate, or write rest
   storage = new char[sizeof(WriteWrap)];
   req_wrap = new(storage) WriteWrap(env, req_wrap_obj, wrap);
 
+  if (send_handle != NULL) {
+    // Reference the handle to keep it alive until AfterWrite.
+    req_wrap->object()->Set(env->handle_string(), send_handle_obj);
+  }
+
   err = wrap->callbacks()->DoWrite(req_wrap,
                                    bufs,
                                    count,
-                                   NULL,
+                                   reinterpret_cast<uv_stream_t*>(send_handle),
                                    StreamWrap::AfterWrite);
   req_wrap->Dispatched();
   req_wrap_obj->Set(env->async(), True(env->isolate()));
@@ -252,6 +288,9 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
   int err;
 
   StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+  io_counters::CountStream(wrap->stream(),
+                           io_counters::kTcpWrites,
+                           io_counters::kPipeWrites);
 
   assert(args[0]->IsObject());
   assert(args[1]->IsString());
@@ -375,11 +414,30 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Upper bound for the encoded size of a writev() string chunk. It's exact
+// except for UTF-8, where a one-byte string takes at most two bytes per
+// character and anything else three. Long UTF-8 strings are measured instead
+// so they don't claim three times their size.
+static size_t WritevStorageSize(Isolate* isolate,
+                                Local<String> string,
+                                enum encoding encoding) {
+  if (encoding != UTF8)
+    return StringBytes::StorageSize(isolate, string, encoding);
+  const size_t length = string->Length();
+  if (length > 65535)
+    return StringBytes::Size(isolate, string, encoding);
+  return (string->IsOneByte() ? 2 : 3) * length;
+}
+
+
 void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
   HandleScope handle_scope(args.GetIsolate());
   Environment* env = Environment::GetCurrent(args.GetIsolate());
 
   StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+  io_counters::CountStream(wrap->stream(),
+                           io_counters::kTcpWrites,
+                           io_counters::kPipeWrites);
 
   assert(args[0]->IsObject());
   assert(args[1]->IsArray());
@@ -388,100 +446,132 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
   Local<Array> chunks = args[1].As<Array>();
   size_t count = chunks->Length() >> 1;
 
+  struct StringChunk {
+    Local<String> string;
+    enum encoding encoding;
+  };
+
   uv_buf_t bufs_[16];
+  StringChunk strings_[ARRAY_SIZE(bufs_)];
   uv_buf_t* bufs = bufs_;
+  StringChunk* strings = strings_;
+  if (ARRAY_SIZE(bufs_) < count) {
+    bufs = new uv_buf_t[count];
+    strings = new StringChunk[count];
+  }
 
-  // Determine storage size first
+  // Look at every chunk once: Buffers are used in place, strings are sized
+  // up so they can all be encoded into a single slab chunk. Batches tend to
+  // repeat the same encoding, don't parse it again every time.
+  Local<Value> last_encoding_v;
+  enum encoding last_encoding = UTF8;
   size_t storage_size = 0;
+  uint32_t bytes = 0;
   for (size_t i = 0; i < count; i++) {
-    Handle<Value> chunk = chunks->Get(i * 2);
+    Local<Value> chunk = chunks->Get(i * 2);
 
-    if (Buffer::HasInstance(chunk))
+    if (Buffer::HasInstance(chunk)) {
+      bufs[i] = uv_buf_init(Buffer::Data(chunk), Buffer::Length(chunk));
+      bytes += bufs[i].len;
       continue;
-      // Buffer chunk, no additional storage required
-
-    // String chunk
-    Handle<String> string = chunk->ToString();
-    enum encoding encoding = ParseEncoding(env->isolate(),
-                                           chunks->Get(i * 2 + 1));
-    size_t chunk_size;
-    if (encoding == UTF8 && string->Length() > 65535)
-      chunk_size = StringBytes::Size(env->isolate(), string, encoding);
-    else
-      chunk_size = StringBytes::StorageSize(env->isolate(), string, encoding);
-
-    storage_size += chunk_size + 15;
-  }
+    }
 
-  if (storage_size > INT_MAX) {
-    args.GetReturnValue().Set(UV_ENOBUFS);
-    return;
-  }
+    // Filled in once the strings are encoded, left empty if none of them
+    // needs any storage.
+    bufs[i] = uv_buf_init(NULL, 0);
+    Local<Value> encoding_v = chunks->Get(i * 2 + 1);
+    if (last_encoding_v.IsEmpty() ||
+        !encoding_v->StrictEquals(last_encoding_v)) {
+      last_encoding = ParseEncoding(env->isolate(), encoding_v);
+      last_encoding_v = encoding_v;
+    }
 
-  if (ARRAY_SIZE(bufs_) < count)
-    bufs = new uv_buf_t[count];
+    strings[i].string = chunk->ToString();
+    strings[i].encoding = last_encoding;
+    storage_size += WritevStorageSize(env->isolate(),
+                                      strings[i].string,
+                                      last_encoding);
+    // UCS2 is written as uint16_t, leave room to align it.
+    if (last_encoding == UCS2)
+      storage_size += 1;
+  }
 
-  storage_size += sizeof(WriteWrap);
-  char* storage = new char[storage_size];
-  WriteWrap* req_wrap =
-      new(storage) WriteWrap(env, req_wrap_obj, wrap);
+  int err = 0;
+  char* storage;
+  WriteWrap* req_wrap;
+  char* slab_data = NULL;
+  uv_buf_t* vbufs = bufs;
+  size_t vcount = count;
 
-  uint32_t bytes = 0;
-  size_t offset = sizeof(WriteWrap);
-  for (size_t i = 0; i < count; i++) {
-    Handle<Value> chunk = chunks->Get(i * 2);
+  if (storage_size > INT_MAX) {
+    err = UV_ENOBUFS;
+    goto done;
+  }
 
-    // Write buffer
-    if (Buffer::HasInstance(chunk)) {
-      bufs[i].base = Buffer::Data(chunk);
-      bufs[i].len = Buffer::Length(chunk);
-      bytes += bufs[i].len;
-      continue;
+  if (storage_size > 0) {
+    SlabAllocator* allocator = env->write_slab_allocator();
+    slab_data = allocator->Allocate(storage_size);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (strings[i].string.IsEmpty())
+        continue;
+      if (strings[i].encoding == UCS2)
+        offset = ROUND_UP(offset, sizeof(uint16_t));
+      size_t str_size = StringBytes::Write(env->isolate(),
+                                           slab_data + offset,
+                                           storage_size - offset,
+                                           strings[i].string,
+                                           strings[i].encoding);
+      bufs[i] = uv_buf_init(slab_data + offset, str_size);
+      offset += str_size;
+      bytes += str_size;
     }
 
-    // Write string
-    offset = ROUND_UP(offset, 16);
-    assert(offset < storage_size);
-    char* str_storage = storage + offset;
-    size_t str_size = storage_size - offset;
-
-    Handle<String> string = chunk->ToString();
-    enum encoding encoding = ParseEncoding(env->isolate(),
-                                           chunks->Get(i * 2 + 1));
-    str_size = StringBytes::Write(env->isolate(),
-                                  str_storage,
-                                  str_size,
-                                  string,
-                                  encoding);
-    bufs[i].base = str_storage;
-    bufs[i].len = str_size;
-    offset += str_size;
-    bytes += str_size;
+    allocator->Shrink(slab_data, offset);
   }
 
-  int err = wrap->callbacks()->DoWrite(req_wrap,
-                                       bufs,
-                                       count,
-                                       NULL,
-                                       StreamWrap::AfterWrite);
+  // Try writing immediately, most batches fit in the socket buffer and the
+  // slab chunk can be given back right away.
+  err = wrap->callbacks()->TryWrite(&vbufs, &vcount);
+  if (err != 0 || vcount == 0)
+    goto done;
+
+  // Write the rest. The strings stay in the slab until AfterWrite, Buffers
+  // are kept alive by the JS side.
+  storage = new char[sizeof(WriteWrap)];
+  req_wrap = new(storage) WriteWrap(env, req_wrap_obj, wrap);
+  req_wrap->set_slab_data(slab_data);
+  slab_data = NULL;
 
-  // Deallocate space
-  if (bufs != bufs_)
-    delete[] bufs;
+  err = wrap->callbacks()->DoWrite(req_wrap,
+                                   vbufs,
+                                   vcount,
+                                   NULL,
+                                   StreamWrap::AfterWrite);
 
   req_wrap->Dispatched();
   req_wrap->object()->Set(env->async(), True(env->isolate()));
-  req_wrap->object()->Set(env->bytes_string(),
-                          Number::New(env->isolate(), bytes));
-  const char* msg = wrap->callbacks()->Error();
-  if (msg != NULL)
-    req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
 
   if (err) {
     req_wrap->~WriteWrap();
     delete[] storage;
   }
 
+ done:
+  if (slab_data != NULL)
+    SlabAllocator::Free(slab_data);
+
+  if (bufs != bufs_) {
+    delete[] bufs;
+    delete[] strings;
+  }
+
+  const char* msg = wrap->callbacks()->Error();
+  if (msg != NULL)
+    req_wrap_obj->Set(env->error_string(), OneByteString(env->isolate(), msg));
+  req_wrap_obj->Set(env->bytes_string(),
+                    Number::New(env->isolate(), bytes));
   args.GetReturnValue().Set(err);
 }
 
@@ -516,6 +606,29 @@ void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(err);
 }
 
+void StreamWrap::GetSlabStatistics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  SlabAllocator::Stats s;
+  env->read_slab_allocator()->GetStats(&s);
+
+  Local<Object> info = Object::New(env->isolate());
+#define V(name)                                                               \
+  info->Set(env->name ## _string(),                                           \
+            Number::New(env->isolate(), static_cast<double>(s.name)))
+  V(slab_size);
+  V(slabs);
+  V(slab_bytes);
+  V(used_bytes);
+  V(chunks);
+  V(total_slabs);
+  V(total_chunks);
+#undef V
+  args.GetReturnValue().Set(info);
+}
+
+
 void StreamWrap::AfterWrite(uv_write_t* req, int status) {
   WriteWrap* req_wrap = ContainerOf(&WriteWrap::req_, req);
   StreamWrap* wrap = req_wrap->wrap();
@@ -617,6 +730,11 @@ int StreamWrapCallbacks::TryWrite(uv_buf_t** bufs, size_t* count) {
   if (err < 0)
     return err;
 
+  io_counters::CountStream(wrap()->stream(),
+                           io_counters::kTcpBytesWritten,
+                           io_counters::kPipeBytesWritten,
+                           err);
+
   // Slice off the buffers: skip all written buffers and slice the one that
   // was partially written.
   written = err;
@@ -662,6 +780,10 @@ int StreamWrapCallbacks::DoWrite(WriteWrap* w,
     } else if (wrap()->stream()->type == UV_NAMED_PIPE) {
       NODE_COUNT_PIPE_BYTES_SENT(bytes);
     }
+    io_counters::CountStream(wrap()->stream(),
+                             io_counters::kTcpBytesWritten,
+                             io_counters::kPipeBytesWritten,
+                             bytes);
   }
 
   wrap()->UpdateWriteQueueSize();
@@ -678,14 +800,9 @@ void StreamWrapCallbacks::AfterWrite(WriteWrap* w) {
 void StreamWrapCallbacks::DoAlloc(uv_handle_t* handle,
                                   size_t suggested_size,
                                   uv_buf_t* buf) {
-  buf->base = static_cast<char*>(malloc(suggested_size));
+  SlabAllocator* allocator = wrap()->env()->read_slab_allocator();
+  buf->base = allocator->Allocate(suggested_size);
   buf->len = suggested_size;
-
-  if (buf->base == NULL && suggested_size > 0) {
-    FatalError(
-        "node::StreamWrapCallbacks::DoAlloc(uv_handle_t*, size_t, uv_buf_t*)",
-        "Out Of Memory");
-  }
 }
 
 
@@ -705,20 +822,20 @@ void StreamWrapCallbacks::DoRead(uv_stream_t* handle,
 
   if (nread < 0)  {
     if (buf->base != NULL)
-      free(buf->base);
+      SlabAllocator::Free(buf->base);
     wrap()->MakeCallback(env->onread_string(), ARRAY_SIZE(argv), argv);
     return;
   }
 
   if (nread == 0) {
     if (buf->base != NULL)
-      free(buf->base);
+      SlabAllocator::Free(buf->base);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
   assert(static_cast<size_t>(nread) <= buf->len);
-  argv[1] = Buffer::Use(env, base, nread);
+  env->read_slab_allocator()->Shrink(buf->base, nread);
+  argv[1] = Buffer::New(env, buf->base, nread, SlabAllocator::Free, NULL);
 
   Local<Object> pending_obj;
   if (pending == UV_TCP) {
@@ -744,3 +861,5 @@ int StreamWrapCallbacks::DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb) {
 }
 
 }  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(stream_wrap, node::StreamWrap::Initialize)
@@ -41,7 +41,13 @@ class WriteWrap: public ReqWrap<uv_write_t> {
   // into the same provider. How should these be broken apart?
   WriteWrap(Environment* env, v8::Local<v8::Object> obj, StreamWrap* wrap)
       : ReqWrap<uv_write_t>(env, obj),
-        wrap_(wrap) {
+        wrap_(wrap),
+        slab_data_(NULL) {
+  }
+
+  ~WriteWrap() {
+    if (slab_data_ != NULL)
+      SlabAllocator::Free(slab_data_);
   }
 
   void* operator new(size_t size, char* storage) { return storage; }
@@ -54,6 +60,12 @@ class WriteWrap: public ReqWrap<uv_write_t> {
     return wrap_;
   }
 
+  // Hands a chunk from Environment::write_slab_allocator() to the request,
+  // it's released together with the request.
+  inline void set_slab_data(char* data) {
+    slab_data_ = data;
+  }
+
  private:
   // People should not be using the non-placement new and delete operator on a
   // WriteWrap. Ensure this never happens.
@@ -61,6 +73,7 @@ class WriteWrap: public ReqWrap<uv_write_t> {
   void operator delete(void* ptr) { assert(0); }
 
   StreamWrap* const wrap_;
+  char* slab_data_;
 };
 
 // Overridable callbacks' types
@@ -113,6 +126,10 @@ class StreamWrap : public HandleWrap {
       delete old;
   }
 
+  static void Initialize(v8::Handle<v8::Object> target,
+                         v8::Handle<v8::Value> unused,
+                         v8::Handle<v8::Context> context);
+
   static void GetFD(v8::Local<v8::String>,
                     const v8::PropertyCallbackInfo<v8::Value>&);
 
@@ -131,6 +148,9 @@ class StreamWrap : public HandleWrap {
 
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  static void GetSlabStatistics(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+
   inline StreamWrapCallbacks* callbacks() const {
     return callbacks_;
   }
@@ -20,6 +20,7 @@
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "string_bytes.h"
+#include "string_bytes_simd.h"
 
 #include "node.h"
 #include "node_buffer.h"
@@ -113,6 +114,40 @@ typedef ExternString<String::ExternalStringResource,
                      uint16_t> ExternTwoByteString;
 
 
+// Like String::Value but for strings that V8 keeps as one-byte data, which
+// makes the copy half the size and lets the decoders use their vectorized
+// paths.
+class OneByteValue {
+ public:
+  explicit OneByteValue(Handle<String> string)
+      : length_(string->Length()),
+        data_(length_ <= sizeof(storage_) ? storage_ : new char[length_]) {
+    string->WriteOneByte(reinterpret_cast<uint8_t*>(data_),
+                         0,
+                         length_,
+                         String::NO_NULL_TERMINATION);
+  }
+
+  ~OneByteValue() {
+    if (data_ != storage_)
+      delete[] data_;
+  }
+
+  const char* operator*() const {
+    return data_;
+  }
+
+  size_t length() const {
+    return length_;
+  }
+
+ private:
+  size_t length_;
+  char* data_;
+  char storage_[1024];
+};
+
+
 //// Base 64 ////
 
 #define base64_encoded_size(size) ((size + 2 - ((size + 2) % 3)) / 3 * 4)
@@ -136,19 +171,6 @@ static inline size_t base64_decoded_size_fast(size_t size) {
   return size;
 }
 
-template <typename TypeName>
-size_t base64_decoded_size(const TypeName* src, size_t size) {
-  if (size == 0)
-    return 0;
-
-  if (src[size - 1] == '=')
-    size--;
-  if (size > 0 && src[size - 1] == '=')
-    size--;
-
-  return base64_decoded_size_fast(size);
-}
-
 
 // supports regular and URL-safe base64
 static const int unbase64_table[] =
@@ -173,10 +195,10 @@ static const int unbase64_table[] =
 
 
 template <typename TypeName>
-size_t base64_decode(char* buf,
-                     size_t len,
-                     const TypeName* src,
-                     const size_t srcLen) {
+size_t base64_decode_slow(char* buf,
+                          size_t len,
+                          const TypeName* src,
+                          const size_t srcLen) {
   char a, b, c, d;
   char* dst = buf;
   char* dstEnd = buf + len;
@@ -224,6 +246,56 @@ size_t base64_decode(char* buf,
 }
 
 
+static inline size_t base64_decode_vector(char* buf,
+                                          size_t len,
+                                          const char* src,
+                                          size_t srcLen,
+                                          size_t* written) {
+  return simd::Base64Decode(src, srcLen, buf, len, written);
+}
+
+
+template <typename TypeName>
+static inline size_t base64_decode_vector(char* buf,
+                                          size_t len,
+                                          const TypeName* src,
+                                          size_t srcLen,
+                                          size_t* written) {
+  *written = 0;
+  return 0;
+}
+
+
+// Takes groups of four valid characters for as long as there are any and
+// leaves padding, whitespace and other oddities to base64_decode_slow().
+template <typename TypeName>
+size_t base64_decode(char* buf,
+                     size_t len,
+                     const TypeName* src,
+                     const size_t srcLen) {
+  size_t k;
+  size_t i = base64_decode_vector(buf, len, src, srcLen, &k);
+
+  const size_t max_i = srcLen / 4 * 4;
+  const size_t max_k = len / 3 * 3;
+  while (i < max_i && k < max_k) {
+    const int a = unbase64(src[i + 0]);
+    const int b = unbase64(src[i + 1]);
+    const int c = unbase64(src[i + 2]);
+    const int d = unbase64(src[i + 3]);
+    if ((a | b | c | d) < 0)
+      break;
+    buf[k + 0] = (a << 2) | (b >> 4);
+    buf[k + 1] = (b << 4) | (c >> 2);
+    buf[k + 2] = (c << 6) | d;
+    i += 4;
+    k += 3;
+  }
+
+  return k + base64_decode_slow(buf + k, len - k, src + i, srcLen - i);
+}
+
+
 //// HEX ////
 
 template <typename TypeName>
@@ -238,13 +310,32 @@ unsigned hex2bin(TypeName c) {
 }
 
 
+static inline size_t hex_decode_vector(char* buf,
+                                       size_t len,
+                                       const char* src,
+                                       size_t srcLen) {
+  return simd::HexDecode(src, srcLen, buf, len) / 2;
+}
+
+
+template <typename TypeName>
+static inline size_t hex_decode_vector(char* buf,
+                                       size_t len,
+                                       const TypeName* src,
+                                       size_t srcLen) {
+  return 0;
+}
+
+
 template <typename TypeName>
 size_t hex_decode(char* buf,
                   size_t len,
                   const TypeName* src,
                   const size_t srcLen) {
   size_t i;
-  for (i = 0; i < len && i * 2 + 1 < srcLen; ++i) {
+  for (i = hex_decode_vector(buf, len, src, srcLen);
+       i < len && i * 2 + 1 < srcLen;
+       ++i) {
     unsigned a = hex2bin(src[i * 2 + 0]);
     unsigned b = hex2bin(src[i * 2 + 1]);
     if (!~a || !~b)
@@ -334,7 +425,9 @@ size_t StringBytes::Write(Isolate* isolate,
       break;
 
     case UCS2:
-      if (is_extern)
+      // IsExternal() is only true for two byte strings, one byte ones
+      // are widened by String::Write().
+      if (is_extern && str->IsExternal())
         memcpy(buf, data, len * 2);
       else
         len = str->Write(reinterpret_cast<uint16_t*>(buf), 0, buflen, flags);
@@ -356,6 +449,9 @@ size_t StringBytes::Write(Isolate* isolate,
     case BASE64:
       if (is_extern) {
         len = base64_decode(buf, buflen, data, extlen);
+      } else if (str->IsOneByte()) {
+        OneByteValue value(str);
+        len = base64_decode(buf, buflen, *value, value.length());
       } else {
         String::Value value(str);
         len = base64_decode(buf, buflen, *value, value.length());
@@ -368,6 +464,9 @@ size_t StringBytes::Write(Isolate* isolate,
     case HEX:
       if (is_extern) {
         len = hex_decode(buf, buflen, data, extlen);
+      } else if (str->IsOneByte()) {
+        OneByteValue value(str);
+        len = hex_decode(buf, buflen, *value, value.length());
       } else {
         String::Value value(str);
         len = hex_decode(buf, buflen, *value, value.length());
@@ -480,8 +579,17 @@ size_t StringBytes::Size(Isolate* isolate,
       break;
 
     case BASE64: {
-      String::Value value(str);
-      data_size = base64_decoded_size(*value, value.length());
+      // Only the padding matters, don't copy out the whole string for it.
+      uint16_t tail[2];
+      size_t length = str->Length();
+      int n = length < 2 ? length : 2;
+      str->Write(tail, length - n, n, String::NO_NULL_TERMINATION);
+      if (n > 0 && tail[n - 1] == '=') {
+        length--;
+        if (n > 1 && tail[n - 2] == '=')
+          length--;
+      }
+      data_size = base64_decoded_size_fast(length);
       break;
     }
 
@@ -510,6 +618,10 @@ static bool contains_non_ascii_slow(const char* buf, size_t len) {
 
 
 static bool contains_non_ascii(const char* src, size_t len) {
+  const size_t prefix = simd::AsciiPrefix(src, len);
+  src += prefix;
+  len -= prefix;
+
   if (len < 16) {
     return contains_non_ascii_slow(src, len);
   }
@@ -552,6 +664,143 @@ static bool contains_non_ascii(const char* src, size_t len) {
 }
 
 
+enum utf8_kind {
+  UTF8_ASCII,     // Nothing but ASCII.
+  UTF8_ONE_BYTE,  // Well-formed, no character above U+00FF.
+  UTF8_TWO_BYTE,  // Well-formed.
+  UTF8_INVALID    // Needs replacement characters or has encoded surrogates.
+};
+
+
+static utf8_kind classify_utf8(const char* src, size_t len) {
+  unsigned max = 0;
+  size_t i = simd::Utf8Validate(src, len, &max);
+
+  while (i < len) {
+    const unsigned c = static_cast<unsigned char>(src[i]);
+    if (c < 0x80) {
+      const size_t n = simd::AsciiPrefix(src + i, len - i);
+      i += n > 0 ? n : 1;
+      continue;
+    }
+
+    // The second byte is where overlong forms, surrogates and code points
+    // above U+10FFFF give themselves away.
+    size_t n;
+    unsigned lo = 0x80;
+    unsigned hi = 0xbf;
+    if (c < 0xc2) {
+      return UTF8_INVALID;
+    } else if (c < 0xe0) {
+      n = 2;
+    } else if (c < 0xf0) {
+      n = 3;
+      if (c == 0xe0)
+        lo = 0xa0;
+      else if (c == 0xed)
+        hi = 0x9f;
+    } else if (c < 0xf5) {
+      n = 4;
+      if (c == 0xf0)
+        lo = 0x90;
+      else if (c == 0xf4)
+        hi = 0x8f;
+    } else {
+      return UTF8_INVALID;
+    }
+
+    if (n > len - i)
+      return UTF8_INVALID;
+    const unsigned c1 = static_cast<unsigned char>(src[i + 1]);
+    if (c1 < lo || c1 > hi)
+      return UTF8_INVALID;
+    for (size_t k = 2; k < n; k++) {
+      if ((src[i + k] & 0xc0) != 0x80)
+        return UTF8_INVALID;
+    }
+
+    if (c > max)
+      max = c;
+    i += n;
+  }
+
+  if (max < 0x80)
+    return UTF8_ASCII;
+  // Two byte sequences that start with 0xc2 or 0xc3 are U+0080 to U+00FF.
+  if (max < 0xc4)
+    return UTF8_ONE_BYTE;
+  return UTF8_TWO_BYTE;
+}
+
+
+// Decodes UTF-8 that classify_utf8() said is UTF8_ONE_BYTE. dst must have
+// room for len bytes.
+static size_t utf8_decode_one_byte(const char* src, size_t len, char* dst) {
+  size_t i = 0;
+  size_t k = 0;
+  while (i < len) {
+    const unsigned c = static_cast<unsigned char>(src[i]);
+    if (c < 0x80) {
+      const size_t n = simd::AsciiCopy(src + i, len - i, dst + k);
+      if (n == 0) {
+        dst[k++] = c;
+        i += 1;
+      } else {
+        k += n;
+        i += n;
+      }
+      continue;
+    }
+    dst[k++] = ((c & 0x1f) << 6) | (src[i + 1] & 0x3f);
+    i += 2;
+  }
+  return k;
+}
+
+
+// Decodes UTF-8 that classify_utf8() said is well-formed. dst must have
+// room for len characters.
+static size_t utf8_decode_two_byte(const char* src,
+                                   size_t len,
+                                   uint16_t* dst) {
+  size_t i = 0;
+  size_t k = 0;
+  while (i < len) {
+    const unsigned c = static_cast<unsigned char>(src[i]);
+    if (c < 0x80) {
+      const size_t n = simd::AsciiWiden(src + i, len - i, dst + k);
+      if (n == 0) {
+        dst[k++] = c;
+        i += 1;
+      } else {
+        k += n;
+        i += n;
+      }
+      continue;
+    }
+
+    const unsigned c1 = src[i + 1] & 0x3f;
+    if (c < 0xe0) {
+      dst[k++] = ((c & 0x1f) << 6) | c1;
+      i += 2;
+    } else if (c < 0xf0) {
+      const unsigned c2 = src[i + 2] & 0x3f;
+      dst[k++] = ((c & 0x0f) << 12) | (c1 << 6) | c2;
+      i += 3;
+    } else {
+      const unsigned c2 = src[i + 2] & 0x3f;
+      const unsigned c3 = src[i + 3] & 0x3f;
+      const unsigned cp =
+          (((c & 0x07) << 18) | (c1 << 12) | (c2 << 6) | c3) - 0x10000;
+      dst[k++] = 0xd800 | (cp >> 10);
+      dst[k++] = 0xdc00 | (cp & 0x3ff);
+      i += 4;
+    }
+  }
+  return k;
+}
+
+
 static void force_ascii_slow(const char* src, char* dst, size_t len) {
   for (size_t i = 0; i < len; ++i) {
     dst[i] = src[i] & 0x7f;
@@ -626,8 +875,8 @@ static size_t base64_encode(const char* src,
                               "abcdefghijklmnopqrstuvwxyz"
                               "0123456789+/";
 
-  i = 0;
-  k = 0;
+  i = simd::Base64Encode(src, slen, dst);
+  k = i / 3 * 4;
   n = slen / 3 * 3;
 
   while (i < n) {
@@ -675,7 +924,9 @@ static size_t hex_encode(const char* src, size_t slen, char* dst, size_t dlen) {
       "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (uint32_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  for (size_t i = simd::HexEncode(src, slen, dst), k = 2 * i;
+       k < dlen;
+       i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -721,10 +972,47 @@ Local<Value> StringBytes::Encode(Isolate* isolate,
       break;
 
     case UTF8:
-      val = String::NewFromUtf8(isolate,
-                                buf,
-                                String::kNormalString,
-                                buflen);
+      // V8 would scan the input once for the length and once more to
+      // decode it. One pass tells which kind of string it is going to be
+      // and how it can be built fastest.
+      switch (classify_utf8(buf, buflen)) {
+        case UTF8_ASCII:
+          if (buflen < EXTERN_APEX)
+            val = OneByteString(isolate, buf, buflen);
+          else
+            val = ExternOneByteString::NewFromCopy(isolate, buf, buflen);
+          break;
+
+        // Not external strings, Write() and fs.writeSync() would hand
+        // their contents back out as is instead of as UTF-8.
+        case UTF8_ONE_BYTE: {
+          char* out = new char[buflen];
+          size_t len = utf8_decode_one_byte(buf, buflen, out);
+          val = OneByteString(isolate, out, len);
+          delete[] out;
+          break;
+        }
+
+        case UTF8_TWO_BYTE: {
+          uint16_t* out = new uint16_t[buflen];
+          size_t len = utf8_decode_two_byte(buf, buflen, out);
+          val = String::NewFromTwoByte(isolate,
+                                       out,
+                                       String::kNormalString,
+                                       len);
+          delete[] out;
+          break;
+        }
+
+        case UTF8_INVALID:
+          // Replacement characters, and the lone surrogates that
+          // StringDecoder relies on for CESU-8, are V8's business.
+          val = String::NewFromUtf8(isolate,
+                                    buf,
+                                    String::kNormalString,
+                                    buflen);
+          break;
+      }
       break;
 
     case BINARY:
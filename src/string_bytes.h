@@ -46,8 +46,7 @@ class StringBytes {
                             v8::Handle<v8::Value> val,
                             enum encoding enc);
 
-  // Precise byte count, but slightly slower for Base64 and
-  // very much slower for UTF-8
+  // Precise byte count, but very much slower for UTF-8
   static size_t Size(v8::Isolate* isolate,
                      v8::Handle<v8::Value> val,
                      enum encoding enc);
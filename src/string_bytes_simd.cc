@@ -0,0 +1,939 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "string_bytes_simd.h"
+
+#include <stdint.h>
+#include <string.h>  // memcpy()
+
+// SSE2 is part of x86-64, it's used unconditionally when the compiler says
+// it's there. AVX2 isn't, those kernels are compiled with the target
+// attribute and picked at run time.
+#if defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define NODE_HAVE_SSE2 1
+# include <emmintrin.h>
+#endif
+
+#if defined(NODE_HAVE_SSE2) &&                                                \
+    (defined(__x86_64__) || defined(__i386__)) &&                             \
+    ((defined(__clang__) &&                                                   \
+      (__clang_major__ > 3 ||                                                 \
+       (__clang_major__ == 3 && __clang_minor__ >= 8))) ||                    \
+     (!defined(__clang__) && defined(__GNUC__) &&                             \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+# define NODE_HAVE_AVX2 1
+# define NODE_TARGET_AVX2 __attribute__((target("avx2")))
+# include <immintrin.h>
+#endif
+
+#if defined(NODE_HAVE_SSE2) && defined(_MSC_VER)
+# include <intrin.h>  // _BitScanForward()
+#endif
+
+namespace node {
+namespace simd {
+
+#if defined(NODE_HAVE_AVX2)
+static bool HaveAVX2() {
+  // Racy but idempotent, every thread computes the same thing.
+  static int have_avx2 = -1;
+  if (have_avx2 == -1)
+    have_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  return have_avx2 == 1;
+}
+#endif
+
+
+#if defined(NODE_HAVE_SSE2)
+
+static inline int Load32(const char* p) {
+  int32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+
+// Maps 6 bit values to the characters of the standard base64 alphabet.
+static inline __m128i Base64Chars(__m128i v) {
+  __m128i offset = _mm_set1_epi8('A');
+  offset = _mm_add_epi8(offset,
+      _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(25)),
+                    _mm_set1_epi8('a' - 26 - 'A')));
+  offset = _mm_add_epi8(offset,
+      _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(51)),
+                    _mm_set1_epi8('0' - 52 - ('a' - 26))));
+  offset = _mm_add_epi8(offset,
+      _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(62)),
+                    _mm_set1_epi8('+' - 62 - ('0' - 52))));
+  offset = _mm_add_epi8(offset,
+      _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(63)),
+                    _mm_set1_epi8('/' - 63 - ('0' - 52))));
+  return _mm_add_epi8(v, offset);
+}
+
+
+// Sets every byte of the mask where lo <= c <= hi. Characters above 0x7f
+// compare as negative and never match.
+static inline __m128i InRange(__m128i c, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(lo - 1)),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), c));
+}
+
+
+static inline __m128i Equal(__m128i c, char x) {
+  return _mm_cmpeq_epi8(c, _mm_set1_epi8(x));
+}
+
+
+// Maps characters from either base64 alphabet to their 6 bit values. Returns
+// false if any of them is something else.
+static inline bool Base64Values(__m128i c, __m128i* values) {
+  const __m128i upper = InRange(c, 'A', 'Z');
+  const __m128i lower = InRange(c, 'a', 'z');
+  const __m128i digit = InRange(c, '0', '9');
+  const __m128i plus = Equal(c, '+');
+  const __m128i minus = Equal(c, '-');
+  const __m128i slash = Equal(c, '/');
+  const __m128i underscore = Equal(c, '_');
+
+  const __m128i valid =
+      _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower),
+                                _mm_or_si128(digit, plus)),
+                   _mm_or_si128(_mm_or_si128(minus, slash), underscore));
+  if (_mm_movemask_epi8(valid) != 0xffff)
+    return false;
+
+  __m128i offset = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+  offset = _mm_or_si128(offset,
+                        _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+  offset = _mm_or_si128(offset,
+                        _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+  offset = _mm_or_si128(offset,
+                        _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+  offset = _mm_or_si128(offset,
+                        _mm_and_si128(minus, _mm_set1_epi8(62 - '-')));
+  offset = _mm_or_si128(offset,
+                        _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+  offset = _mm_or_si128(offset,
+                        _mm_and_si128(underscore, _mm_set1_epi8(63 - '_')));
+  *values = _mm_add_epi8(c, offset);
+  return true;
+}
+
+
+static inline __m128i HexChars(__m128i v) {
+  const __m128i letters = _mm_cmpgt_epi8(v, _mm_set1_epi8(9));
+  const __m128i offset =
+      _mm_add_epi8(_mm_set1_epi8('0'),
+                   _mm_and_si128(letters, _mm_set1_epi8('a' - 10 - '0')));
+  return _mm_add_epi8(v, offset);
+}
+
+
+static inline bool HexValues(__m128i c, __m128i* values) {
+  const __m128i digit = InRange(c, '0', '9');
+  const __m128i upper = InRange(c, 'A', 'F');
+  const __m128i lower = InRange(c, 'a', 'f');
+
+  const __m128i valid = _mm_or_si128(_mm_or_si128(digit, upper), lower);
+  if (_mm_movemask_epi8(valid) != 0xffff)
+    return false;
+
+  __m128i offset = _mm_and_si128(digit, _mm_set1_epi8(-'0'));
+  offset = _mm_or_si128(offset,
+                        _mm_and_si128(upper, _mm_set1_epi8(10 - 'A')));
+  offset = _mm_or_si128(offset,
+                        _mm_and_si128(lower, _mm_set1_epi8(10 - 'a')));
+  *values = _mm_add_epi8(c, offset);
+  return true;
+}
+
+
+// Pairs of nibbles, high one first, to bytes in the low half of each 16 bit
+// lane.
+static inline __m128i HexPairs(__m128i v) {
+  return _mm_or_si128(
+      _mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0xff)), 4),
+      _mm_srli_epi16(v, 8));
+}
+
+
+// 12 bytes in, 16 characters out. Reads 16 bytes.
+static size_t Base64Encode_SSE2(const char* src, size_t slen, char* dst) {
+  const __m128i lo8 = _mm_set1_epi32(0xff);
+  const __m128i mid8 = _mm_set1_epi32(0xff00);
+  const __m128i lo6 = _mm_set1_epi32(0x3f);
+  size_t i = 0;
+  size_t k = 0;
+  for (; i + 16 <= slen; i += 12, k += 16) {
+    // Three input bytes a, b, c in each 32 bit lane, then as a 24 bit
+    // big endian number, then split into four 6 bit values.
+    const __m128i in = _mm_setr_epi32(Load32(src + i + 0),
+                                      Load32(src + i + 3),
+                                      Load32(src + i + 6),
+                                      Load32(src + i + 9));
+    const __m128i w =
+        _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(in, lo8), 16),
+                                  _mm_and_si128(in, mid8)),
+                     _mm_and_si128(_mm_srli_epi32(in, 16), lo8));
+    __m128i v = _mm_and_si128(_mm_srli_epi32(w, 18), lo6);
+    v = _mm_or_si128(v,
+        _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(w, 12), lo6), 8));
+    v = _mm_or_si128(v,
+        _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(w, 6), lo6), 16));
+    v = _mm_or_si128(v, _mm_slli_epi32(_mm_and_si128(w, lo6), 24));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), Base64Chars(v));
+  }
+  return i;
+}
+
+
+// 16 characters in, 12 bytes out. Writes 16 bytes.
+static size_t Base64Decode_SSE2(const char* src,
+                                size_t slen,
+                                char* dst,
+                                size_t dlen,
+                                size_t* written) {
+  const __m128i lo8 = _mm_set1_epi32(0xff);
+  const __m128i mid8 = _mm_set1_epi32(0xff00);
+  size_t i = 0;
+  size_t k = 0;
+  for (; i + 16 <= slen && k + 16 <= dlen; i += 16, k += 12) {
+    __m128i v;
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (!Base64Values(in, &v))
+      break;
+    // Four 6 bit values a, b, c, d per 32 bit lane to a 24 bit number, then
+    // its bytes in big endian order.
+    __m128i w = _mm_slli_epi32(_mm_and_si128(v, lo8), 18);
+    w = _mm_or_si128(w,
+        _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 8), lo8), 12));
+    w = _mm_or_si128(w,
+        _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 16), lo8), 6));
+    w = _mm_or_si128(w, _mm_srli_epi32(v, 24));
+    w = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(w, 16), lo8),
+                                  _mm_and_si128(w, mid8)),
+                     _mm_slli_epi32(_mm_and_si128(w, lo8), 16));
+    // Three bytes from each lane. The stores overlap, the fourth byte of
+    // every one of them is junk that the next one overwrites.
+    for (int lane = 0; lane < 4; lane += 1) {
+      const int32_t bytes = _mm_cvtsi128_si32(w);
+      memcpy(dst + k + 3 * lane, &bytes, sizeof(bytes));
+      w = _mm_srli_si128(w, 4);
+    }
+  }
+  *written = k;
+  return i;
+}
+
+
+// 16 bytes in, 32 characters out.
+static size_t HexEncode_SSE2(const char* src, size_t slen, char* dst) {
+  const __m128i lo4 = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= slen; i += 16) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), lo4);
+    const __m128i lo = _mm_and_si128(in, lo4);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i),
+                     HexChars(_mm_unpacklo_epi8(hi, lo)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 16),
+                     HexChars(_mm_unpackhi_epi8(hi, lo)));
+  }
+  return i;
+}
+
+
+// 32 characters in, 16 bytes out.
+static size_t HexDecode_SSE2(const char* src,
+                             size_t slen,
+                             char* dst,
+                             size_t dlen) {
+  size_t i = 0;
+  for (; i + 32 <= slen && i / 2 + 16 <= dlen; i += 32) {
+    const __m128i first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i second =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+    __m128i a;
+    __m128i b;
+    if (!HexValues(first, &a) || !HexValues(second, &b))
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i / 2),
+                     _mm_packus_epi16(HexPairs(a), HexPairs(b)));
+  }
+  return i;
+}
+
+
+// mask must not be zero.
+static inline size_t CountTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+
+// 16 bytes at a time.
+static size_t AsciiPrefix_SSE2(const char* src, size_t slen) {
+  size_t i = 0;
+  for (; i + 16 <= slen; i += 16) {
+    const __m128i c =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const unsigned mask = _mm_movemask_epi8(c);
+    if (mask != 0)
+      return i + CountTrailingZeros(mask);
+  }
+  return i;
+}
+
+
+// 16 bytes in, 16 bytes out. Writes the whole block the run ends in.
+static size_t AsciiCopy_SSE2(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+  for (; i + 16 <= slen; i += 16) {
+    const __m128i c =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), c);
+    const unsigned mask = _mm_movemask_epi8(c);
+    if (mask != 0)
+      return i + CountTrailingZeros(mask);
+  }
+  return i;
+}
+
+
+// 16 bytes in, 16 characters out. Writes the whole block the run ends in.
+static size_t AsciiWiden_SSE2(const char* src, size_t slen, uint16_t* dst) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= slen; i += 16) {
+    const __m128i c =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_unpacklo_epi8(c, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8),
+                     _mm_unpackhi_epi8(c, zero));
+    const unsigned mask = _mm_movemask_epi8(c);
+    if (mask != 0)
+      return i + CountTrailingZeros(mask);
+  }
+  return i;
+}
+
+
+// Compares the first and last byte of the needle with 16 positions at a
+// time, after Wojciech Muła's "SIMD-friendly algorithms for substring
+// searching". Only positions where both match are compared in full.
+static size_t Find_SSE2(const char* haystack,
+                        size_t hlen,
+                        const char* needle,
+                        size_t nlen) {
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last = _mm_set1_epi8(needle[nlen - 1]);
+  size_t i = 0;
+  for (; i + nlen - 1 + 16 <= hlen; i += 16) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+    const __m128i b = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(haystack + i + nlen - 1));
+    unsigned mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+    while (mask != 0) {
+      const size_t k = i + CountTrailingZeros(mask);
+      if (memcmp(haystack + k + 1, needle + 1, nlen - 2) == 0)
+        return k;
+      mask &= mask - 1;
+    }
+  }
+  return i;
+}
+
+#endif  // defined(NODE_HAVE_SSE2)
+
+
+#if defined(NODE_HAVE_AVX2)
+
+// The AVX2 kernels follow the SSE2 ones, except where a shuffle does the
+// job of a handful of shifts. Byte shuffles don't cross the 128 bit halves
+// of a register, hence the permutes.
+
+NODE_TARGET_AVX2
+static inline __m256i Base64Chars_AVX2(__m256i v) {
+  __m256i offset = _mm256_set1_epi8('A');
+  offset = _mm256_add_epi8(offset,
+      _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(25)),
+                       _mm256_set1_epi8('a' - 26 - 'A')));
+  offset = _mm256_add_epi8(offset,
+      _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(51)),
+                       _mm256_set1_epi8('0' - 52 - ('a' - 26))));
+  offset = _mm256_add_epi8(offset,
+      _mm256_and_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(62)),
+                       _mm256_set1_epi8('+' - 62 - ('0' - 52))));
+  offset = _mm256_add_epi8(offset,
+      _mm256_and_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(63)),
+                       _mm256_set1_epi8('/' - 63 - ('0' - 52))));
+  return _mm256_add_epi8(v, offset);
+}
+
+
+NODE_TARGET_AVX2
+static inline __m256i InRange_AVX2(__m256i c, char lo, char hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(lo - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), c));
+}
+
+
+NODE_TARGET_AVX2
+static inline __m256i Equal_AVX2(__m256i c, char x) {
+  return _mm256_cmpeq_epi8(c, _mm256_set1_epi8(x));
+}
+
+
+NODE_TARGET_AVX2
+static inline bool Base64Values_AVX2(__m256i c, __m256i* values) {
+  const __m256i upper = InRange_AVX2(c, 'A', 'Z');
+  const __m256i lower = InRange_AVX2(c, 'a', 'z');
+  const __m256i digit = InRange_AVX2(c, '0', '9');
+  const __m256i plus = Equal_AVX2(c, '+');
+  const __m256i minus = Equal_AVX2(c, '-');
+  const __m256i slash = Equal_AVX2(c, '/');
+  const __m256i underscore = Equal_AVX2(c, '_');
+
+  const __m256i valid =
+      _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower),
+                                      _mm256_or_si256(digit, plus)),
+                      _mm256_or_si256(_mm256_or_si256(minus, slash),
+                                      underscore));
+  if (_mm256_movemask_epi8(valid) != -1)
+    return false;
+
+  __m256i offset = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+  offset = _mm256_or_si256(offset,
+      _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+  offset = _mm256_or_si256(offset,
+      _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+  offset = _mm256_or_si256(offset,
+      _mm256_and_si256(plus, _mm256_set1_epi8(62 - '+')));
+  offset = _mm256_or_si256(offset,
+      _mm256_and_si256(minus, _mm256_set1_epi8(62 - '-')));
+  offset = _mm256_or_si256(offset,
+      _mm256_and_si256(slash, _mm256_set1_epi8(63 - '/')));
+  offset = _mm256_or_si256(offset,
+      _mm256_and_si256(underscore, _mm256_set1_epi8(63 - '_')));
+  *values = _mm256_add_epi8(c, offset);
+  return true;
+}
+
+
+NODE_TARGET_AVX2
+static inline __m256i HexChars_AVX2(__m256i v) {
+  const __m256i letters = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(9));
+  const __m256i offset =
+      _mm256_add_epi8(_mm256_set1_epi8('0'),
+                      _mm256_and_si256(letters,
+                                       _mm256_set1_epi8('a' - 10 - '0')));
+  return _mm256_add_epi8(v, offset);
+}
+
+
+NODE_TARGET_AVX2
+static inline bool HexValues_AVX2(__m256i c, __m256i* values) {
+  const __m256i digit = InRange_AVX2(c, '0', '9');
+  const __m256i upper = InRange_AVX2(c, 'A', 'F');
+  const __m256i lower = InRange_AVX2(c, 'a', 'f');
+
+  const __m256i valid = _mm256_or_si256(_mm256_or_si256(digit, upper), lower);
+  if (_mm256_movemask_epi8(valid) != -1)
+    return false;
+
+  __m256i offset = _mm256_and_si256(digit, _mm256_set1_epi8(-'0'));
+  offset = _mm256_or_si256(offset,
+      _mm256_and_si256(upper, _mm256_set1_epi8(10 - 'A')));
+  offset = _mm256_or_si256(offset,
+      _mm256_and_si256(lower, _mm256_set1_epi8(10 - 'a')));
+  *values = _mm256_add_epi8(c, offset);
+  return true;
+}
+
+
+NODE_TARGET_AVX2
+static inline __m256i HexPairs_AVX2(__m256i v) {
+  return _mm256_or_si256(
+      _mm256_slli_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0xff)), 4),
+      _mm256_srli_epi16(v, 8));
+}
+
+
+// 24 bytes in, 32 characters out. Reads 28 bytes.
+NODE_TARGET_AVX2
+static size_t Base64Encode_AVX2(const char* src, size_t slen, char* dst) {
+  // Spreads the 12 bytes in each half over 16, every group of three input
+  // bytes a, b, c becomes b, a, c, b. The multiplies then shift the four
+  // 6 bit values into place.
+  const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                          7, 6, 8, 7, 10, 9, 11, 10,
+                                          1, 0, 2, 1, 4, 3, 5, 4,
+                                          7, 6, 8, 7, 10, 9, 11, 10);
+  size_t i = 0;
+  size_t k = 0;
+  for (; i + 28 <= slen; i += 24, k += 32) {
+    const __m128i lo =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12));
+    __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    in = _mm256_shuffle_epi8(in, spread);
+    const __m256i ac = _mm256_mulhi_epu16(
+        _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+        _mm256_set1_epi32(0x04000040));
+    const __m256i bd = _mm256_mullo_epi16(
+        _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+        _mm256_set1_epi32(0x01000010));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k),
+                        Base64Chars_AVX2(_mm256_or_si256(ac, bd)));
+  }
+  return i;
+}
+
+
+// 32 characters in, 24 bytes out. Writes 32 bytes.
+NODE_TARGET_AVX2
+static size_t Base64Decode_AVX2(const char* src,
+                                size_t slen,
+                                char* dst,
+                                size_t dlen,
+                                size_t* written) {
+  // Big endian byte order within every group of three, then the groups
+  // packed together, first within each half, then across.
+  const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                                        8, 14, 13, 12, -1, -1, -1, -1,
+                                        2, 1, 0, 6, 5, 4, 10, 9,
+                                        8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+  size_t i = 0;
+  size_t k = 0;
+  for (; i + 32 <= slen && k + 32 <= dlen; i += 32, k += 24) {
+    __m256i v;
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    if (!Base64Values_AVX2(in, &v))
+      break;
+    // a * 64 + b and c * 64 + d, then (a * 64 + b) * 4096 + c * 64 + d.
+    v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+    v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+    v = _mm256_shuffle_epi8(v, pack);
+    v = _mm256_permutevar8x32_epi32(v, join);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + k), v);
+  }
+  *written = k;
+  return i;
+}
+
+
+// 32 bytes in, 64 characters out.
+NODE_TARGET_AVX2
+static size_t HexEncode_AVX2(const char* src, size_t slen, char* dst) {
+  const __m256i lo4 = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= slen; i += 32) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(in, 4), lo4);
+    const __m256i lo = _mm256_and_si256(in, lo4);
+    // Bytes 0-7 and 16-23, then 8-15 and 24-31.
+    const __m256i a = HexChars_AVX2(_mm256_unpacklo_epi8(hi, lo));
+    const __m256i b = HexChars_AVX2(_mm256_unpackhi_epi8(hi, lo));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i),
+                        _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 32),
+                        _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  return i;
+}
+
+
+// 64 characters in, 32 bytes out.
+NODE_TARGET_AVX2
+static size_t HexDecode_AVX2(const char* src,
+                             size_t slen,
+                             char* dst,
+                             size_t dlen) {
+  size_t i = 0;
+  for (; i + 64 <= slen && i / 2 + 32 <= dlen; i += 64) {
+    const __m256i first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i second =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+    __m256i a;
+    __m256i b;
+    if (!HexValues_AVX2(first, &a) || !HexValues_AVX2(second, &b))
+      break;
+    // Packing works per half, the permute puts the quarters back in order.
+    const __m256i v = _mm256_packus_epi16(HexPairs_AVX2(a), HexPairs_AVX2(b));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i / 2),
+                        _mm256_permute4x64_epi64(v, 0xd8));
+  }
+  return i;
+}
+
+
+// 32 bytes at a time.
+NODE_TARGET_AVX2
+static size_t AsciiPrefix_AVX2(const char* src, size_t slen) {
+  size_t i = 0;
+  for (; i + 32 <= slen; i += 32) {
+    const __m256i c =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const unsigned mask = _mm256_movemask_epi8(c);
+    if (mask != 0)
+      return i + CountTrailingZeros(mask);
+  }
+  return i;
+}
+
+
+// UTF-8 validation after Keiser and Lemire, "Validating UTF-8 In Less Than
+// One Instruction Per Byte". Nearly every way a character can be malformed
+// is decided by its first byte together with the high and low nibble of the
+// byte before it. Three table lookups give each byte one bit per kind of
+// error it could be part of and the bits that survive the AND are errors.
+// What's left is checking that the second and third byte after a three or
+// four byte lead are continuation bytes, and that a sequence isn't cut short
+// by the end of the input.
+enum {
+  kTooShort = 1 << 0,    // 11______ 0_______, 11______ 11______
+  kTooLong = 1 << 1,     // 0_______ 10______
+  kOverlong3 = 1 << 2,   // 11100000 100_____
+  kTooLarge = 1 << 3,    // 11110100 1001____ and above
+  kSurrogate = 1 << 4,   // 11101101 101_____
+  kOverlong2 = 1 << 5,   // 1100000_ 10______
+  kTooLarge1000 = 1 << 6,  // 11110101 1000____ and above
+  kOverlong4 = 1 << 6,   // 11110000 1000____
+  kTwoConts = 1 << 7,    // 10______ 10______
+  kCarry = kTooShort | kTooLong | kTwoConts
+};
+
+// Indexed by the high nibble of the previous byte.
+static const uint8_t kUtf8Byte1High[16] = {
+  kTooLong, kTooLong, kTooLong, kTooLong,
+  kTooLong, kTooLong, kTooLong, kTooLong,
+  kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+  kTooShort | kOverlong2,
+  kTooShort,
+  kTooShort | kOverlong3 | kSurrogate,
+  kTooShort | kTooLarge | kTooLarge1000 | kOverlong4
+};
+
+// Indexed by the low nibble of the previous byte.
+static const uint8_t kUtf8Byte1Low[16] = {
+  kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+  kCarry | kOverlong2,
+  kCarry,
+  kCarry,
+  kCarry | kTooLarge,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+  kCarry | kTooLarge | kTooLarge1000,
+  kCarry | kTooLarge | kTooLarge1000
+};
+
+// Indexed by the high nibble of the byte itself.
+static const uint8_t kUtf8Byte2High[16] = {
+  kTooShort, kTooShort, kTooShort, kTooShort,
+  kTooShort, kTooShort, kTooShort, kTooShort,
+  kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 | kOverlong4,
+  kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+  kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+  kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+  kTooShort, kTooShort, kTooShort, kTooShort
+};
+
+// Bytes above these in the last three positions of a block start a character
+// that continues in the next one.
+static const uint8_t kUtf8Incomplete[32] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1
+};
+
+
+NODE_TARGET_AVX2
+static inline __m256i Table_AVX2(const uint8_t* table) {
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+
+// Returns non-zero bytes where c, preceded by the block prev, is malformed.
+NODE_TARGET_AVX2
+static inline __m256i Utf8Errors_AVX2(__m256i c, __m256i prev) {
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  // The last bytes of prev followed by the first bytes of c.
+  const __m256i t = _mm256_permute2x128_si256(prev, c, 0x21);
+  const __m256i prev1 = _mm256_alignr_epi8(c, t, 15);
+  const __m256i prev2 = _mm256_alignr_epi8(c, t, 14);
+  const __m256i prev3 = _mm256_alignr_epi8(c, t, 13);
+
+  const __m256i byte1_high = _mm256_shuffle_epi8(
+      Table_AVX2(kUtf8Byte1High),
+      _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+  const __m256i byte1_low = _mm256_shuffle_epi8(
+      Table_AVX2(kUtf8Byte1Low),
+      _mm256_and_si256(prev1, nibble));
+  const __m256i byte2_high = _mm256_shuffle_epi8(
+      Table_AVX2(kUtf8Byte2High),
+      _mm256_and_si256(_mm256_srli_epi16(c, 4), nibble));
+  const __m256i special = _mm256_and_si256(
+      _mm256_and_si256(byte1_high, byte1_low), byte2_high);
+
+  // Only bytes two after a 111_____ or three after a 1111____ end up with
+  // the top bit set. They must be continuation bytes, which is exactly when
+  // the lookups flagged them as kTwoConts.
+  const __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0x60));
+  const __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0x70));
+  const __m256i must_be_cont =
+      _mm256_and_si256(_mm256_or_si256(third, fourth),
+                       _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must_be_cont, special);
+}
+
+
+// 32 bytes at a time.
+NODE_TARGET_AVX2
+static size_t Utf8Validate_AVX2(const char* src, size_t slen, unsigned* max) {
+  const __m256i incomplete_max = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(kUtf8Incomplete));
+  __m256i prev = _mm256_setzero_si256();
+  __m256i incomplete = _mm256_setzero_si256();
+  __m256i hi = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= slen; i += 32) {
+    const __m256i c =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    if (_mm256_movemask_epi8(c) == 0) {
+      if (!_mm256_testz_si256(incomplete, incomplete))
+        break;
+    } else {
+      const __m256i errors = Utf8Errors_AVX2(c, prev);
+      if (!_mm256_testz_si256(errors, errors))
+        break;
+      hi = _mm256_max_epu8(hi, c);
+    }
+    incomplete = _mm256_subs_epu8(c, incomplete_max);
+    prev = c;
+  }
+
+  uint8_t bytes[32];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes), hi);
+  for (size_t k = 0; k < sizeof(bytes); k++) {
+    if (bytes[k] > *max)
+      *max = bytes[k];
+  }
+
+  // Leave a character that runs into the block that wasn't checked to the
+  // caller.
+  for (size_t k = 1; k <= 3 && k <= i; k++) {
+    const uint8_t c = static_cast<uint8_t>(src[i - k]);
+    if (c < 0x80)
+      break;
+    if (c >= 0xc0) {
+      const size_t n = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : 2;
+      if (n > k)
+        i -= k;
+      break;
+    }
+  }
+  return i;
+}
+
+
+// 32 positions at a time.
+NODE_TARGET_AVX2
+static size_t Find_AVX2(const char* haystack,
+                        size_t hlen,
+                        const char* needle,
+                        size_t nlen) {
+  const __m256i first = _mm256_set1_epi8(needle[0]);
+  const __m256i last = _mm256_set1_epi8(needle[nlen - 1]);
+  size_t i = 0;
+  for (; i + nlen - 1 + 32 <= hlen; i += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+    const __m256i b = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(haystack + i + nlen - 1));
+    unsigned mask = _mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+                         _mm256_cmpeq_epi8(b, last)));
+    while (mask != 0) {
+      const size_t k = i + CountTrailingZeros(mask);
+      if (memcmp(haystack + k + 1, needle + 1, nlen - 2) == 0)
+        return k;
+      mask &= mask - 1;
+    }
+  }
+  return i;
+}
+
+#endif  // defined(NODE_HAVE_AVX2)
+
+
+size_t Base64Encode(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+#if defined(NODE_HAVE_AVX2)
+  if (HaveAVX2())
+    i = Base64Encode_AVX2(src, slen, dst);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  i += Base64Encode_SSE2(src + i, slen - i, dst + i / 3 * 4);
+#endif
+  return i;
+}
+
+
+size_t HexEncode(const char* src, size_t slen, char* dst) {
+  size_t i = 0;
+#if defined(NODE_HAVE_AVX2)
+  if (HaveAVX2())
+    i = HexEncode_AVX2(src, slen, dst);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  i += HexEncode_SSE2(src + i, slen - i, dst + 2 * i);
+#endif
+  return i;
+}
+
+
+size_t Base64Decode(const char* src,
+                    size_t slen,
+                    char* dst,
+                    size_t dlen,
+                    size_t* written) {
+  size_t i = 0;
+  size_t k = 0;
+#if defined(NODE_HAVE_AVX2)
+  if (HaveAVX2())
+    i = Base64Decode_AVX2(src, slen, dst, dlen, &k);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  size_t n;
+  i += Base64Decode_SSE2(src + i, slen - i, dst + k, dlen - k, &n);
+  k += n;
+#endif
+  *written = k;
+  return i;
+}
+
+
+size_t HexDecode(const char* src, size_t slen, char* dst, size_t dlen) {
+  size_t i = 0;
+#if defined(NODE_HAVE_AVX2)
+  if (HaveAVX2())
+    i = HexDecode_AVX2(src, slen, dst, dlen);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  i += HexDecode_SSE2(src + i, slen - i, dst + i / 2, dlen - i / 2);
+#endif
+  return i;
+}
+
+
+size_t AsciiPrefix(const char* src, size_t slen) {
+  size_t i = 0;
+#if defined(NODE_HAVE_AVX2)
+  if (HaveAVX2())
+    i = AsciiPrefix_AVX2(src, slen);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  i += AsciiPrefix_SSE2(src + i, slen - i);
+#endif
+  return i;
+}
+
+
+size_t AsciiCopy(const char* src, size_t slen, char* dst) {
+#if defined(NODE_HAVE_SSE2)
+  return AsciiCopy_SSE2(src, slen, dst);
+#else
+  return 0;
+#endif
+}
+
+
+size_t AsciiWiden(const char* src, size_t slen, uint16_t* dst) {
+#if defined(NODE_HAVE_SSE2)
+  return AsciiWiden_SSE2(src, slen, dst);
+#else
+  return 0;
+#endif
+}
+
+
+size_t Utf8Validate(const char* src, size_t slen, unsigned* max) {
+  size_t i = 0;
+#if defined(NODE_HAVE_AVX2)
+  if (HaveAVX2())
+    i = Utf8Validate_AVX2(src, slen, max);
+#endif
+#if defined(NODE_HAVE_SSE2)
+  // SSE2 has no byte shuffle for the table lookups, it only gets through
+  // runs of ASCII.
+  i += AsciiPrefix_SSE2(src + i, slen - i);
+#endif
+  return i;
+}
+
+
+size_t Find(const char* haystack,
+            size_t hlen,
+            const char* needle,
+            size_t nlen) {
+  size_t i = 0;
+#if defined(NODE_HAVE_AVX2)
+  if (HaveAVX2()) {
+    i = Find_AVX2(haystack, hlen, needle, nlen);
+    if (i + nlen - 1 + 32 <= hlen)
+      return i;  // Found it.
+  }
+#endif
+#if defined(NODE_HAVE_SSE2)
+  i += Find_SSE2(haystack + i, hlen - i, needle, nlen);
+#endif
+  return i;
+}
+
+}  // namespace simd
+}  // namespace node
@@ -0,0 +1,89 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_STRING_BYTES_SIMD_H_
+#define SRC_STRING_BYTES_SIMD_H_
+
+// Vectorized base64, hex and UTF-8 kernels for StringBytes, and searching for
+// Buffer. They only ever do the easy part: whole blocks of input that need no
+// special treatment.
+// Each one returns how much of the input it got through and the scalar code
+// in string_bytes.cc picks up from there, so on platforms without a vector
+// implementation they simply return 0.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+namespace simd {
+
+// Returns the number of bytes of src consumed, always a multiple of 3.
+// dst must have room for the whole of src encoded.
+size_t Base64Encode(const char* src, size_t slen, char* dst);
+
+// Returns the number of bytes of src consumed. dst must have room for the
+// whole of src encoded.
+size_t HexEncode(const char* src, size_t slen, char* dst);
+
+// Decodes up to the first character that isn't in either base64 alphabet,
+// padding and whitespace included, or until dst is nearly full. Returns the
+// number of characters consumed, a multiple of 4, and stores the number of
+// bytes written in *written.
+size_t Base64Decode(const char* src,
+                    size_t slen,
+                    char* dst,
+                    size_t dlen,
+                    size_t* written);
+
+// Decodes up to the first block with a character that isn't a hex digit or
+// until dst is nearly full. Returns the number of characters consumed, which
+// is twice the number of bytes written.
+size_t HexDecode(const char* src, size_t slen, char* dst, size_t dlen);
+
+// Returns the length of the run of ASCII characters that src starts with,
+// or of as much of it as fits in whole blocks.
+size_t AsciiPrefix(const char* src, size_t slen);
+
+// Like AsciiPrefix() but also copies the run to dst, which must have room
+// for slen bytes.
+size_t AsciiCopy(const char* src, size_t slen, char* dst);
+
+// Like AsciiCopy() but widens the run to UTF-16.
+size_t AsciiWiden(const char* src, size_t slen, uint16_t* dst);
+
+// Validates src as UTF-8 up to the first block that is malformed in any way,
+// encoded surrogates and overlong forms included. Returns the number of bytes
+// consumed, which always ends on a character boundary, and raises *max to the
+// largest byte seen.
+size_t Utf8Validate(const char* src, size_t slen, unsigned* max);
+
+// Looks for needle, which is at least two bytes long, in haystack. Returns the
+// offset of the first match or, if whole blocks don't get as far as one, the
+// offset to carry on from. The caller tells the two apart.
+size_t Find(const char* haystack,
+            size_t hlen,
+            const char* needle,
+            size_t nlen);
+
+}  // namespace simd
+}  // namespace node
+
+#endif  // SRC_STRING_BYTES_SIMD_H_
@@ -25,6 +25,7 @@
 #include "env-inl.h"
 #include "handle_wrap.h"
 #include "node_buffer.h"
+#include "node_io_counters.h"
 #include "node_wrap.h"
 #include "req_wrap.h"
 #include "stream_wrap.h"
@@ -36,6 +37,7 @@
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Function;
@@ -126,6 +128,7 @@ void TCPWrap::Initialize(Handle<Object> target,
   NODE_SET_PROTOTYPE_METHOD(t, "getpeername", GetPeerName);
   NODE_SET_PROTOTYPE_METHOD(t, "setNoDelay", SetNoDelay);
   NODE_SET_PROTOTYPE_METHOD(t, "setKeepAlive", SetKeepAlive);
+  NODE_SET_PROTOTYPE_METHOD(t, "setAcceptBatch", SetAcceptBatch);
 
 #ifdef _WIN32
   NODE_SET_PROTOTYPE_METHOD(t,
@@ -135,6 +138,9 @@ void TCPWrap::Initialize(Handle<Object> target,
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "TCP"), t->GetFunction());
   env->set_tcp_constructor_template(t);
+
+  // Flags for bind() and bind6().
+  NODE_DEFINE_CONSTANT(target, UV_TCP_REUSEPORT);
 }
 
 
@@ -159,7 +165,8 @@ TCPWrap::TCPWrap(Environment* env, Handle<Object> object)
     : StreamWrap(env,
                  object,
                  reinterpret_cast<uv_stream_t*>(&handle_),
-                 AsyncWrap::PROVIDER_TCPWRAP) {
+                 AsyncWrap::PROVIDER_TCPWRAP),
+      accept_batch_(1) {
   int r = uv_tcp_init(env->event_loop(), &handle_);
   assert(r == 0);  // How do we proxy this error up to javascript?
                    // Suggestion: uv_tcp_init() returns void.
@@ -244,6 +251,17 @@ void TCPWrap::SetKeepAlive(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TCPWrap::SetAcceptBatch(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+
+  unsigned int batch = args[0]->Uint32Value();
+  wrap->accept_batch_ = batch > 0 ? batch : 1;
+}
+
+
 #ifdef _WIN32
 void TCPWrap::SetSimultaneousAccepts(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
@@ -275,13 +293,14 @@ void TCPWrap::Bind(const FunctionCallbackInfo<Value>& args) {
 
   node::Utf8Value ip_address(args[0]);
   int port = args[1]->Int32Value();
+  unsigned int flags = args[2]->Uint32Value();
 
   sockaddr_in addr;
   int err = uv_ip4_addr(*ip_address, port, &addr);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+                      flags);
   }
 
   args.GetReturnValue().Set(err);
@@ -296,13 +315,14 @@ void TCPWrap::Bind6(const FunctionCallbackInfo<Value>& args) {
 
   node::Utf8Value ip6_address(args[0]);
   int port = args[1]->Int32Value();
+  unsigned int flags = args[2]->Uint32Value();
 
   sockaddr_in6 addr;
   int err = uv_ip6_addr(*ip6_address, port, &addr);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      0);
+                      flags);
   }
 
   args.GetReturnValue().Set(err);
@@ -349,15 +369,47 @@ void TCPWrap::OnConnection(uv_stream_t* handle, int status) {
     uv_stream_t* client_handle = reinterpret_cast<uv_stream_t*>(&wrap->handle_);
     if (uv_accept(handle, client_handle))
       return;
+    io_counters::Count(io_counters::kTcpConnections);
 
     // Successful accept. Call the onconnection callback in JavaScript land.
-    argv[1] = client_obj;
+    if (tcp_wrap->accept_batch_ > 1)
+      argv[1] = tcp_wrap->AcceptBatch(client_obj);
+    else
+      argv[1] = client_obj;
   }
 
   tcp_wrap->MakeCallback(env->onconnection_string(), ARRAY_SIZE(argv), argv);
 }
 
 
+// Drains up to accept_batch_ - 1 more pending connections from the listen
+// socket so that JS receives them in a single onconnection callback. Any
+// error, including EAGAIN, just ends the batch; libuv's own accept loop runs
+// right after us and takes care of reporting it.
+Local<Array> TCPWrap::AcceptBatch(Local<Object> client_obj) {
+  EscapableHandleScope scope(env()->isolate());
+
+  Local<Array> clients = Array::New(env()->isolate());
+  clients->Set(0, client_obj);
+
+  uv_stream_t* server = reinterpret_cast<uv_stream_t*>(&handle_);
+  for (uint32_t i = 1; i < accept_batch_; i++) {
+    if (uv_accept_next(server))
+      break;
+
+    Local<Object> obj = Instantiate(env());
+    TCPWrap* wrap = Unwrap<TCPWrap>(obj);
+    if (uv_accept(server, reinterpret_cast<uv_stream_t*>(&wrap->handle_)))
+      break;
+    io_counters::Count(io_counters::kTcpConnections);
+
+    clients->Set(i, obj);
+  }
+
+  return scope.Escape(clients);
+}
+
+
 void TCPWrap::AfterConnect(uv_connect_t* req, int status) {
   ConnectWrap* req_wrap = static_cast<ConnectWrap*>(req->data);
   TCPWrap* wrap = static_cast<TCPWrap*>(req->handle->data);
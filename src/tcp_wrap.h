@@ -51,6 +51,7 @@ class TCPWrap : public StreamWrap {
   static void Connect(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Connect6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Open(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetAcceptBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef _WIN32
   static void SetSimultaneousAccepts(
@@ -60,7 +61,10 @@ class TCPWrap : public StreamWrap {
   static void OnConnection(uv_stream_t* handle, int status);
   static void AfterConnect(uv_connect_t* req, int status);
 
+  v8::Local<v8::Array> AcceptBatch(v8::Local<v8::Object> client_obj);
+
   uv_tcp_t handle_;
+  unsigned int accept_batch_;
 };
 
 
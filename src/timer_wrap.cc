@@ -41,6 +41,7 @@ using v8::Integer;
 using v8::Local;
 using v8::Object;
 using v8::Value;
+using v8::kExternalDoubleArray;
 
 const uint32_t kOnTimeout = 0;
 
@@ -71,6 +72,15 @@ class TimerWrap : public HandleWrap {
 
     target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Timer"),
                 constructor->GetFunction());
+
+    // Lets lib/timers.js read the loop time with a plain property load.
+    Local<Object> timer_info = Object::New(env->isolate());
+    timer_info->SetIndexedPropertiesToExternalArrayData(
+        env->timer_info()->fields(),
+        kExternalDoubleArray,
+        env->timer_info()->fields_count());
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "timerInfo"),
+                timer_info);
   }
 
  private:
@@ -156,6 +166,7 @@ class TimerWrap : public HandleWrap {
     HandleScope handle_scope(args.GetIsolate());
     Environment* env = Environment::GetCurrent(args.GetIsolate());
     uv_update_time(env->event_loop());
+    env->timer_info()->set_loop_time(env->event_loop());
     double now = static_cast<double>(uv_now(env->event_loop()));
     args.GetReturnValue().Set(now);
   }
@@ -29,6 +29,7 @@
 #include "node_crypto_clienthello-inl.h"
 #include "node_wrap.h"  // WithGenericStream
 #include "node_counters.h"
+#include "node_io_counters.h"
 #include "node_internals.h"
 #include "util.h"
 #include "util-inl.h"
@@ -55,6 +56,7 @@ using v8::Value;
 
 size_t TLSCallbacks::error_off_;
 char TLSCallbacks::error_buf_[1024];
+char TLSCallbacks::record_buf_[kRecordSize];
 
 
 TLSCallbacks::TLSCallbacks(Environment* env,
@@ -77,7 +79,14 @@ TLSCallbacks::TLSCallbacks(Environment* env,
       shutdown_(false),
       error_(NULL),
       cycle_depth_(0),
-      eof_(false) {
+      eof_(false),
+      async_handshake_(false),
+      handshake_work_(NULL),
+      pending_enc_in_(NULL),
+      pending_info_(0) {
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  sni_work_context_ = NULL;
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   node::Wrap<TLSCallbacks>(object(), this);
 
   // Initialize queue for clearIn writes
@@ -93,10 +102,16 @@ TLSCallbacks::TLSCallbacks(Environment* env,
 
 
 TLSCallbacks::~TLSCallbacks() {
+  // The worker may still be using `ssl_`, which is freed by ~SSLWrap()
+  if (handshake_work_ != NULL)
+    WaitForHandshakeWork();
+
   enc_in_ = NULL;
   enc_out_ = NULL;
   delete clear_in_;
   clear_in_ = NULL;
+  delete pending_enc_in_;
+  pending_enc_in_ = NULL;
 
   sc_ = NULL;
   sc_handle_.Reset();
@@ -286,25 +301,263 @@ void TLSCallbacks::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
   // a non-const SSL* in OpenSSL <= 0.9.7e.
   SSL* ssl = const_cast<SSL*>(ssl_);
   TLSCallbacks* c = static_cast<TLSCallbacks*>(SSL_get_app_data(ssl));
-  Environment* env = c->env();
-  HandleScope handle_scope(env->isolate());
-  Context::Scope context_scope(env->context());
-  Local<Object> object = c->object();
+
+  // Called on a worker thread, let the loop deliver it
+  if (c->handshake_work_ != NULL) {
+    c->pending_info_ |= where;
+    return;
+  }
+
+  c->OnHandshakeInfo(where);
+}
+
+
+void TLSCallbacks::OnHandshakeInfo(int where) {
+  HandleScope handle_scope(env()->isolate());
+  Context::Scope context_scope(env()->context());
+  Local<Object> object = this->object();
 
   if (where & SSL_CB_HANDSHAKE_START) {
-    Local<Value> callback = object->Get(env->onhandshakestart_string());
+    Local<Value> callback = object->Get(env()->onhandshakestart_string());
     if (callback->IsFunction()) {
-      c->MakeCallback(callback.As<Function>(), 0, NULL);
+      MakeCallback(callback.As<Function>(), 0, NULL);
     }
   }
 
   if (where & SSL_CB_HANDSHAKE_DONE) {
-    c->established_ = true;
-    Local<Value> callback = object->Get(env->onhandshakedone_string());
+    established_ = true;
+    io_counters::Count(io_counters::kTlsHandshakes);
+    Local<Value> callback = object->Get(env()->onhandshakedone_string());
     if (callback->IsFunction()) {
-      c->MakeCallback(callback.As<Function>(), 0, NULL);
+      MakeCallback(callback.As<Function>(), 0, NULL);
+    }
+  }
+}
+
+
+class TLSCallbacks::HandshakeWork {
+ public:
+  explicit HandshakeWork(TLSCallbacks* callbacks)
+      : callbacks_(callbacks),
+        ssl_(callbacks->ssl_),
+        error_count_(0),
+        done_(false) {
+    req_.data = this;
+    if (uv_mutex_init(&mutex_))
+      abort();
+    if (uv_cond_init(&cond_))
+      abort();
+  }
+
+  ~HandshakeWork() {
+    uv_cond_destroy(&cond_);
+    uv_mutex_destroy(&mutex_);
+  }
+
+  // Runs on the thread pool. OpenSSL keeps its error queue per thread, so
+  // errors are collected here and raised again on the loop thread.
+  void Run() {
+    ERR_clear_error();
+    SSL_do_handshake(ssl_);
+
+    const char* file;
+    int line;
+    unsigned long err;
+    while ((err = ERR_get_error_line(&file, &line)) != 0) {
+      if (error_count_ == ARRAY_SIZE(errors_))
+        continue;
+      errors_[error_count_] = err;
+      files_[error_count_] = file;
+      lines_[error_count_] = line;
+      error_count_++;
+    }
+
+    uv_mutex_lock(&mutex_);
+    done_ = true;
+    uv_cond_signal(&cond_);
+    uv_mutex_unlock(&mutex_);
+  }
+
+  // Blocks until Run() has returned
+  void Wait() {
+    uv_mutex_lock(&mutex_);
+    while (!done_)
+      uv_cond_wait(&cond_, &mutex_);
+    uv_mutex_unlock(&mutex_);
+  }
+
+  // Returns true if the handshake step failed
+  bool RestoreErrors() {
+    ERR_clear_error();
+    for (int i = 0; i < error_count_; i++) {
+      ERR_put_error(ERR_GET_LIB(errors_[i]),
+                    ERR_GET_FUNC(errors_[i]),
+                    ERR_GET_REASON(errors_[i]),
+                    files_[i],
+                    lines_[i]);
+    }
+    return error_count_ > 0;
+  }
+
+  uv_work_t req_;
+  TLSCallbacks* callbacks_;  // NULL once the connection has been destroyed
+
+ private:
+  SSL* const ssl_;
+  unsigned long errors_[16];
+  const char* files_[ARRAY_SIZE(errors_)];
+  int lines_[ARRAY_SIZE(errors_)];
+  int error_count_;
+  uv_mutex_t mutex_;
+  uv_cond_t cond_;
+  bool done_;
+};
+
+
+// Hands the next server-side handshake step to the thread pool, so that the
+// private key operation it may involve does not block the loop. Only steps
+// that can run without calling into V8 are offloaded: all callbacks OpenSSL
+// may invoke have to be answerable from C++ state, and there must be no
+// outgoing data in flight since the worker writes to `enc_out_`.
+bool TLSCallbacks::StartHandshakeWork() {
+  if (!async_handshake_ ||
+      handshake_work_ != NULL ||
+      !is_server() ||
+      SSL_is_init_finished(ssl_) ||
+      session_callbacks_ ||
+      write_size_ != 0 ||
+      BIO_pending(enc_out_) != 0 ||
+      BIO_pending(enc_in_) == 0) {
+    return false;
+  }
+
+#ifdef NODE__HAVE_TLSEXT_STATUS_CB
+  if (!ocsp_response_.IsEmpty())
+    return false;
+#endif  // NODE__HAVE_TLSEXT_STATUS_CB
+
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  // SelectSNIContextCallback() picks up the context from here
+  sni_work_context_ = NULL;
+  Local<Value> ctx = object()->Get(env()->sni_context_string());
+  if (ctx->IsObject()) {
+    Local<FunctionTemplate> cons = env()->secure_context_constructor_template();
+    if (!cons->HasInstance(ctx))
+      return false;
+    sni_work_context_ = Unwrap<SecureContext>(ctx.As<Object>());
+    sni_context_.Reset();
+    sni_context_.Reset(env()->isolate(), ctx);
+  }
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+
+  handshake_work_ = new HandshakeWork(this);
+  int err = uv_queue_work(env()->event_loop(),
+                          &handshake_work_->req_,
+                          HandshakeWorkCb,
+                          AfterHandshakeWorkCb);
+  if (err != 0) {
+    delete handshake_work_;
+    handshake_work_ = NULL;
+    return false;
+  }
+
+  return true;
+}
+
+
+void TLSCallbacks::HandshakeWorkCb(uv_work_t* req) {
+  HandshakeWork* work = static_cast<HandshakeWork*>(req->data);
+  work->Run();
+}
+
+
+void TLSCallbacks::AfterHandshakeWorkCb(uv_work_t* req, int status) {
+  HandshakeWork* work = static_cast<HandshakeWork*>(req->data);
+  TLSCallbacks* callbacks = work->callbacks_;
+
+  if (callbacks != NULL) {
+    // Cancelled by SyncHandshakeWork(), which has run the step itself
+    assert(status == 0 || status == UV_ECANCELED);
+    assert(callbacks->handshake_work_ == work);
+    callbacks->FinishHandshakeWork(work, true);
+  }
+  delete work;
+}
+
+
+// `work` is NULL if the step was cancelled before it ran
+void TLSCallbacks::FinishHandshakeWork(HandshakeWork* work, bool cycle) {
+  handshake_work_ = NULL;
+  bool failed = work != NULL && work->RestoreErrors();
+
+  // Hand the data received in the meantime to OpenSSL
+  if (pending_enc_in_ != NULL) {
+    NodeBIO* enc_in = NodeBIO::FromBIO(enc_in_);
+    while (pending_enc_in_->Length() != 0) {
+      size_t avail = 0;
+      char* data = pending_enc_in_->Peek(&avail);
+      enc_in->Write(data, avail);
+      pending_enc_in_->Read(NULL, avail);
+    }
+  }
+
+  int info = pending_info_;
+  pending_info_ = 0;
+  if (info != 0)
+    OnHandshakeInfo(info);
+
+  if (failed) {
+    // Report the error the way ClearOut() would and stay synchronous
+    async_handshake_ = false;
+
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+    int err;
+    Local<Value> arg = GetSSLError(-1, &err, NULL);
+    if (!arg.IsEmpty()) {
+      if (BIO_pending(enc_out_) != 0)
+        EncOut();
+      if (cycle)
+        MakeCallback(env()->onerror_string(), 1, &arg);
+      return;
     }
   }
+
+  if (cycle)
+    Cycle();
+}
+
+
+// Called where the loop has to touch OpenSSL state while a handshake step may
+// be running on the thread pool. A step that has not started yet is
+// cancelled, a running one only takes as long as a private key operation.
+// Detaches the step from the connection; AfterHandshakeWorkCb() still runs
+// and releases it. Returns NULL if the step was cancelled.
+TLSCallbacks::HandshakeWork* TLSCallbacks::WaitForHandshakeWork() {
+  HandshakeWork* work = handshake_work_;
+  assert(work != NULL);
+  work->callbacks_ = NULL;
+
+  if (uv_cancel(reinterpret_cast<uv_req_t*>(&work->req_)) == 0)
+    return NULL;
+
+  work->Wait();
+  return work;
+}
+
+
+// Called before a JS method touches `ssl_`. Waits until the handshake step
+// is done with it, running the step right here if it has not started yet.
+// Unlike WaitForHandshakeWork() the step stays attached, so nothing calls
+// back into JS now; AfterHandshakeWorkCb() finishes it as usual.
+void TLSCallbacks::SyncHandshakeWork() {
+  if (handshake_work_ == NULL)
+    return;
+
+  if (uv_cancel(reinterpret_cast<uv_req_t*>(&handshake_work_->req_)) == 0)
+    handshake_work_->Run();
+  else
+    handshake_work_->Wait();
 }
 
 
@@ -313,6 +566,10 @@ void TLSCallbacks::EncOut() {
   if (!hello_parser_.IsEnded())
     return;
 
+  // The handshake worker is writing to `enc_out_`
+  if (handshake_work_ != NULL)
+    return;
+
   // Write in progress
   if (write_size_ != 0)
     return;
@@ -351,6 +608,10 @@ void TLSCallbacks::EncOut() {
     } else if (wrap()->is_named_pipe()) {
       NODE_COUNT_PIPE_BYTES_SENT(write_size_);
     }
+    io_counters::CountStream(wrap()->stream(),
+                             io_counters::kTcpBytesWritten,
+                             io_counters::kPipeBytesWritten,
+                             write_size_);
   }
 }
 
@@ -443,6 +704,10 @@ void TLSCallbacks::ClearOut() {
   if (!hello_parser_.IsEnded())
     return;
 
+  // Handshake in progress on the thread pool
+  if (handshake_work_ != NULL || StartHandshakeWork())
+    return;
+
   HandleScope handle_scope(env()->isolate());
   Context::Scope context_scope(env()->context());
 
@@ -484,20 +749,108 @@ void TLSCallbacks::ClearOut() {
 }
 
 
+// Feeds `bufs` to SSL_write() in as few TLS records as possible: runs of
+// small buffers are gathered into full-sized records and only the tail of a
+// large buffer is merged with the data that follows it. Returns the number of
+// bytes consumed, `*written` is set to the result of the last SSL_write().
+size_t TLSCallbacks::EncryptBuffers(const uv_buf_t* bufs,
+                                    size_t count,
+                                    int* written) {
+  size_t consumed = 0;
+  size_t offset = 0;
+  size_t i = 0;
+
+  // Records are cut at the negotiated fragment size, see setMaxSendFragment()
+  size_t record_size = kRecordSize;
+#ifdef SSL_set_max_send_fragment
+  if (ssl_->max_send_fragment < record_size)
+    record_size = ssl_->max_send_fragment;
+#endif  // SSL_set_max_send_fragment
+
+  *written = 0;
+  while (i < count) {
+    size_t avail = bufs[i].len - offset;
+    const char* data;
+    size_t size;
+
+    if (avail == 0) {
+      i++;
+      offset = 0;
+      continue;
+    }
+
+    if (avail >= record_size || i + 1 == count) {
+      // Encrypt straight from the buffer, SSL_write() splits it into records
+      data = bufs[i].base + offset;
+      size = avail;
+      if (i + 1 != count)
+        size -= avail % record_size;
+    } else {
+      size_t start_buf = i;
+      size_t start_offset = offset;
+      size = 0;
+      while (i < count && size < record_size) {
+        size_t chunk = bufs[i].len - offset;
+        if (chunk > record_size - size)
+          chunk = record_size - size;
+        memcpy(record_buf_ + size, bufs[i].base + offset, chunk);
+        size += chunk;
+        offset += chunk;
+        if (offset == bufs[i].len) {
+          i++;
+          offset = 0;
+        }
+      }
+      data = record_buf_;
+
+      // Rewind, the pointers are advanced once the record is written
+      i = start_buf;
+      offset = start_offset;
+    }
+
+    *written = SSL_write(ssl_, data, size);
+    assert(*written == -1 || *written == static_cast<int>(size));
+    if (*written == -1)
+      break;
+
+    consumed += size;
+    offset += size;
+    while (i < count && offset >= bufs[i].len) {
+      offset -= bufs[i].len;
+      i++;
+    }
+  }
+
+  return consumed;
+}
+
+
 bool TLSCallbacks::ClearIn() {
   // Ignore cycling data if ClientHello wasn't yet parsed
   if (!hello_parser_.IsEnded())
     return false;
 
+  // SSL_write() would otherwise run the handshake on the loop thread
+  if (handshake_work_ != NULL ||
+      (async_handshake_ && is_server() && !SSL_is_init_finished(ssl_))) {
+    return false;
+  }
+
   int written = 0;
   while (clear_in_->Length() > 0) {
-    size_t avail = 0;
-    char* data = clear_in_->Peek(&avail);
-    written = SSL_write(ssl_, data, avail);
-    assert(written == -1 || written == static_cast<int>(avail));
+    char* data[kSimultaneousBufferCount];
+    size_t size[ARRAY_SIZE(data)];
+    size_t count = ARRAY_SIZE(data);
+    clear_in_->PeekMultiple(data, size, &count);
+
+    uv_buf_t bufs[ARRAY_SIZE(data)];
+    for (size_t i = 0; i < count; i++)
+      bufs[i] = uv_buf_init(data[i], size[i]);
+
+    size_t consumed = EncryptBuffers(bufs, count, &written);
+    clear_in_->Read(NULL, consumed);
     if (written == -1)
       break;
-    clear_in_->Read(NULL, avail);
   }
 
   // All written
@@ -556,7 +909,7 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
     ClearOut();
     // However if there any data that should be written to socket,
     // callback should not be invoked immediately
-    if (BIO_pending(enc_out_) == 0)
+    if (handshake_work_ == NULL && BIO_pending(enc_out_) == 0)
       return uv_write(&w->req_, wrap()->stream(), bufs, count, cb);
   }
 
@@ -579,14 +932,9 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
   }
 
   int written = 0;
-  for (i = 0; i < count; i++) {
-    written = SSL_write(ssl_, bufs[i].base, bufs[i].len);
-    assert(written == -1 || written == static_cast<int>(bufs[i].len));
-    if (written == -1)
-      break;
-  }
+  size_t consumed = EncryptBuffers(bufs, count, &written);
 
-  if (i != count) {
+  if (written == -1) {
     int err;
     HandleScope handle_scope(env()->isolate());
     Context::Scope context_scope(env()->context());
@@ -595,8 +943,14 @@ int TLSCallbacks::DoWrite(WriteWrap* w,
       return UV_EPROTO;
 
     // No errors, queue rest
-    for (; i < count; i++)
-      clear_in_->Write(bufs[i].base, bufs[i].len);
+    for (i = 0; i < count; i++) {
+      if (consumed >= bufs[i].len) {
+        consumed -= bufs[i].len;
+        continue;
+      }
+      clear_in_->Write(bufs[i].base + consumed, bufs[i].len - consumed);
+      consumed = 0;
+    }
   }
 
   // Try writing data immediately
@@ -614,7 +968,16 @@ void TLSCallbacks::AfterWrite(WriteWrap* w) {
 void TLSCallbacks::DoAlloc(uv_handle_t* handle,
                            size_t suggested_size,
                            uv_buf_t* buf) {
-  buf->base = NodeBIO::FromBIO(enc_in_)->PeekWritable(&suggested_size);
+  NodeBIO* bio = NodeBIO::FromBIO(enc_in_);
+
+  // Keep away from `enc_in_` while the handshake worker reads it
+  if (handshake_work_ != NULL) {
+    if (pending_enc_in_ == NULL)
+      pending_enc_in_ = new NodeBIO();
+    bio = pending_enc_in_;
+  }
+
+  buf->base = bio->PeekWritable(&suggested_size);
   buf->len = suggested_size;
 }
 
@@ -625,7 +988,8 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
                           uv_handle_type pending) {
   if (nread < 0)  {
     // Error should be emitted only after all data was read
-    ClearOut();
+    if (handshake_work_ == NULL)
+      ClearOut();
 
     // Ignore EOF if received close_notify
     if (nread == UV_EOF) {
@@ -644,6 +1008,12 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
   // Only client connections can receive data
   assert(ssl_ != NULL);
 
+  // Data is handed to OpenSSL once the handshake worker is done
+  if (handshake_work_ != NULL) {
+    pending_enc_in_->Commit(nread);
+    return;
+  }
+
   // Commit read data
   NodeBIO* enc_in = NodeBIO::FromBIO(enc_in_);
   enc_in->Commit(nread);
@@ -662,6 +1032,9 @@ void TLSCallbacks::DoRead(uv_stream_t* handle,
 
 
 int TLSCallbacks::DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb) {
+  if (handshake_work_ != NULL)
+    FinishHandshakeWork(WaitForHandshakeWork(), false);
+
   if (SSL_shutdown(ssl_) == 0)
     SSL_shutdown(ssl_);
   shutdown_ = true;
@@ -675,6 +1048,7 @@ void TLSCallbacks::SetVerifyMode(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(env->isolate());
 
   TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.Holder());
+  wrap->SyncHandshakeWork();
 
   if (args.Length() < 2 || !args[0]->IsBoolean() || !args[1]->IsBoolean())
     return env->ThrowTypeError("Bad arguments, expected two booleans");
@@ -713,6 +1087,15 @@ void TLSCallbacks::EnableSessionCallbacks(
 }
 
 
+void TLSCallbacks::EnableAsyncHandshake(
+    const FunctionCallbackInfo<Value>& args) {
+  HandleScope scope(args.GetIsolate());
+
+  TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.Holder());
+  wrap->async_handshake_ = true;
+}
+
+
 void TLSCallbacks::EnableHelloParser(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
   HandleScope scope(env->isolate());
@@ -737,6 +1120,7 @@ void TLSCallbacks::GetServername(const FunctionCallbackInfo<Value>& args) {
   HandleScope scope(env->isolate());
 
   TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.Holder());
+  wrap->SyncHandshakeWork();
 
   const char* servername = SSL_get_servername(wrap->ssl_,
                                               TLSEXT_NAMETYPE_host_name);
@@ -779,6 +1163,16 @@ int TLSCallbacks::SelectSNIContextCallback(SSL* s, int* ad, void* arg) {
   if (servername == NULL)
     return SSL_TLSEXT_ERR_OK;
 
+  // On the thread pool, use the context looked up by StartHandshakeWork()
+  if (p->handshake_work_ != NULL) {
+    SecureContext* sc = p->sni_work_context_;
+    if (sc == NULL)
+      return SSL_TLSEXT_ERR_NOACK;
+    InitNPN(sc, p);
+    SSL_set_SSL_CTX(s, sc->ctx_);
+    return SSL_TLSEXT_ERR_OK;
+  }
+
   HandleScope scope(env->isolate());
   // Call the SNI callback and use its return value as context
   Local<Object> object = p->object();
@@ -827,6 +1221,9 @@ void TLSCallbacks::Initialize(Handle<Object> target,
   NODE_SET_PROTOTYPE_METHOD(t,
                             "enableHelloParser",
                             EnableHelloParser);
+  NODE_SET_PROTOTYPE_METHOD(t,
+                            "enableAsyncHandshake",
+                            EnableAsyncHandshake);
 
   SSLWrap<TLSCallbacks>::AddMethods(env, t);
 
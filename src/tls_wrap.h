@@ -68,6 +68,7 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
   int DoShutdown(ShutdownWrap* req_wrap, uv_shutdown_cb cb);
 
   void NewSessionDoneCb();
+  void SyncHandshakeWork();
 
  protected:
   static const int kClearOutChunkSize = 1024;
@@ -75,6 +76,9 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
   // Maximum number of buffers passed to uv_write()
   static const int kSimultaneousBufferCount = 10;
 
+  // Largest amount of clear text that fits into a single TLS record
+  static const size_t kRecordSize = SSL3_RT_MAX_PLAIN_LENGTH;
+
   // Write callback queue's item
   class WriteItem {
    public:
@@ -100,6 +104,17 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
   void InitSSL();
   void EncOut();
   static void EncOutCb(uv_write_t* req, int status);
+  size_t EncryptBuffers(const uv_buf_t* bufs, size_t count, int* written);
+
+  // Asynchronous handshake: server-side handshake steps, and with them the
+  // private key operations, run on the thread pool. See StartHandshakeWork().
+  class HandshakeWork;
+  bool StartHandshakeWork();
+  void FinishHandshakeWork(HandshakeWork* work, bool cycle);
+  HandshakeWork* WaitForHandshakeWork();
+  static void HandshakeWorkCb(uv_work_t* req);
+  static void AfterHandshakeWorkCb(uv_work_t* req, int status);
+  void OnHandshakeInfo(int where);
   bool ClearIn();
   void ClearOut();
   void MakePending();
@@ -131,6 +146,8 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableHelloParser(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableAsyncHandshake(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -158,12 +175,26 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
   // after the `UV_EOF` on socket.
   bool eof_;
 
+  bool async_handshake_;
+  // Non-NULL while a handshake step runs on the thread pool. Until it is
+  // done, OpenSSL state is off limits and incoming data goes to
+  // `pending_enc_in_`.
+  HandshakeWork* handshake_work_;
+  NodeBIO* pending_enc_in_;
+  // SSL_CB_HANDSHAKE_* events raised by the worker, replayed on the loop
+  int pending_info_;
+
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   v8::Persistent<v8::Value> sni_context_;
+  // SNI context looked up ahead of an asynchronous handshake step
+  crypto::SecureContext* sni_work_context_;
 #endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
 
   static size_t error_off_;
   static char error_buf_[1024];
+
+  // Small writes are gathered here to be encrypted as one record
+  static char record_buf_[kRecordSize];
 };
 
 }  // namespace node
@@ -23,16 +23,19 @@
 #include "env.h"
 #include "env-inl.h"
 #include "node_buffer.h"
+#include "node_io_counters.h"
 #include "handle_wrap.h"
 #include "req_wrap.h"
 #include "util.h"
 #include "util-inl.h"
 
 #include <stdlib.h>
+#include <string.h>  // memcpy()
 
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -72,17 +75,93 @@ inline bool SendWrap::have_callback() const {
 }
 
 
+// One uv_udp_send_t per datagram of a sendBatch() call. JS is notified once,
+// after the last datagram of the batch has been sent.
+class SendBatchWrap : public ReqWrap<uv_udp_send_t> {
+ public:
+  SendBatchWrap(Environment* env,
+                Local<Object> req_wrap_obj,
+                bool have_callback,
+                size_t count);
+  ~SendBatchWrap();
+  inline bool have_callback() const;
+  inline uv_udp_send_t* req(size_t index);
+  inline int status() const;
+  // Records the outcome of one datagram. Returns true when it was the last
+  // one still in flight.
+  inline bool Complete(int status);
+  // Called when only the first |sent| datagrams could be queued.
+  inline void Truncate(size_t sent, int status);
+ private:
+  uv_udp_send_t* const reqs_;
+  size_t pending_;
+  int status_;
+  const bool have_callback_;
+};
+
+
+SendBatchWrap::SendBatchWrap(Environment* env,
+                             Local<Object> req_wrap_obj,
+                             bool have_callback,
+                             size_t count)
+    : ReqWrap<uv_udp_send_t>(env, req_wrap_obj),
+      reqs_(new uv_udp_send_t[count]),
+      pending_(count),
+      status_(0),
+      have_callback_(have_callback) {
+}
+
+
+SendBatchWrap::~SendBatchWrap() {
+  delete[] reqs_;
+}
+
+
+inline bool SendBatchWrap::have_callback() const {
+  return have_callback_;
+}
+
+
+inline uv_udp_send_t* SendBatchWrap::req(size_t index) {
+  return &reqs_[index];
+}
+
+
+inline int SendBatchWrap::status() const {
+  return status_;
+}
+
+
+inline bool SendBatchWrap::Complete(int status) {
+  if (status < 0 && status_ == 0)
+    status_ = status;
+  assert(pending_ > 0);
+  return --pending_ == 0;
+}
+
+
+inline void SendBatchWrap::Truncate(size_t sent, int status) {
+  pending_ = sent;
+  status_ = status;
+}
+
+
 UDPWrap::UDPWrap(Environment* env, Handle<Object> object)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      recv_batch_(false),
+      recv_batch_buffer_(NULL),
+      recv_batch_buffer_size_(0),
+      recv_batch_count_(0) {
   int r = uv_udp_init(env->event_loop(), &handle_);
   assert(r == 0);  // can't fail anyway
 }
 
 
 UDPWrap::~UDPWrap() {
+  free(recv_batch_buffer_);
 }
 
 
@@ -108,6 +187,8 @@ void UDPWrap::Initialize(Handle<Object> target,
   NODE_SET_PROTOTYPE_METHOD(t, "send", Send);
   NODE_SET_PROTOTYPE_METHOD(t, "bind6", Bind6);
   NODE_SET_PROTOTYPE_METHOD(t, "send6", Send6);
+  NODE_SET_PROTOTYPE_METHOD(t, "sendBatch", SendBatch);
+  NODE_SET_PROTOTYPE_METHOD(t, "sendBatch6", SendBatch6);
   NODE_SET_PROTOTYPE_METHOD(t, "close", Close);
   NODE_SET_PROTOTYPE_METHOD(t, "recvStart", RecvStart);
   NODE_SET_PROTOTYPE_METHOD(t, "recvStop", RecvStop);
@@ -179,6 +260,9 @@ void UDPWrap::DoBind(const FunctionCallbackInfo<Value>& args, int family) {
                       flags);
   }
 
+  if (err == 0 && (flags & UV_UDP_RECVMMSG))
+    wrap->recv_batch_ = true;
+
   args.GetReturnValue().Set(err);
 }
 
@@ -298,6 +382,11 @@ void UDPWrap::DoSend(const FunctionCallbackInfo<Value>& args, int family) {
                       OnSend);
   }
 
+  if (err == 0) {
+    io_counters::Count(io_counters::kUdpDatagramsSent);
+    io_counters::Count(io_counters::kUdpBytesSent, length);
+  }
+
   req_wrap->Dispatched();
   if (err)
     delete req_wrap;
@@ -316,6 +405,97 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  HandleScope handle_scope(args.GetIsolate());
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+
+  // sendBatch(req, buffers, port, address, hasCallback)
+  assert(args[0]->IsObject());
+  assert(args[1]->IsArray());
+  assert(args[2]->IsUint32());
+  assert(args[3]->IsString());
+  assert(args[4]->IsBoolean());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> buffers = args[1].As<Array>();
+  const unsigned short port = args[2]->Uint32Value();
+  node::Utf8Value address(args[3]);
+  const bool have_callback = args[4]->IsTrue();
+  const size_t count = buffers->Length();
+
+  assert(count > 0);
+
+  char addr[sizeof(sockaddr_in6)];
+  int err;
+
+  switch (family) {
+  case AF_INET:
+    err = uv_ip4_addr(*address, port, reinterpret_cast<sockaddr_in*>(&addr));
+    break;
+  case AF_INET6:
+    err = uv_ip6_addr(*address, port, reinterpret_cast<sockaddr_in6*>(&addr));
+    break;
+  default:
+    assert(0 && "unexpected address family");
+    abort();
+  }
+
+  if (err)
+    return args.GetReturnValue().Set(err);
+
+  SendBatchWrap* req_wrap =
+      new SendBatchWrap(env, req_wrap_obj, have_callback, count);
+  req_wrap->Dispatched();
+
+  // Datagrams queued back to back are flushed with a single sendmmsg() call
+  // where available, see uv__udp_sendmmsg() in deps/uv/src/unix/udp.c.
+  size_t i;
+  for (i = 0; i < count; i++) {
+    Local<Value> buffer_obj = buffers->Get(i);
+    assert(Buffer::HasInstance(buffer_obj));
+
+    uv_buf_t buf = uv_buf_init(Buffer::Data(buffer_obj),
+                               Buffer::Length(buffer_obj));
+    uv_udp_send_t* req = req_wrap->req(i);
+    req->data = req_wrap;
+    err = uv_udp_send(req,
+                      &wrap->handle_,
+                      &buf,
+                      1,
+                      reinterpret_cast<const sockaddr*>(&addr),
+                      OnSendBatch);
+    if (err)
+      break;
+    io_counters::Count(io_counters::kUdpDatagramsSent);
+    io_counters::Count(io_counters::kUdpBytesSent, buf.len);
+  }
+
+  if (i == 0) {
+    delete req_wrap;
+    return args.GetReturnValue().Set(err);
+  }
+
+  // Some datagrams went out, report the error through the callback instead.
+  if (i < count)
+    req_wrap->Truncate(i, err);
+
+  args.GetReturnValue().Set(0);
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args.GetIsolate());
   HandleScope scope(env->isolate());
@@ -377,11 +557,41 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 }
 
 
+void UDPWrap::OnSendBatch(uv_udp_send_t* req, int status) {
+  SendBatchWrap* req_wrap = static_cast<SendBatchWrap*>(req->data);
+  if (!req_wrap->Complete(status))
+    return;
+
+  if (req_wrap->have_callback()) {
+    Environment* env = req_wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> arg = Integer::New(env->isolate(), req_wrap->status());
+    req_wrap->MakeCallback(env->oncomplete_string(), 1, &arg);
+  }
+  delete req_wrap;
+}
+
+
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
-  buf->base = static_cast<char*>(malloc(suggested_size));
-  buf->len = suggested_size;
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+
+  if (wrap->recv_batch_) {
+    // The receive buffer is reused, datagrams are copied out of it before
+    // libuv asks for it again.
+    if (wrap->recv_batch_buffer_size_ < suggested_size) {
+      free(wrap->recv_batch_buffer_);
+      wrap->recv_batch_buffer_ = static_cast<char*>(malloc(suggested_size));
+      wrap->recv_batch_buffer_size_ = suggested_size;
+    }
+    buf->base = wrap->recv_batch_buffer_;
+    buf->len = wrap->recv_batch_buffer_size_;
+  } else {
+    buf->base = static_cast<char*>(malloc(suggested_size));
+    buf->len = suggested_size;
+  }
 
   if (buf->base == NULL && suggested_size > 0) {
     FatalError("node::UDPWrap::OnAlloc(uv_handle_t*, size_t, uv_buf_t*)",
@@ -395,13 +605,23 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+
+  // An empty datagram still has an address, no address means no datagram.
+  if (nread >= 0 && addr != NULL) {
+    io_counters::Count(io_counters::kUdpDatagramsReceived);
+    io_counters::Count(io_counters::kUdpBytesReceived, nread);
+  }
+
+  if (wrap->recv_batch_)
+    return wrap->OnRecvBatch(nread, buf, addr, flags);
+
   if (nread == 0 && addr == NULL) {
     if (buf->base != NULL)
       free(buf->base);
     return;
   }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
   Environment* env = wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -429,6 +649,89 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
 }
 
 
+void UDPWrap::OnRecvBatch(ssize_t nread,
+                          const uv_buf_t* buf,
+                          const struct sockaddr* addr,
+                          unsigned int flags) {
+  if (nread < 0) {
+    FlushRecvBatch();
+
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+    Local<Value> argv[] = {
+      Integer::New(env()->isolate(), nread),
+      object(),
+      Undefined(env()->isolate()),
+      Undefined(env()->isolate())
+    };
+    MakeCallback(env()->onmessage_string(), ARRAY_SIZE(argv), argv);
+    return;
+  }
+
+  // Either nothing to read or libuv is handing back the receive buffer after
+  // a recvmmsg() batch. Whatever has been collected goes out now.
+  if (nread == 0 && addr == NULL)
+    return FlushRecvBatch();
+
+  Datagram* datagram = &recv_batch_datagrams_[recv_batch_count_++];
+  datagram->data = buf->base;
+  datagram->length = nread;
+  datagram->has_address = (addr != NULL);
+  if (addr != NULL) {
+    size_t addrlen = (addr->sa_family == AF_INET6) ? sizeof(sockaddr_in6) :
+                                                     sizeof(sockaddr_in);
+    memcpy(&datagram->address, addr, addrlen);
+  }
+
+  // Outside a recvmmsg() batch, the next read reuses the buffer right away.
+  if (!(flags & UV_UDP_MMSG_CHUNK) || recv_batch_count_ == kMaxRecvBatch)
+    FlushRecvBatch();
+}
+
+
+void UDPWrap::FlushRecvBatch() {
+  const unsigned int count = recv_batch_count_;
+  if (count == 0)
+    return;
+  recv_batch_count_ = 0;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  size_t size = 0;
+  for (unsigned int i = 0; i < count; i++)
+    size += recv_batch_datagrams_[i].length;
+
+  Local<Object> buffer = Buffer::New(env, size);
+  Local<Array> lengths = Array::New(env->isolate(), count);
+  Local<Array> rinfos = Array::New(env->isolate(), count);
+  char* data = Buffer::Data(buffer);
+
+  for (unsigned int i = 0; i < count; i++) {
+    const Datagram* datagram = &recv_batch_datagrams_[i];
+    memcpy(data, datagram->data, datagram->length);
+    data += datagram->length;
+    lengths->Set(i, Integer::NewFromUnsigned(env->isolate(),
+                                             datagram->length));
+    if (datagram->has_address) {
+      const sockaddr* addr =
+          reinterpret_cast<const sockaddr*>(&datagram->address);
+      rinfos->Set(i, AddressToJS(env, addr));
+    }
+  }
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), count),
+    object(),
+    buffer,
+    lengths,
+    rinfos
+  };
+  MakeCallback(env->onmessages_string(), ARRAY_SIZE(argv), argv);
+}
+
+
 Local<Object> UDPWrap::Instantiate(Environment* env) {
   // If this assert fires then Initialize hasn't been called yet.
   assert(env->udp_constructor_function().IsEmpty() == false);
@@ -42,6 +42,8 @@ class UDPWrap: public HandleWrap {
   static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStop(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetSockName(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -64,6 +66,8 @@ class UDPWrap: public HandleWrap {
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
 
@@ -71,13 +75,37 @@ class UDPWrap: public HandleWrap {
                       size_t suggested_size,
                       uv_buf_t* buf);
   static void OnSend(uv_udp_send_t* req, int status);
+  static void OnSendBatch(uv_udp_send_t* req, int status);
   static void OnRecv(uv_udp_t* handle,
                      ssize_t nread,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags);
 
+  // Batched receive mode, see UV_UDP_RECVMMSG. Datagrams are collected until
+  // libuv hands back the receive buffer and then delivered to JS together,
+  // copied into a single Buffer.
+  struct Datagram {
+    const char* data;
+    size_t length;
+    bool has_address;
+    struct sockaddr_storage address;
+  };
+
+  static const unsigned int kMaxRecvBatch = 32;
+
+  void OnRecvBatch(ssize_t nread,
+                   const uv_buf_t* buf,
+                   const struct sockaddr* addr,
+                   unsigned int flags);
+  void FlushRecvBatch();
+
   uv_udp_t handle_;
+  bool recv_batch_;
+  char* recv_batch_buffer_;
+  size_t recv_batch_buffer_size_;
+  unsigned int recv_batch_count_;
+  Datagram recv_batch_datagrams_[kMaxRecvBatch];
 };
 
 }  // namespace node
@@ -33,8 +33,12 @@ using v8::FunctionTemplate;
 using v8::Handle;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::String;
+using v8::Uint32;
 using v8::Value;
 
 
@@ -49,12 +53,46 @@ void ErrName(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+static Local<Object> WorkClassStatistics(Environment* env,
+                                         const uv_work_class_stats_t* s) {
+  Isolate* isolate = env->isolate();
+  Local<Object> info = Object::New(isolate);
+#define V(name)                                                               \
+  info->Set(env->name ## _string(), Number::New(isolate, s->name))
+  V(queued);
+  V(dispatched);
+  V(wait_time);
+  V(max_wait_time);
+#undef V
+  return info;
+}
+
+
+void GetThreadpoolStatistics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+  uv_threadpool_stats_t s;
+  uv_threadpool_stats(&s);
+  Local<Object> info = Object::New(env->isolate());
+  info->Set(env->threads_string(),
+            Uint32::NewFromUnsigned(env->isolate(), s.threads));
+  info->Set(env->fast_io_string(),
+            WorkClassStatistics(env, &s.classes[UV_WORK_FAST_IO]));
+  info->Set(env->cpu_string(),
+            WorkClassStatistics(env, &s.classes[UV_WORK_CPU]));
+  info->Set(env->slow_io_string(),
+            WorkClassStatistics(env, &s.classes[UV_WORK_SLOW_IO]));
+  args.GetReturnValue().Set(info);
+}
+
+
 void Initialize(Handle<Object> target,
                 Handle<Value> unused,
                 Handle<Context> context) {
   Environment* env = Environment::GetCurrent(context);
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "errname"),
               FunctionTemplate::New(env->isolate(), ErrName)->GetFunction());
+  NODE_SET_METHOD(target, "getThreadpoolStatistics", GetThreadpoolStatistics);
 #define V(name, _)                                                            \
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "UV_" # name),            \
               Integer::New(env->isolate(), UV_ ## name));
@@ -0,0 +1,109 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Base64 and hex are encoded and decoded in blocks where the CPU allows it.
+// Check lengths around every block size against a plain JS implementation.
+
+var common = require('../common');
+var assert = require('assert');
+
+var alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZ' +
+               'abcdefghijklmnopqrstuvwxyz' +
+               '0123456789+/';
+
+function base64(buf) {
+  var s = '';
+  for (var i = 0; i < buf.length; i += 3) {
+    var n = buf[i] << 16 | (buf[i + 1] | 0) << 8 | (buf[i + 2] | 0);
+    s += alphabet[n >> 18] + alphabet[n >> 12 & 63];
+    s += i + 1 < buf.length ? alphabet[n >> 6 & 63] : '=';
+    s += i + 2 < buf.length ? alphabet[n & 63] : '=';
+  }
+  return s;
+}
+
+function hex(buf) {
+  var s = '';
+  for (var i = 0; i < buf.length; i++)
+    s += (buf[i] < 16 ? '0' : '') + buf[i].toString(16);
+  return s;
+}
+
+function random(length) {
+  var buf = new Buffer(length);
+  for (var i = 0; i < length; i++)
+    buf[i] = Math.random() * 256;
+  return buf;
+}
+
+var lengths = [];
+for (var i = 0; i <= 200; i++)
+  lengths.push(i);
+lengths.push(1000, 4095, 4096, 4097, 100000);
+
+lengths.forEach(function(length) {
+  var buf = random(length);
+  var b64 = base64(buf);
+  var hx = hex(buf);
+
+  assert.equal(buf.toString('base64'), b64);
+  assert.equal(buf.toString('hex'), hx);
+
+  assert.deepEqual(new Buffer(b64, 'base64'), buf);
+  assert.deepEqual(new Buffer(b64.replace(/=+$/, ''), 'base64'), buf);
+  assert.deepEqual(new Buffer(b64.replace(/\+/g, '-').replace(/\//g, '_'),
+                              'base64'),
+                   buf);
+  assert.deepEqual(new Buffer(hx, 'hex'), buf);
+  assert.deepEqual(new Buffer(hx.toUpperCase(), 'hex'), buf);
+
+  assert.equal(Buffer.byteLength(b64, 'base64'), length);
+  assert.equal(Buffer.byteLength(b64.replace(/=+$/, ''), 'base64'), length);
+
+  // Line breaks, as in MIME, and stray characters are skipped.
+  var wrapped = b64.replace(/.{76}/g, '$&\r\n');
+  assert.deepEqual(new Buffer(wrapped, 'base64').slice(0, length), buf);
+  if (length > 0) {
+    var at = Math.floor(Math.random() * b64.length);
+    var dirty = b64.slice(0, at) + ' \u00ff*' + b64.slice(at);
+    assert.deepEqual(new Buffer(dirty, 'base64').slice(0, length), buf);
+    // Not representable in one byte, takes the two-byte path.
+    dirty = b64.slice(0, at) + '\u2603' + b64.slice(at);
+    assert.deepEqual(new Buffer(dirty, 'base64').slice(0, length), buf);
+  }
+
+  // Decoding stops when the buffer is full.
+  var half = length >> 1;
+  var target = new Buffer(half);
+  assert.equal(target.write(b64, 0, half, 'base64'), half);
+  assert.deepEqual(target, buf.slice(0, half));
+  assert.equal(target.write(hx, 0, half, 'hex'), half);
+  assert.deepEqual(target, buf.slice(0, half));
+
+  // And at the first pair that isn't hex.
+  if (length > 0) {
+    var bad = Math.floor(Math.random() * length);
+    var broken = hx.slice(0, bad * 2) + 'zz' + hx.slice(bad * 2 + 2);
+    target = new Buffer(length);
+    assert.equal(target.write(broken, 0, length, 'hex'), bad);
+    assert.deepEqual(target.slice(0, bad), buf.slice(0, bad));
+  }
+});
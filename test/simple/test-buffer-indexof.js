@@ -0,0 +1,161 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+var b = new Buffer('abcdef');
+var buf_a = new Buffer('a');
+var buf_bc = new Buffer('bc');
+var buf_f = new Buffer('f');
+var buf_z = new Buffer('z');
+var buf_empty = new Buffer('');
+
+assert.equal(b.indexOf('a'), 0);
+assert.equal(b.indexOf('a', 1), -1);
+assert.equal(b.indexOf('a', -1), -1);
+assert.equal(b.indexOf('a', -4), -1);
+assert.equal(b.indexOf('a', -b.length), 0);
+assert.equal(b.indexOf('a', NaN), 0);
+assert.equal(b.indexOf('a', -Infinity), 0);
+assert.equal(b.indexOf('a', Infinity), -1);
+assert.equal(b.indexOf('bc'), 1);
+assert.equal(b.indexOf('bc', 2), -1);
+assert.equal(b.indexOf('bc', -1), -1);
+assert.equal(b.indexOf('bc', -3), -1);
+assert.equal(b.indexOf('bc', -5), 1);
+assert.equal(b.indexOf('bc', 1.9), 1);
+assert.equal(b.indexOf('f'), b.length - 1);
+assert.equal(b.indexOf('z'), -1);
+assert.equal(b.indexOf('abcdefg'), -1);
+assert.equal(b.indexOf(''), 0);
+assert.equal(b.indexOf('', 3), 3);
+assert.equal(b.indexOf('', b.length + 1), b.length);
+assert.equal(b.indexOf(buf_a), 0);
+assert.equal(b.indexOf(buf_a, 1), -1);
+assert.equal(b.indexOf(buf_bc), 1);
+assert.equal(b.indexOf(buf_bc, 2), -1);
+assert.equal(b.indexOf(buf_f), b.length - 1);
+assert.equal(b.indexOf(buf_z), -1);
+assert.equal(b.indexOf(buf_empty), 0);
+assert.equal(b.indexOf(0x61), 0);
+assert.equal(b.indexOf(0x61, 1), -1);
+assert.equal(b.indexOf(0x66), b.length - 1);
+assert.equal(b.indexOf(0x66 + 256), b.length - 1);
+assert.equal(b.indexOf(-159), 0);
+assert.equal(b.indexOf(0x7a), -1);
+
+assert.equal(b.lastIndexOf('a'), 0);
+assert.equal(b.lastIndexOf('a', 0), 0);
+assert.equal(b.lastIndexOf('a', -b.length), 0);
+assert.equal(b.lastIndexOf('a', -b.length - 1), -1);
+assert.equal(b.lastIndexOf('f'), b.length - 1);
+assert.equal(b.lastIndexOf('f', -2), -1);
+assert.equal(b.lastIndexOf('bc'), 1);
+assert.equal(b.lastIndexOf('bc', 1), 1);
+assert.equal(b.lastIndexOf('bc', 0), -1);
+assert.equal(b.lastIndexOf(''), b.length);
+assert.equal(b.lastIndexOf('', 2), 2);
+assert.equal(b.lastIndexOf(buf_bc, Infinity), 1);
+assert.equal(b.lastIndexOf(0x66), b.length - 1);
+assert.equal(b.lastIndexOf(0x66, 4), -1);
+
+assert.equal(b.includes('cd'), true);
+assert.equal(b.includes('cd', 3), false);
+assert.equal(b.includes(buf_z), false);
+assert.equal(b.includes(0x64), true);
+
+// Needles in other encodings.
+assert.equal(b.indexOf('YmM=', 'base64'), 1);
+assert.equal(b.indexOf('YmM=', 0, 'base64'), 1);
+assert.equal(b.indexOf('6263', 'hex'), 1);
+assert.equal(b.indexOf('6263', 2, 'hex'), -1);
+assert.equal(b.lastIndexOf('6263', 'hex'), 1);
+var ucs2 = new Buffer('\u00e9t\u00e9 \u00e9t\u00e9', 'ucs2');
+assert.equal(ucs2.indexOf('t\u00e9', 'ucs2'), 2);
+assert.equal(ucs2.lastIndexOf('t\u00e9', 'ucs2'), 10);
+var utf8 = new Buffer('\u00e9t\u00e9 \u00e9t\u00e9');
+assert.equal(utf8.indexOf('\u00e9t'), 0);
+assert.equal(utf8.indexOf('\u00e9t', 1), 6);
+assert.equal(utf8.indexOf('\u00e9', 'binary'), -1);
+assert.equal(new Buffer([0xe9]).indexOf('\u00e9', 'binary'), 0);
+
+assert.throws(function() {
+  b.indexOf({});
+}, TypeError);
+assert.throws(function() {
+  b.indexOf('a', 0, 'not an encoding');
+}, TypeError);
+
+// Delimiters, the common case, against a straightforward search. Long and
+// short needles, both sides of the vectorized blocks and enough distance for
+// the skip tables to come into play.
+function naiveIndexOf(haystack, needle, from) {
+  for (var i = from; i + needle.length <= haystack.length; i++) {
+    for (var k = 0; k < needle.length && haystack[i + k] === needle[k]; k++);
+    if (k === needle.length)
+      return i;
+  }
+  return -1;
+}
+
+function naiveLastIndexOf(haystack, needle, from) {
+  for (var i = Math.min(from, haystack.length - needle.length); i >= 0; i--) {
+    for (var k = 0; k < needle.length && haystack[i + k] === needle[k]; k++);
+    if (k === needle.length)
+      return i;
+  }
+  return -1;
+}
+
+var seed = 1;
+function random(n) {
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return seed % n;
+}
+
+for (var round = 0; round < 2000; round++) {
+  var haystack = new Buffer(random(round % 10 === 0 ? 2000 : 100));
+  var alphabet = 1 + random(3);
+  for (var i = 0; i < haystack.length; i++)
+    haystack[i] = 0x61 + random(alphabet);
+  var needle = new Buffer(1 + random(round % 10 === 1 ? 40 : 6));
+  for (var i = 0; i < needle.length; i++)
+    needle[i] = 0x61 + random(alphabet);
+  var from = random(haystack.length + 1);
+
+  assert.equal(haystack.indexOf(needle, from),
+               naiveIndexOf(haystack, needle, from));
+  assert.equal(haystack.indexOf(needle.toString(), from),
+               naiveIndexOf(haystack, needle, from));
+  assert.equal(haystack.lastIndexOf(needle, from),
+               naiveLastIndexOf(haystack, needle, from));
+  assert.equal(haystack.lastIndexOf(needle),
+               naiveLastIndexOf(haystack, needle, haystack.length));
+}
+
+// Needles that don't fit on the stack.
+var long = new Buffer(100000);
+long.fill(0x61);
+long.write('b', long.length - 1);
+assert.equal(long.indexOf(long.toString('utf8', 50000)), 50000);
+assert.equal(long.indexOf(long.slice(1)), 1);
+assert.equal(long.lastIndexOf(long.toString('hex', 0, 50000), 'hex'), 49999);
@@ -0,0 +1,78 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+function repeat(s, n) {
+  return new Array(n + 1).join(s);
+}
+
+// Put the interesting characters everywhere around the 16 and 32 byte blocks
+// that the vectorized code works in, both at the start of a buffer and at an
+// odd offset into one.
+var samples = [
+  '',
+  '\u0080', '\u00e9', '\u00ff',  // two bytes, still one byte wide
+  '\u0100', '\u07ff', '\u0800', '\u4e2d',
+  '\ufeff', '\uffff',  // the BOM is kept
+  '\ud800\udc00', '\ud83d\ude00', '\udbff\udfff',
+  'a\u00e9\u4e2d\ud83d\ude00'
+];
+
+samples.forEach(function(sample) {
+  for (var i = 0; i < 70; i++) {
+    var s = repeat('x', i) + sample + repeat('y', 70 - i);
+    assert.equal(new Buffer(s).toString('utf8'), s);
+    assert.equal(new Buffer('!' + s).slice(1).toString('utf8'), s);
+  }
+});
+
+// Malformed input goes to V8, which decides on replacement characters. Lone
+// surrogates come through as they are, StringDecoder relies on that for
+// CESU-8.
+[
+  [[0xff], '\ufffd'],
+  [[0x80], '\ufffd'],
+  [[0xc3, 0x41], '\ufffdA'],
+  [[0xc0, 0x80], '\ufffd\ufffd'],
+  [[0xe0, 0x80, 0x80], '\ufffd\ufffd\ufffd'],
+  [[0xf0, 0x9f, 0x98, 0x41], '\ufffd\ufffd\ufffdA'],
+  [[0xed, 0xa0, 0x80], '\ud800'],
+  [[0xed, 0xa0, 0xbd, 0xed, 0xb8, 0x80], '\ud83d\ude00']
+].forEach(function(test) {
+  for (var i = 0; i < 70; i++) {
+    var head = repeat('x', i);
+    var tail = repeat('y', 70 - i);
+    var b = Buffer.concat([new Buffer(head),
+                           new Buffer(test[0]),
+                           new Buffer(tail)]);
+    assert.equal(b.toString('utf8'), head + test[1] + tail);
+  }
+});
+
+// Large enough for ASCII to become an external string.
+['a', '\u00e9', '\u4e2d', '\ud83d\ude00'].forEach(function(c) {
+  var s = repeat(c, (1100 * 1000 / Buffer.byteLength(c)) | 0);
+  var b = new Buffer(s);
+  assert.equal(b.toString('utf8'), s);
+  assert.equal(new Buffer(b.toString('utf8'), 'ucs2').toString('ucs2'), s);
+});
@@ -0,0 +1,147 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var assert = require('assert');
+var common = require('../common');
+var fork = require('child_process').fork;
+var net = require('net');
+
+var big = new Buffer(256 * 1024);
+for (var i = 0; i < big.length; i++) big[i] = i % 251;
+
+if (process.argv[2] === 'child') {
+  assert.equal(process.env.NODE_CHANNEL_SERIALIZATION, undefined);
+  var server;
+  process.on('message', function(m, handle) {
+    if (m === 'server') {
+      server = handle;
+      server.on('connection', function(socket) {
+        socket.end('hello from child');
+      });
+      process.send('server');
+    } else if (m === 'done') {
+      server.close();
+      process.removeAllListeners('message');
+    } else {
+      process.send(m);
+    }
+  });
+  return;
+}
+
+var values = [
+  null,
+  true,
+  false,
+  0,
+  -1,
+  2147483647,
+  2147483648,
+  -0.5,
+  1e300,
+  '',
+  'hello',
+  'café',
+  '☃ snowman 💩',
+  [],
+  [1, 'two', [3], { four: 4 }],
+  { a: 1, b: { c: [true, null], d: 'x' }, 'ü': 'key' },
+  { buf: new Buffer('binary\u0000data'), nested: [new Buffer(0)] },
+  big
+];
+
+var n = fork(__filename, ['child'], { serialization: 'binary' });
+
+// Same rules as JSON for things that can't be represented.
+var obj = { a: 1 };
+obj.self = obj;
+assert.throws(function() { n.send(obj); }, /circular/);
+assert.throws(function() { n.send(undefined); }, TypeError);
+assert.throws(function() {
+  fork(__filename, ['child'], { serialization: 'xml' });
+}, TypeError);
+
+var received = [];
+n.on('message', function(m) {
+  if (m === 'server') return;
+  received.push(m);
+  if (received.length === values.length + 3) sendServer();
+});
+
+values.forEach(function(v) { n.send(v); });
+n.send({
+  date: new Date(0),
+  fn: function() {},
+  undef: undefined,
+  list: [undefined, function() {}],
+  str: new String('boxed'),
+  nan: NaN
+});
+// An own "__proto__" key stays an own property, like JSON.parse() makes it.
+n.send(JSON.parse('{"__proto__":{"x":1},"y":2}'));
+// Keys are dropped when toJSON() returns something that can't be sent.
+n.send({ a: { toJSON: function() {} }, b: [{ toJSON: function() {} }] });
+
+function sendServer() {
+  var server = net.createServer();
+  server.listen(common.PORT, function() {
+    n.send('server', server);
+    n.once('message', function(m) {
+      assert.equal(m, 'server');
+      server.close();
+      net.connect(common.PORT, function() {
+        var data = '';
+        this.setEncoding('utf8');
+        this.on('data', function(s) { data += s; });
+        this.on('end', function() {
+          assert.equal(data, 'hello from child');
+          n.send('done');
+        });
+      });
+    });
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(received.length, values.length + 3);
+  values.forEach(function(v, i) {
+    assert.deepEqual(received[i], v);
+  });
+  assert(Buffer.isBuffer(received[values.length - 1]));
+  assert(Buffer.isBuffer(received[values.length - 2].buf));
+  assert.equal(received[values.length - 1].toString('hex'),
+               big.toString('hex'));
+  var last = received[values.length];
+  assert(isNaN(last.nan));
+  delete last.nan;
+  assert.deepEqual(last, {
+    date: '1970-01-01T00:00:00.000Z',
+    list: [null, null],
+    str: 'boxed'
+  });
+  var proto = received[values.length + 1];
+  assert(proto.hasOwnProperty('__proto__'));
+  assert.equal(Object.getPrototypeOf(proto), Object.prototype);
+  assert.equal(proto.x, undefined);
+  assert.deepEqual(Object.keys(proto), ['__proto__', 'y']);
+  assert.deepEqual(received[values.length + 2], { b: [null] });
+  assert(!received[values.length + 2].hasOwnProperty('a'));
+});
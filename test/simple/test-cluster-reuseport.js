@@ -0,0 +1,80 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var net = require('net');
+
+if (cluster.isWorker) {
+  var server = net.createServer(function(socket) {
+    socket.end(String(cluster.worker.id));
+  });
+  server.listen(common.PORT, function() {
+    // Every worker has a listen socket of its own.
+    assert(server._handle.fd >= 0);
+    var ephemeral = net.createServer(assert.fail).listen(0, function() {
+      process.send({ port: ephemeral.address().port });
+    });
+  });
+  return;
+}
+
+cluster.schedulingPolicy = cluster.SCHED_REUSEPORT;
+
+var workers = 2;
+var connections = 64;
+var ports = [];
+var served = {};
+
+for (var i = 0; i < workers; i++) {
+  cluster.fork().on('message', function(message) {
+    ports.push(message.port);
+    if (ports.length === workers) connect();
+  });
+}
+
+function connect() {
+  // Workers that listen on port 0 all end up on the same port.
+  assert.equal(ports[0], ports[1]);
+
+  var pending = connections;
+  for (var i = 0; i < connections; i++) {
+    net.connect(common.PORT, function() {
+      var id = '';
+      this.setEncoding('utf8');
+      this.on('data', function(s) { id += s; });
+      this.on('end', function() {
+        served[id] = (served[id] | 0) + 1;
+        if (--pending === 0) cluster.disconnect();
+      });
+    });
+  }
+}
+
+process.on('exit', function() {
+  var total = 0;
+  for (var id in served) total += served[id];
+  assert.equal(total, connections);
+  // The kernel hashes connections over the sockets. The odds of all of
+  // them going to one worker are negligible.
+  assert.equal(Object.keys(served).length, workers);
+});
@@ -0,0 +1,125 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var net = require('net');
+
+if (cluster.isWorker) {
+  var sockets = [];
+  net.createServer(function(socket) {
+    sockets.push(socket);
+    socket.write(String(cluster.worker.id));
+  }).listen(common.PORT);
+  process.on('message', function(message) {
+    if (message.block) {
+      // Keep the event loop from running, like a worker stuck in a loop.
+      for (var end = Date.now() + message.block; Date.now() < end;);
+      return;
+    }
+    if (message !== 'close') return;
+    sockets.forEach(function(socket) { socket.destroy(); });
+    sockets = [];
+    process.send('closed');
+  });
+  return;
+}
+
+cluster.schedulingPolicy = cluster.SCHED_RR;
+assert.throws(function() {
+  cluster.setupMaster({ balance: 'random' });
+}, /Bad cluster.settings.balance/);
+cluster.setupMaster({ balance: 'least-connections' });
+
+var workers = [cluster.fork(), cluster.fork()];
+var clients = [];
+
+var listening = 0;
+cluster.on('listening', function() {
+  if (++listening === 2) open(20, afterFirstRound);
+  if (listening === 4) leastLag();
+});
+
+// Opens `n` long-lived connections and tallies where they ended up.
+function open(n, cb) {
+  var tally = {};
+  var pending = n;
+  for (var i = 0; i < n; i++) {
+    var client = net.connect(common.PORT);
+    client.setEncoding('utf8');
+    client.once('data', function(id) {
+      tally[id] = (tally[id] | 0) + 1;
+      if (--pending === 0) cb(tally);
+    });
+    clients.push(client);
+  }
+}
+
+function afterFirstRound(tally) {
+  assert.equal(tally[workers[0].id], 10);
+  assert.equal(tally[workers[1].id], 10);
+  assert.equal(workers[0].load.handoffs, 10);
+  assert.equal(workers[1].load.handoffs, 10);
+
+  // Empty the first worker. Round-robin would keep splitting new
+  // connections evenly, least-connections sends them all to it.
+  workers[0].send('close');
+  workers[0].once('message', function() {
+    waitForReport(function() {
+      assert.equal(workers[0].load.connections, 0);
+      assert.equal(workers[1].load.connections, 10);
+      open(10, afterSecondRound);
+    });
+  });
+}
+
+function waitForReport(cb) {
+  (function poll() {
+    if (workers[0].load.connections === 0 &&
+        workers[1].load.connections === 10) {
+      return cb();
+    }
+    setTimeout(poll, 50);
+  })();
+}
+
+function afterSecondRound(tally) {
+  assert.equal(tally[workers[0].id], 10);
+  assert.equal(tally[workers[1].id], undefined);
+  clients.forEach(function(client) { client.destroy(); });
+  clients = [];
+  cluster.disconnect(function() {
+    cluster.setupMaster({ balance: 'least-lag' });
+    workers = [cluster.fork(), cluster.fork()];
+  });
+}
+
+// A worker that is stuck gets at most the one connection that it was sent
+// before it stopped responding, the others don't wait for it.
+function leastLag() {
+  workers[1].send({ block: 2000 });
+  open(10, function(tally) {
+    assert(tally[workers[0].id] >= 9);
+    clients.forEach(function(client) { client.destroy(); });
+    cluster.disconnect();
+  });
+}
@@ -0,0 +1,101 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+var COUNT = 50;
+var buffers = [];
+var received = {};
+var messages = 0;
+var batches = 0;
+var sendCallbacks = 0;
+var ports = [];
+
+var server = dgram.createSocket({ type: 'udp4', batch: true });
+// Only batch sockets send with sendmmsg(), the other one sends the datagrams
+// of a batch one by one.
+var clients = [
+  dgram.createSocket('udp4'),
+  dgram.createSocket({ type: 'udp4', batch: true })
+];
+
+server.on('messages', function(msgs, rinfos) {
+  assert.ok(msgs.length > 0);
+  assert.equal(msgs.length, rinfos.length);
+  batches++;
+
+  for (var i = 0; i < msgs.length; i++) {
+    assert.ok(Buffer.isBuffer(msgs[i]));
+    assert.equal(rinfos[i].address, '127.0.0.1');
+    assert.equal(rinfos[i].size, msgs[i].length);
+    var port = rinfos[i].port;
+    (received[port] = received[port] || []).push(msgs[i].toString());
+    messages++;
+  }
+
+  if (messages === COUNT * clients.length) {
+    server.close();
+    clients.forEach(function(client) {
+      ports.push(client.address().port);
+      client.close();
+    });
+  }
+});
+
+server.bind(common.PORT, '127.0.0.1', function() {
+  for (var i = 0; i < COUNT; i++)
+    buffers.push(new Buffer('datagram ' + i + new Array(i + 1).join('x')));
+
+  var total = buffers.reduce(function(n, b) { return n + b.length; }, 0);
+
+  clients.forEach(function(client) {
+    client.sendBatch(buffers, common.PORT, '127.0.0.1', function(err, bytes) {
+      assert.ifError(err);
+      assert.equal(bytes, total);
+      sendCallbacks++;
+    });
+  });
+});
+
+assert.throws(function() {
+  clients[0].sendBatch('not an array', common.PORT, '127.0.0.1');
+}, TypeError);
+
+// Strings are converted to buffers without touching the caller's array.
+var strings = ['left alone'];
+assert.throws(function() {
+  clients[0].sendBatch(strings, 0, '127.0.0.1');
+}, RangeError);
+assert.equal(typeof strings[0], 'string');
+
+process.on('exit', function() {
+  assert.equal(sendCallbacks, clients.length);
+  assert.equal(messages, COUNT * clients.length);
+  assert.ok(batches <= COUNT * clients.length);
+  // Loopback does not reorder datagrams.
+  ports.forEach(function(port) {
+    assert.equal(received[port].length, COUNT);
+    for (var i = 0; i < COUNT; i++)
+      assert.equal(received[port][i], buffers[i].toString());
+  });
+});
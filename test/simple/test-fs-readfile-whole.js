@@ -0,0 +1,85 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+
+// fs.readFile() reads the whole file in one go in the binding. Check it
+// still behaves like open, fstat, read and close.
+var file = path.join(common.fixturesDir, 'elipses.txt');
+var expected = fs.readFileSync(file);
+var checks = 0;
+
+fs.readFile(file, function(err, data) {
+  assert.ifError(err);
+  assert(Buffer.isBuffer(data));
+  assert.equal(data.toString('hex'), expected.toString('hex'));
+  checks++;
+});
+
+fs.readFile(file, 'utf8', function(err, data) {
+  assert.ifError(err);
+  assert.equal(data, expected.toString('utf8'));
+  assert.equal(fs.readFileSync(file, 'base64'), expected.toString('base64'));
+  checks++;
+});
+
+var empty = path.join(common.fixturesDir, 'empty.txt');
+fs.readFile(empty, function(err, data) {
+  assert.ifError(err);
+  assert.equal(data.length, 0);
+  assert.equal(fs.readFileSync(empty, 'utf8'), '');
+  checks++;
+});
+
+var missing = path.join(common.fixturesDir, 'does-not-exist');
+fs.readFile(missing, function(err, data) {
+  assert.equal(err.code, 'ENOENT');
+  assert.equal(err.path, missing);
+  assert.equal(data, undefined);
+  assert.throws(function() {
+    fs.readFileSync(missing);
+  }, /ENOENT/);
+  checks++;
+});
+
+fs.readFile(common.fixturesDir, function(err) {
+  assert.equal(err.code, 'EISDIR');
+  checks++;
+});
+
+// Files that claim to be empty are read until EOF
+if (fs.existsSync('/proc/self/cmdline')) {
+  fs.readFile('/proc/self/cmdline', 'utf8', function(err, data) {
+    assert.ifError(err);
+    assert.notEqual(data.indexOf(path.basename(__filename)), -1);
+    assert.equal(data, fs.readFileSync('/proc/self/cmdline', 'utf8'));
+    checks++;
+  });
+} else {
+  checks++;
+}
+
+process.on('exit', function() {
+  assert.equal(checks, 6);
+});
@@ -0,0 +1,125 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var path = require('path');
+var fs = require('fs');
+
+var filename = path.join(common.tmpDir, 'writev.txt');
+var expected = 'hello, vectored world\n';
+var chunks = ['hello', ', ', 'vectored', ' world\n'].map(function(s) {
+  return new Buffer(s);
+});
+
+function cleanup() {
+  try { fs.unlinkSync(filename); } catch (e) {}
+}
+
+// sync
+cleanup();
+var fd = fs.openSync(filename, 'w+');
+assert.equal(fs.writevSync(fd, chunks), expected.length);
+assert.equal(fs.writevSync(fd, [new Buffer('HELLO')], 0), 5);
+var a = new Buffer(5);
+var b = new Buffer(expected.length - 5);
+assert.equal(fs.readvSync(fd, [a, b], 0), expected.length);
+assert.equal(a.toString() + b.toString(), 'HELLO' + expected.slice(5));
+assert.equal(fs.readvSync(fd, [a], expected.length), 0);
+fs.closeSync(fd);
+
+assert.throws(function() {
+  fs.writevSync(fd, 'nope');
+}, TypeError);
+assert.throws(function() {
+  fs.writevSync(1, [new Buffer(1), 'nope']);
+}, /buffers/);
+assert.throws(function() {
+  fs.readvSync(1, [new Buffer(1), {}]);
+}, /buffers/);
+assert.throws(function() {
+  fs.writevSync('nope', [new Buffer(1)]);
+}, /Bad argument/);
+assert.throws(function() {
+  fs.readvSync('nope', [new Buffer(1)]);
+}, /Bad argument/);
+
+// async
+cleanup();
+fd = fs.openSync(filename, 'w+');
+fs.writev(fd, chunks, function(err, written, buffers) {
+  if (err) throw err;
+  assert.equal(written, expected.length);
+  assert.strictEqual(buffers, chunks);
+  var a = new Buffer(3);
+  var b = new Buffer(100);
+  fs.readv(fd, [a, b], 0, common.mustCall(function(err, bytesRead, buffers) {
+    if (err) throw err;
+    assert.equal(bytesRead, expected.length);
+    assert.equal(buffers[0].toString() +
+                 buffers[1].toString('utf8', 0, bytesRead - 3),
+                 expected);
+    fs.closeSync(fd);
+    writeStream();
+  }));
+});
+
+// Chunks that queue up behind a pending write go out in one writev().
+function writeStream() {
+  cleanup();
+  var writev = fs.writev;
+  var calls = 0;
+  fs.writev = function() {
+    calls++;
+    return writev.apply(this, arguments);
+  };
+
+  var stream = fs.createWriteStream(filename);
+  var lines = [];
+  // More than IOV_MAX chunks, so writev() writes short and the stream has
+  // to finish the job.
+  for (var i = 0; i < 5000; i++) {
+    lines.push('line ' + i + '\n');
+    stream.write(lines[i]);
+  }
+  stream.end(common.mustCall(function() {
+    fs.writev = writev;
+    assert(calls >= 1);
+    assert.equal(stream.bytesWritten, Buffer.byteLength(lines.join('')));
+    assert.equal(fs.readFileSync(filename, 'utf8'), lines.join(''));
+    positionalStream();
+  }));
+}
+
+function positionalStream() {
+  fs.writeFileSync(filename, 'xxxxxxxxxxxxxxx');
+  var stream = fs.createWriteStream(filename, { flags: 'r+', start: 5 });
+  stream.cork();
+  stream.write('a');
+  stream.write('bc');
+  stream.write('def');
+  stream.uncork();
+  stream.end(common.mustCall(function() {
+    assert.equal(stream.bytesWritten, 6);
+    assert.equal(fs.readFileSync(filename, 'utf8'), 'xxxxxabcdefxxxx');
+    cleanup();
+  }));
+}
@@ -0,0 +1,100 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+var HTTPParser = process.binding('http_parser').HTTPParser;
+
+// The parser tags common header names with an id and JS land uses the
+// interned names for them. Spelling and case must not change what
+// .headers and .rawHeaders report.
+assert.equal(HTTPParser.headerNames[0], undefined);
+assert.notEqual(HTTPParser.headerNames.indexOf('content-length'), -1);
+assert.notEqual(HTTPParser.rawHeaderNames.indexOf('Content-Length'), -1);
+HTTPParser.headerNames.forEach(function(name, id) {
+  assert.equal(name, HTTPParser.rawHeaderNames[id].toLowerCase());
+});
+
+var request = [
+  'POST / HTTP/1.1',
+  'Host: first',
+  'HOST: second',
+  'accept: text/html',
+  'Accept: text/plain',
+  'Set-Cookie: a=1',
+  'SET-COOKIE: b=2',
+  'content-TYPE: text/plain',
+  'Content-Lengthy: no',
+  'TE: trailers',
+  'Hos: no',
+  'Content-Length: 2',
+  'Connection: close',
+  '',
+  'ok'
+].join('\r\n');
+
+var server = http.createServer(function(req, res) {
+  // Looked up before the block is parsed
+  assert.equal(req._getHeader('host'), 'first');
+  assert.equal(req._getHeader('accept'), 'text/html, text/plain');
+  assert.equal(req._getHeader('content-lengthy'), 'no');
+  assert.equal(req._getHeader('hos'), 'no');
+
+  assert.deepEqual(req.headers, {
+    'host': 'first',
+    'accept': 'text/html, text/plain',
+    'set-cookie': ['a=1', 'b=2'],
+    'content-type': 'text/plain',
+    'content-lengthy': 'no',
+    'te': 'trailers',
+    'hos': 'no',
+    'content-length': '2',
+    'connection': 'close'
+  });
+  assert.deepEqual(req.rawHeaders, [
+    'Host', 'first',
+    'HOST', 'second',
+    'accept', 'text/html',
+    'Accept', 'text/plain',
+    'Set-Cookie', 'a=1',
+    'SET-COOKIE', 'b=2',
+    'content-TYPE', 'text/plain',
+    'Content-Lengthy', 'no',
+    'TE', 'trailers',
+    'Hos', 'no',
+    'Content-Length', '2',
+    'Connection', 'close'
+  ]);
+
+  req.resume();
+  req.on('end', function() {
+    res.end();
+    server.close();
+  });
+});
+
+server.listen(common.PORT, function() {
+  var c = net.connect(common.PORT);
+  c.end(request);
+  c.resume();
+});
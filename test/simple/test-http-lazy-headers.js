@@ -0,0 +1,114 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+var util = require('util');
+
+// Headers are kept in a raw block until they're looked at. Send more than
+// fit the parser's old fixed-size table and split them across packets.
+var count = 50;
+var lines = ['GET /lazy HTTP/1.1', 'Host: localhost', 'Expect: 100-Continue'];
+for (var i = 0; i < count; i++)
+  lines.push('X-Header-' + i + ': value ' + i);
+lines.push('Set-Cookie: a=1', 'set-cookie: b=2', 'X-Dup: 1', 'x-dup: 2');
+lines.push('Connection: close', '', '');
+var request = lines.join('\r\n');
+
+var requests = 0;
+var continues = 0;
+
+var server = http.createServer(function(req, res) {
+  requests++;
+
+  // Own properties, even before the block was parsed
+  assert(req.hasOwnProperty('headers'));
+  assert(req.hasOwnProperty('rawHeaders'));
+  assert.notEqual(Object.keys(req).indexOf('headers'), -1);
+  assert.notEqual(Object.keys(req).indexOf('rawHeaders'), -1);
+
+  // Assignment happens before the block was parsed
+  var headers = req.headers;
+  req.headers = { replaced: true };
+  assert.deepEqual(req.headers, { replaced: true });
+
+  assert.equal(headers.host, 'localhost');
+  assert.equal(headers.expect, '100-Continue');
+  for (var i = 0; i < count; i++)
+    assert.equal(headers['x-header-' + i], 'value ' + i);
+  assert.deepEqual(headers['set-cookie'], ['a=1', 'b=2']);
+  assert.equal(headers['x-dup'], '1, 2');
+
+  var raw = req.rawHeaders;
+  assert.equal(raw.length, 2 * (count + 7));
+  assert.equal(raw[0], 'Host');
+  assert.equal(raw[raw.length - 2], 'Connection');
+  assert.equal(raw[raw.length - 1], 'close');
+
+  // Plain data properties once parsed
+  var copy = util._extend({}, req);
+  assert.deepEqual(copy.headers, { replaced: true });
+  assert.strictEqual(copy.rawHeaders, raw);
+  assert.strictEqual(Object.getOwnPropertyDescriptor(req, 'rawHeaders').value,
+                     raw);
+
+  res.end('ok');
+});
+
+server.on('checkContinue', function(req, res) {
+  continues++;
+  assert.equal(req._getHeader('expect'), '100-Continue');
+  assert.equal(req._getHeader('x-dup'), '1, 2');
+  assert.equal(req._getHeader('x-missing'), undefined);
+  res.writeContinue();
+  server.emit('request', req, res);
+});
+
+server.listen(common.PORT, function() {
+  var c = net.connect(common.PORT);
+  var response = '';
+  var offset = 0;
+
+  (function writeSome() {
+    if (offset >= request.length)
+      return;
+    c.write(request.slice(offset, offset + 37));
+    offset += 37;
+    setTimeout(writeSome, 1);
+  })();
+
+  c.setEncoding('utf8');
+  c.on('data', function(chunk) {
+    response += chunk;
+  });
+  c.on('end', function() {
+    assert(/^HTTP\/1\.1 100 Continue\r\n/.test(response));
+    assert(/\r\n\r\n2\r\nok\r\n/.test(response));
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(requests, 1);
+  assert.equal(continues, 1);
+});
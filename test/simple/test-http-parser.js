@@ -23,6 +23,7 @@ var common = require('../common');
 var assert = require('assert');
 
 var HTTPParser = process.binding('http_parser').HTTPParser;
+var headerBlockToArray = require('_http_incoming').headerBlockToArray;
 
 var CRLF = '\r\n';
 var REQUEST = HTTPParser.REQUEST;
@@ -48,7 +49,7 @@ function newParser(type) {
   parser.url = '';
 
   parser[kOnHeaders] = function(headers, url) {
-    parser.headers = parser.headers.concat(headers);
+    parser.headers = parser.headers.concat(headerBlockToArray(headers));
     parser.url += url;
   };
 
@@ -171,7 +172,7 @@ function expectBody(expected) {
     assert.equal(info.versionMinor, 0);
     assert.equal(info.statusCode, 200);
     assert.equal(info.statusMessage, "Connection established");
-    assert.deepEqual(info.headers || parser.headers, []);
+    assert.deepEqual(headerBlockToArray(info.headers), []);
   });
 
   parser.execute(request, 0, request.length);
@@ -197,7 +198,7 @@ function expectBody(expected) {
 
   function onHeaders(headers, url) {
     assert.ok(seen_body); // trailers should come after the body
-    assert.deepEqual(headers,
+    assert.deepEqual(headerBlockToArray(headers),
         ['Vary', '*', 'Content-Type', 'text/plain']);
   }
 
@@ -239,7 +240,7 @@ function expectBody(expected) {
     assert.equal(info.method, methods.indexOf('GET'));
     assert.equal(info.versionMajor, 1);
     assert.equal(info.versionMinor, 0);
-    assert.deepEqual(info.headers || parser.headers,
+    assert.deepEqual(headerBlockToArray(info.headers),
         ['X-Filler', '1337',
          'X-Filler', '42',
          'X-Filler2', '42']);
@@ -270,7 +271,7 @@ function expectBody(expected) {
     assert.equal(info.versionMajor, 1);
     assert.equal(info.versionMinor, 0);
 
-    var headers = info.headers || parser.headers;
+    var headers = headerBlockToArray(info.headers);
 
     assert.equal(headers.length, 2 * 256); // 256 key/value pairs
     for (var i = 0; i < headers.length; i += 2) {
@@ -485,7 +486,7 @@ function expectBody(expected) {
     assert.equal(info.url || parser.url, '/it');
     assert.equal(info.versionMajor, 1);
     assert.equal(info.versionMinor, 1);
-    assert.deepEqual(info.headers || parser.headers,
+    assert.deepEqual(headerBlockToArray(info.headers),
         ['Content-Type', 'text/plain',
          'Transfer-Encoding', 'chunked']);
   });
@@ -531,7 +532,7 @@ function expectBody(expected) {
     assert.equal(info.url, '/this');
     assert.equal(info.versionMajor, 1);
     assert.equal(info.versionMinor, 1);
-    assert.deepEqual(info.headers,
+    assert.deepEqual(headerBlockToArray(info.headers),
         ['Content-Type', 'text/plain',
          'Transfer-Encoding', 'chunked']);
   };
@@ -541,7 +542,7 @@ function expectBody(expected) {
     assert.equal(info.url, '/that');
     assert.equal(info.versionMajor, 1);
     assert.equal(info.versionMinor, 0);
-    assert.deepEqual(info.headers,
+    assert.deepEqual(headerBlockToArray(info.headers),
         ['Content-Type', 'text/plain',
          'Content-Length', '4']);
   };
@@ -0,0 +1,83 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var http = require('http');
+var path = require('path');
+
+// res.sendFile() works with chunked encoding, a Content-Length set by the
+// user and responses that have no body.
+var file = path.join(common.fixturesDir, 'sample.png');
+var data = fs.readFileSync(file);
+var fd = fs.openSync(file, 'r');
+
+var server = http.createServer(function(req, res) {
+  if (req.url === '/length')
+    res.setHeader('Content-Length', data.length + 4);
+  res.write('head');
+  res.sendFile(fd, 0, data.length, function() {
+    res.end();
+  });
+});
+
+var responses = 0;
+
+function get(method, url, next) {
+  http.request({ port: common.PORT, method: method, path: url }, function(res) {
+    var chunks = [];
+    res.on('data', function(chunk) {
+      chunks.push(chunk);
+    });
+    res.on('end', function() {
+      var body = Buffer.concat(chunks);
+      if (method === 'HEAD') {
+        assert.equal(body.length, 0);
+      } else {
+        assert.equal(body.toString('hex'),
+                     Buffer.concat([new Buffer('head'), data]).toString('hex'));
+      }
+      if (url === '/length') {
+        assert.equal(res.headers['content-length'], data.length + 4);
+      } else {
+        assert.equal(res.headers['transfer-encoding'], 'chunked');
+      }
+      responses++;
+      next();
+    });
+  }).end();
+}
+
+server.listen(common.PORT, function() {
+  get('GET', '/chunked', function() {
+    get('GET', '/length', function() {
+      get('HEAD', '/length', function() {
+        server.close();
+      });
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(responses, 3);
+  fs.closeSync(fd);
+});
@@ -0,0 +1,270 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+var fs = require('fs');
+var http = require('http');
+var net = require('net');
+var os = require('os');
+var path = require('path');
+var spawn = require('child_process').spawn;
+
+var before;
+
+function mark() {
+  before = process.ioCounters();
+}
+
+function delta(name) {
+  assert(name in before, 'no counter named ' + name);
+  return process.ioCounters()[name] - before[name];
+}
+
+function testFs(next) {
+  var filename = path.join(common.tmpDir, 'io-counters.txt');
+  var data = new Buffer(1000);
+  data.fill('x');
+
+  mark();
+  fs.writeFileSync(filename, data);
+  assert.equal(delta('fsBytesWritten'), 1000);
+  assert(delta('fsOps') >= 3);  // open, write, close
+
+  mark();
+  fs.readFile(filename, function(err, contents) {
+    if (err) throw err;
+    assert.equal(contents.length, 1000);
+    assert.equal(delta('fsBytesRead'), 1000);
+    assert(delta('fsOps') >= 1);
+    fs.unlinkSync(filename);
+    next();
+  });
+}
+
+function testTcpAndHttp(next) {
+  mark();
+  var server = http.createServer(function(req, res) {
+    res.end('hello');
+  });
+  server.listen(common.PORT, function() {
+    http.get({ port: common.PORT, agent: false }, function(res) {
+      res.resume();
+      res.on('end', function() {
+        server.close();
+        assert.equal(delta('httpServerRequests'), 1);
+        assert.equal(delta('httpServerResponses'), 1);
+        assert.equal(delta('httpClientRequests'), 1);
+        assert.equal(delta('httpClientResponses'), 1);
+        assert.equal(delta('tcpConnections'), 1);
+        assert(delta('tcpReads') >= 2);
+        assert(delta('tcpWrites') >= 2);
+        // What one end wrote the other end read, or is about to.
+        assert(delta('tcpBytesRead') > 0);
+        assert(delta('tcpBytesWritten') >= delta('tcpBytesRead'));
+        next();
+      });
+    });
+  });
+}
+
+function testPipe(next) {
+  mark();
+  var server = net.createServer(function(conn) {
+    conn.on('data', function(chunk) {
+      conn.end();
+      server.close();
+    });
+    conn.on('end', function() {
+      assert.equal(delta('pipeConnections'), 1);
+      assert.equal(delta('pipeBytesWritten'), 5);
+      assert.equal(delta('pipeBytesRead'), 5);
+      assert.equal(delta('pipeWrites'), 1);
+      assert.equal(delta('pipeReads'), 1);
+      next();
+    });
+  });
+  server.listen(common.PIPE, function() {
+    net.connect(common.PIPE).end('hello');
+  });
+}
+
+function testUdp(next) {
+  mark();
+  var socket = dgram.createSocket('udp4');
+  socket.on('message', function(message) {
+    socket.close();
+    assert.equal(delta('udpDatagramsSent'), 1);
+    assert.equal(delta('udpBytesSent'), 4);
+    assert.equal(delta('udpDatagramsReceived'), 1);
+    assert.equal(delta('udpBytesReceived'), 4);
+    next();
+  });
+  socket.bind(common.PORT, '127.0.0.1', function() {
+    socket.send(new Buffer('ping'), 0, 4, common.PORT, '127.0.0.1');
+  });
+}
+
+function testTls(next) {
+  if (!process.versions.openssl)
+    return next();
+
+  var tls = require('tls');
+  var options = {
+    key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+    cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+  };
+
+  mark();
+  var server = tls.createServer(options, function(conn) {
+    conn.end();
+    server.close();
+  });
+  server.listen(common.PORT, function() {
+    var client = tls.connect({
+      port: common.PORT,
+      rejectUnauthorized: false
+    }, function() {
+      // The server finished its handshake before sending the last message.
+      assert.equal(delta('tlsHandshakes'), 2);
+      client.resume();
+      next();
+    });
+  });
+}
+
+function testSendFile(next) {
+  var filename = path.join(common.fixturesDir, 'sample.png');
+  var length = fs.statSync(filename).size;
+  var fd = fs.openSync(filename, 'r');
+
+  mark();
+  var server = net.createServer(function(conn) {
+    conn.sendFile(fd, 0, length);
+    conn.end();
+  });
+  server.listen(common.PORT, function() {
+    var received = 0;
+    var client = net.connect(common.PORT);
+    client.on('data', function(chunk) {
+      received += chunk.length;
+    });
+    client.on('end', function() {
+      server.close();
+      fs.closeSync(fd);
+      assert.equal(received, length);
+      // Counted whether the socket used sendfile or read and wrote the file.
+      assert(delta('fsBytesRead') >= length);
+      assert(delta('tcpBytesWritten') >= length);
+      next();
+    });
+  });
+}
+
+// `resolve` turns the pid into the name of the file the child should map.
+function checkFile(filename, resolve, next) {
+  var env = {};
+  for (var key in process.env)
+    env[key] = process.env[key];
+  env.NODE_IO_COUNTERS_FILE = filename;
+
+  var script = 'require("fs").writeFileSync(process.argv[1], ' +
+               'new Buffer(1234)); console.log(process.pid);';
+  var child = spawn(process.execPath,
+                    ['-e', script, path.join(common.tmpDir, 'io-counters.dat')],
+                    { env: env });
+  var pid = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', function(s) { pid += s; });
+  child.on('close', function(code) {
+    assert.equal(code, 0);
+    pid = pid.trim();
+    filename = resolve(pid);
+
+    var le = os.endianness() === 'LE';
+    var data = fs.readFileSync(filename);
+    function uint32(offset) {
+      return le ? data.readUInt32LE(offset) : data.readUInt32BE(offset);
+    }
+    function double(offset) {
+      return le ? data.readDoubleLE(offset) : data.readDoubleBE(offset);
+    }
+
+    assert.equal(data.toString('binary', 0, 8), 'NODEIOC\0');
+    assert.equal(uint32(8), 1);
+    var count = uint32(12);
+    assert.equal(count, Object.keys(process.ioCounters()).length);
+    assert.equal(uint32(16), pid);
+    var nameSize = uint32(20);
+    assert.equal(data.length, 24 + count * (8 + nameSize));
+
+    var counters = {};
+    for (var i = 0; i < count; i++) {
+      var offset = 24 + count * 8 + i * nameSize;
+      var name = data.toString('binary', offset, offset + nameSize);
+      counters[name.replace(/\0+$/, '')] = double(24 + i * 8);
+    }
+    assert(counters.fsBytesWritten >= 1234);
+    assert.equal(counters.tcpBytesRead, 0);
+
+    fs.unlinkSync(filename);
+    fs.unlinkSync(path.join(common.tmpDir, 'io-counters.dat'));
+    next();
+  });
+}
+
+function testFile(next) {
+  var filename = path.join(common.tmpDir, 'io-counters-%p.bin');
+  checkFile(filename, function(pid) {
+    return filename.replace('%p', pid);
+  }, next);
+}
+
+function testFileWithoutPid(next) {
+  // Without a %p the pid is appended, or cluster workers would share the file
+  var filename = path.join(common.tmpDir, 'io-counters.bin');
+  checkFile(filename, function(pid) {
+    assert(!fs.existsSync(filename));
+    return filename + '.' + pid;
+  }, next);
+}
+
+var tests = [testFs, testTcpAndHttp, testPipe, testUdp, testTls,
+             testSendFile];
+if (process.platform !== 'win32')
+  tests.push(testFile, testFileWithoutPid);
+
+var pending = tests.length;
+function next() {
+  var test = tests.shift();
+  if (test) {
+    test(function() {
+      pending -= 1;
+      next();
+    });
+  }
+}
+next();
+
+process.on('exit', function() {
+  assert.equal(pending, 0);
+});
@@ -0,0 +1,84 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var timing = process.binding('loop_timing');
+
+var phases = timing.phases;
+var kBuckets = timing.kBuckets;
+var iterations = phases.length;  // Index of the iteration count in totals.
+
+function phase(name) {
+  var index = phases.indexOf(name);
+  assert(index !== -1, name);
+  return index;
+}
+
+function count(name) {
+  var n = 0;
+  for (var i = 0; i < kBuckets; i++)
+    n += timing.histogram[phase(name) * kBuckets + i];
+  return n;
+}
+
+function busyWait(ms) {
+  var start = Date.now();
+  while (Date.now() - start < ms);
+}
+
+assert.equal(timing.totals[iterations], 0);
+assert.equal(timing.start(), 0);
+
+setTimeout(function() {
+  busyWait(20);
+  setImmediate(function() {
+    busyWait(10);
+    setTimeout(check, 50);
+  });
+}, 50);
+
+function check() {
+  var ms = 1e6;
+  var n = timing.totals[iterations];
+  assert(n > 0);
+  // Every iteration lands in exactly one bucket of every histogram.
+  phases.forEach(function(name) {
+    assert.equal(count(name), n, name);
+  });
+  assert(timing.totals[phase('timers')] >= 15 * ms);
+  assert(timing.totals[phase('check')] >= 5 * ms);
+  assert(timing.totals[phase('pollWait')] >= 50 * ms);
+  assert(timing.totals[phase('busy')] >= 25 * ms);
+  assert(timing.totals[phase('busy')] < timing.totals[phase('pollWait')]);
+
+  // The 20 ms timer lands in bucket log2(20000) + 1.
+  var bucket = phase('timers') * kBuckets + 15;
+  assert(timing.histogram[bucket] >= 1);
+
+  assert.equal(timing.stop(), 0);
+  setImmediate(function() {
+    assert.equal(timing.totals[iterations], n);
+    timing.reset();
+    assert.equal(timing.totals[iterations], 0);
+    assert.equal(count('busy'), 0);
+  });
+}
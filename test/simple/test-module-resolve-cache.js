@@ -0,0 +1,135 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var execFileSync = require('child_process').execFileSync;
+var fs = require('fs');
+var path = require('path');
+
+var root = path.join(common.tmpDir, 'resolve-cache');
+var app = path.join(root, 'app');
+var cacheFile = path.join(root, 'cache.json');
+
+function rmrf(p) {
+  try {
+    var stats = fs.lstatSync(p);
+  } catch (e) {
+    return;
+  }
+  if (stats.isDirectory()) {
+    fs.readdirSync(p).forEach(function(name) {
+      rmrf(path.join(p, name));
+    });
+    fs.rmdirSync(p);
+  } else {
+    fs.unlinkSync(p);
+  }
+}
+
+function mkdirp(dir) {
+  if (fs.existsSync(dir))
+    return;
+  mkdirp(path.dirname(dir));
+  fs.mkdirSync(dir);
+}
+
+function write(name, content) {
+  var filename = path.join(app, name);
+  mkdirp(path.dirname(filename));
+  fs.writeFileSync(filename, content);
+}
+
+// Move every timestamp into the past, so later changes can't end up with
+// the same mtime no matter how coarse the file system's timestamps are.
+function age(p) {
+  if (fs.statSync(p).isDirectory()) {
+    fs.readdirSync(p).forEach(function(name) {
+      age(path.join(p, name));
+    });
+  }
+  fs.utimesSync(p, 1e6, 1e6);
+}
+
+// main.js reports where everything resolved and how many stat() calls that
+// took, the requires themselves happen in sub/inner.js. This process read
+// the variable at startup already, only the children use the cache.
+process.env.NODE_MODULE_RESOLVE_CACHE = cacheFile;
+
+function run() {
+  return JSON.parse(execFileSync(process.execPath,
+                                 [path.join(app, 'main.js')]));
+}
+
+rmrf(root);
+fs.mkdirSync(root);
+write('main.js',
+      'var fs = require("fs");\n' +
+      'var statSync = fs.statSync, stats = 0;\n' +
+      'fs.statSync = function() { stats++; return statSync.apply(fs, ' +
+      'arguments); };\n' +
+      'var resolved = require("./sub/inner");\n' +
+      'console.log(JSON.stringify({ resolved: resolved, stats: stats }));\n');
+write('sub/inner.js',
+      'module.exports = [require("a"), require("b/lib/x"), ' +
+      'require("./local"), require("../top")];\n');
+write('sub/local.js', 'module.exports = "local";\n');
+write('top/index.js', 'module.exports = "top";\n');
+write('node_modules/a/package.json', '{ "main": "lib/a" }');
+write('node_modules/a/lib/a.js', 'module.exports = "a";\n');
+write('node_modules/a/lib/b.js', 'module.exports = "a/b";\n');
+write('node_modules/b/lib/x.js', 'module.exports = "b/x";\n');
+age(root);
+
+var expected = ['a', 'b/x', 'local', 'top'];
+
+// Cold: probe and write the cache.
+var cold = run();
+assert.deepEqual(cold.resolved, expected);
+var data = JSON.parse(fs.readFileSync(cacheFile, 'utf8'));
+assert.equal(data.version, process.version);
+assert(Object.keys(data.entries).length >= 4);
+
+// Warm: the same answers, after checking a few directories instead.
+var warm = run();
+assert.deepEqual(warm.resolved, expected);
+assert(warm.stats < cold.stats,
+       warm.stats + ' stat() calls, ' + cold.stats + ' without the cache');
+
+// A module closer to sub/ shadows node_modules/a.
+write('sub/node_modules/a.js', 'module.exports = "shadow";\n');
+assert.deepEqual(run().resolved, ['shadow', 'b/x', 'local', 'top']);
+rmrf(path.join(app, 'sub/node_modules'));
+assert.deepEqual(run().resolved, expected);
+
+// An edited package.json points somewhere else.
+write('node_modules/a/package.json', '{ "main": "lib/b" }');
+assert.deepEqual(run().resolved, ['a/b', 'b/x', 'local', 'top']);
+write('node_modules/a/package.json', '{ "main": "lib/a" }');
+fs.utimesSync(path.join(app, 'node_modules/a/package.json'), 2e6, 2e6);
+
+// A file that isn't a cache is ignored and replaced.
+fs.writeFileSync(cacheFile, 'not json');
+assert.deepEqual(run().resolved, expected);
+JSON.parse(fs.readFileSync(cacheFile, 'utf8'));
+assert.deepEqual(run().resolved, expected);
+
+rmrf(root);
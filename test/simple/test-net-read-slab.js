@@ -0,0 +1,75 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Flags: --expose-gc
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+var binding = process.binding('stream_wrap');
+
+var N = 200;
+var received = [];
+var before = binding.getSlabStatistics();
+
+var server = net.createServer(function(socket) {
+  var i = 0;
+  (function write() {
+    if (i === N)
+      return socket.end();
+    socket.write('message ' + i++ + '\n', write);
+  })();
+});
+
+server.listen(common.PORT, function() {
+  var client = net.connect(common.PORT);
+  client.on('data', function(chunk) {
+    received.push(chunk);
+  });
+  client.on('end', function() {
+    server.close();
+    check();
+  });
+});
+
+function check() {
+  var expected = '';
+  for (var i = 0; i < N; i++)
+    expected += 'message ' + i + '\n';
+  assert.equal(Buffer.concat(received).toString(), expected);
+
+  var stats = binding.getSlabStatistics();
+  assert(stats.slab_size > 0);
+  assert(stats.slabs >= 1);
+  assert(stats.slab_bytes >= stats.slab_size);
+  assert(stats.used_bytes > 0);
+  assert(stats.used_bytes <= stats.slab_bytes);
+  assert(stats.total_chunks - before.total_chunks >= received.length);
+  // Small reads are carved out of shared slabs, not one slab per read.
+  assert(stats.total_slabs - before.total_slabs <= 1);
+
+  var chunks = stats.chunks;
+  received = null;
+  setImmediate(function() {
+    gc();
+    assert(binding.getSlabStatistics().chunks < chunks);
+  });
+}
@@ -0,0 +1,104 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var net = require('net');
+var path = require('path');
+var tls = require('tls');
+
+// socket.sendFile() output stays in order with regular writes, both for
+// plain TCP sockets (sendfile) and TLS sockets (read and write).
+var file = path.join(common.fixturesDir, 'sample.png');
+var data = fs.readFileSync(file);
+var fd = fs.openSync(file, 'r');
+var offset = 100;
+var length = data.length - 200;
+var expected = Buffer.concat([
+  new Buffer('head'),
+  data.slice(offset, offset + length),
+  new Buffer('middle'),
+  data.slice(0, 10),
+  new Buffer('tail')
+]);
+
+assert.throws(function() {
+  new net.Socket().sendFile(-1, 0, 1);
+}, /file descriptor/);
+
+var sendFileCallbacks = 0;
+var done = 0;
+
+function serve(socket) {
+  socket.write('head');
+  socket.sendFile(fd, offset, length, function() {
+    sendFileCallbacks++;
+  });
+  // Buffered writes make the Writable hand over a batch
+  socket.cork();
+  socket.write('middle');
+  socket.sendFile(fd, 0, 10);
+  socket.write('tail');
+  socket.uncork();
+  socket.end();
+}
+
+function check(socket, next) {
+  var chunks = [];
+  socket.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  socket.on('end', function() {
+    assert.equal(Buffer.concat(chunks).toString('hex'),
+                 expected.toString('hex'));
+    done++;
+    next();
+  });
+}
+
+var server = net.createServer(serve);
+server.listen(common.PORT, function() {
+  check(net.connect(common.PORT), function() {
+    server.close();
+    testTLS();
+  });
+});
+
+function testTLS() {
+  var options = {
+    key: fs.readFileSync(path.join(common.fixturesDir, 'keys/agent1-key.pem')),
+    cert: fs.readFileSync(path.join(common.fixturesDir, 'keys/agent1-cert.pem'))
+  };
+  var server = tls.createServer(options, serve);
+  server.listen(common.PORT, function() {
+    var socket = tls.connect({ port: common.PORT, rejectUnauthorized: false });
+    check(socket, function() {
+      server.close();
+    });
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(done, 2);
+  assert.equal(sendFileCallbacks, 2);
+  fs.closeSync(fd);
+});
@@ -0,0 +1,58 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var N = 50;
+var connections = 0;
+var replies = 0;
+
+var server = net.createServer({ acceptBatch: 16 }, function(socket) {
+  connections++;
+  socket.end('ok');
+});
+
+assert.equal(server.acceptBatch, 16);
+assert.equal(net.createServer().acceptBatch, 1);
+
+server.listen(common.PORT, function() {
+  for (var i = 0; i < N; i++) {
+    net.connect(common.PORT, function() {
+      var data = '';
+      this.setEncoding('utf8');
+      this.on('data', function(chunk) {
+        data += chunk;
+      });
+      this.on('end', function() {
+        assert.equal(data, 'ok');
+        if (++replies === N)
+          server.close();
+      });
+    });
+  }
+});
+
+process.on('exit', function() {
+  assert.equal(connections, N);
+  assert.equal(replies, N);
+});
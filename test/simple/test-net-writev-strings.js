@@ -0,0 +1,88 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+// Strings in a writev() batch are encoded back to back into one block,
+// make sure every encoding comes out intact next to Buffers and empty
+// chunks, both when the batch fits in the socket buffer and when it doesn't.
+var small = [
+  ['GET / HTTP/1.1\r\n', 'binary'],
+  [new Buffer('buffer'), 'buffer'],
+  ['', 'utf8'],
+  ['caf\u00e9 \u20ac \ud83d\ude00', 'utf8'],
+  ['x', 'ascii'],
+  ['odd offset \u00e9\u4e2d', 'ucs2'],
+  [new Buffer(0), 'buffer'],
+  ['aGVsbG8gd29ybGQ=', 'base64'],
+  ['', 'ucs2'],
+  ['deadbeef', 'hex'],
+  ['\u00ff\u00fe latin1', 'binary'],
+  ['\u00ff\u00fe latin1 as utf8', 'utf8'],
+  ['utf-16 again \u4e2d', 'utf16le']
+];
+
+var large = small.concat([
+  [new Array(70000).join('\u00e9'), 'utf8'],
+  [new Array(1 << 20).join('a'), 'utf8'],
+  [new Buffer(1 << 20), 'buffer'],
+  [new Array(1 << 18).join('\u4e2d\u00e9'), 'ucs2'],
+  ['tail', 'ascii']
+]);
+
+function toBuffer(batch) {
+  return Buffer.concat(batch.map(function(entry) {
+    var chunk = entry[0];
+    return Buffer.isBuffer(chunk) ? chunk : new Buffer(chunk, entry[1]);
+  }));
+}
+
+var expected = Buffer.concat([toBuffer(small), toBuffer(large),
+                              toBuffer(small)]);
+var received = [];
+
+var server = net.createServer(function(c) {
+  c.on('data', function(chunk) {
+    received.push(chunk);
+  });
+  c.on('end', function() {
+    server.close();
+  });
+}).listen(common.PORT, function() {
+  var c = net.connect(common.PORT, function() {
+    [small, large, small].forEach(function(batch) {
+      c.cork();
+      batch.forEach(function(entry) {
+        c.write(entry[0], entry[1]);
+      });
+      c.uncork();
+    });
+    c.end();
+  });
+});
+
+process.on('exit', function() {
+  var actual = Buffer.concat(received);
+  assert.equal(actual.length, expected.length);
+  assert.equal(actual.toString('hex'), expected.toString('hex'));
+});
@@ -0,0 +1,61 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var crypto = require('crypto');
+
+var binding = process.binding('uv');
+var before = binding.getThreadpoolStatistics();
+var classes = ['fast_io', 'cpu', 'slow_io'];
+
+classes.forEach(function(name) {
+  var stats = before[name];
+  assert.equal(typeof stats, 'object');
+  assert.equal(typeof stats.queued, 'number');
+  assert.equal(typeof stats.dispatched, 'number');
+  assert.equal(typeof stats.wait_time, 'number');
+  assert.equal(typeof stats.max_wait_time, 'number');
+});
+
+var pending = 2;
+
+fs.stat(__filename, function(err) {
+  assert.ifError(err);
+  if (--pending === 0) check();
+});
+
+crypto.pbkdf2('password', 'salt', 1, 32, function(err) {
+  assert.ifError(err);
+  if (--pending === 0) check();
+});
+
+function check() {
+  var after = binding.getThreadpoolStatistics();
+  assert.ok(after.threads > 0);
+  assert.ok(after.fast_io.dispatched > before.fast_io.dispatched);
+  assert.ok(after.cpu.dispatched > before.cpu.dispatched);
+  classes.forEach(function(name) {
+    assert.equal(after[name].queued, 0);
+    assert.ok(after[name].wait_time >= after[name].max_wait_time);
+  });
+}
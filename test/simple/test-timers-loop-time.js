@@ -0,0 +1,51 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// The loop time that lib/timers.js reads from timer_wrap.timerInfo has to
+// keep up with the loop, both in the main script and in callbacks.
+
+var common = require('../common');
+var assert = require('assert');
+var binding = process.binding('timer_wrap');
+var Timer = binding.Timer;
+var timerInfo = binding.timerInfo;
+var kLoopTime = 0;
+
+function check() {
+  var cached = timerInfo[kLoopTime];
+  var now = Timer.now();
+  assert(cached > 0);
+  assert(cached <= now);
+  assert(now - cached < 50, 'loop time is ' + (now - cached) + 'ms behind');
+  // Timer.now() updates the loop time, and so the shared field.
+  assert.equal(timerInfo[kLoopTime], now);
+  return now;
+}
+
+var start = check();
+
+setTimeout(common.mustCall(function() {
+  var now = check();
+  assert(now - start >= 100);
+  setImmediate(common.mustCall(check));
+}), 100);
+
+require('fs').stat(__filename, common.mustCall(check));
@@ -0,0 +1,91 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// timers._unrefActive() keeps its timeouts in a timing wheel. They must never
+// fire early, at most 1/8 of their duration late, and refreshing one pushes
+// it back.
+
+var common = require('../common');
+var assert = require('assert');
+var timers = require('timers');
+
+var start = Date.now();
+var fired = 0;
+var durations = [1, 10, 50, 63, 64, 100, 300, 504, 505, 1000, 1500];
+
+// Something has to keep the loop alive, the wheel timer is unref'd.
+var keepAlive = setTimeout(function() {}, 5000);
+
+function item(msecs, onTimeout) {
+  var item = { _onTimeout: onTimeout };
+  timers.enroll(item, msecs);
+  timers._unrefActive(item);
+  return item;
+}
+
+durations.forEach(function(msecs) {
+  var t = Date.now();
+  item(msecs, function() {
+    var elapsed = Date.now() - t;
+    assert(elapsed >= msecs - 1, msecs + 'ms timeout fired after ' + elapsed);
+    assert(elapsed <= msecs + msecs / 8 + 100,
+           msecs + 'ms timeout fired after ' + elapsed);
+    fired++;
+    done();
+  });
+});
+
+// Unenrolled items don't fire.
+var cancelled = item(20, assert.fail);
+timers.unenroll(cancelled);
+
+// Refreshing keeps pushing the timeout back.
+var refreshed = 0;
+var lastRefresh;
+var busy = item(100, function() {
+  assert.equal(refreshed, 10);
+  assert(Date.now() - lastRefresh >= 99);
+  fired++;
+  done();
+});
+var interval = setInterval(function() {
+  timers._unrefActive(busy);
+  lastRefresh = Date.now();
+  if (++refreshed === 10) clearInterval(interval);
+}, 50);
+
+// Re-arming from within the callback works.
+var rearmed = 0;
+var again = item(30, function() {
+  if (++rearmed < 3)
+    return timers._unrefActive(again);
+  fired++;
+  done();
+});
+
+function done() {
+  if (fired === durations.length + 2) clearTimeout(keepAlive);
+}
+
+process.on('exit', function() {
+  assert.equal(fired, durations.length + 2);
+  assert.equal(rearmed, 3);
+});
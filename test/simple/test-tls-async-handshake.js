@@ -0,0 +1,128 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var tls = require('tls');
+
+function loadPEM(n) {
+  return fs.readFileSync(common.fixturesDir + '/keys/' + n + '.pem');
+}
+
+var clients = 10;
+var echoed = 0;
+var clientErrors = 0;
+
+// Handshake steps run on the thread pool, including ones that switch to the
+// SNI context and advertise NPN protocols.
+var server = tls.createServer({
+  key: loadPEM('agent2-key'),
+  cert: loadPEM('agent2-cert'),
+  asyncHandshake: true,
+  NPNProtocols: ['a', 'b'],
+  SNICallback: function(servername, cb) {
+    cb(null, tls.createSecureContext({
+      key: loadPEM('agent1-key'),
+      cert: loadPEM('agent1-cert')
+    }));
+  }
+}, function(c) {
+  c.pipe(c);
+});
+
+server.on('clientError', function(err) {
+  clientErrors++;
+});
+
+// Poke the TLS state from JS while handshake steps may be on the thread pool.
+// The TLS socket took over the handle of the raw connection.
+var pokes = 0;
+server.on('connection', function(raw) {
+  var socket = raw._handle.owner;
+  assert(socket instanceof tls.TLSSocket);
+  (function poke() {
+    if (socket.destroyed)
+      return;
+    socket.getPeerCertificate();
+    socket.getCipher();
+    socket.isSessionReused();
+    pokes++;
+    if (!socket._secureEstablished)
+      setImmediate(poke);
+  })();
+});
+
+server.listen(common.PORT, function() {
+  var pending = clients;
+
+  for (var i = 0; i < clients; i++)
+    connect(i);
+
+  function connect(i) {
+    var c = tls.connect({
+      port: common.PORT,
+      servername: i % 2 ? 'agent1' : undefined,
+      NPNProtocols: ['b'],
+      rejectUnauthorized: false
+    }, function() {
+      var cert = c.getPeerCertificate();
+      assert.equal(cert.subject.CN, i % 2 ? 'agent1' : 'agent2');
+      assert.equal(c.npnProtocol, 'b');
+      c.end('hello ' + i);
+    });
+
+    var data = '';
+    c.setEncoding('utf8');
+    c.on('data', function(chunk) {
+      data += chunk;
+    });
+    c.on('end', function() {
+      assert.equal(data, 'hello ' + i);
+      echoed++;
+      if (--pending === 0)
+        badClient();
+    });
+  }
+});
+
+// A failed handshake step is reported like a synchronous one
+function badClient() {
+  var c = tls.connect({
+    port: common.PORT,
+    ciphers: 'NULL-MD5',
+    rejectUnauthorized: false
+  }, assert.fail);
+  c.on('error', function() {
+    server.close();
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(echoed, clients);
+  assert.equal(clientErrors, 1);
+  assert(pokes > 0);
+});
@@ -0,0 +1,121 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var constants = require('constants');
+var tls = require('tls');
+var fs = require('fs');
+var join = require('path').join;
+
+var workerCount = 4;
+var expectedReqCount = 16;
+
+// Same as test-tls-ticket-cluster.js but with tickets disabled, sessions can
+// only be resumed through the cache the workers share.
+if (cluster.isMaster) {
+  var reusedCount = 0;
+  var reqCount = 0;
+  var cacheFiles = {};
+  var lastSession = null;
+  var shootOnce = false;
+
+  function shoot() {
+    var c = tls.connect(common.PORT, {
+      session: lastSession,
+      rejectUnauthorized: false
+    }, function() {
+      lastSession = c.getSession();
+      c.end();
+
+      if (++reqCount === expectedReqCount) {
+        Object.keys(cluster.workers).forEach(function(id) {
+          cluster.workers[id].send('die');
+        });
+      } else {
+        shoot();
+      }
+    });
+  }
+
+  for (var i = 0; i < workerCount; i++) {
+    var worker = cluster.fork();
+    worker.on('message', function(msg) {
+      if (msg === 'reused') {
+        ++reusedCount;
+      } else if (msg.cacheFile) {
+        cacheFiles[msg.cacheFile] = true;
+      } else if (msg === 'listening' && !shootOnce) {
+        shootOnce = true;
+        shoot();
+      }
+    });
+  }
+
+  process.on('exit', function() {
+    assert.equal(reqCount, expectedReqCount);
+    assert.equal(reusedCount + 1, reqCount);
+
+    // All workers share one file and the master removed it, even though the
+    // worker that proposed it may have crashed
+    var files = Object.keys(cacheFiles);
+    assert.equal(files.length, 1);
+    assert(!fs.existsSync(files[0]));
+  });
+  return;
+}
+
+var options = {
+  key: fs.readFileSync(join(common.fixturesDir, 'agent.key')),
+  cert: fs.readFileSync(join(common.fixturesDir, 'agent.crt')),
+  secureOptions: constants.SSL_OP_NO_TICKET,
+  sharedSessionCache: true,
+  sharedSessionCacheSize: 64
+};
+
+var server = tls.createServer(options, function(c) {
+  process.send(c.isSessionReused() ? 'reused' : 'not-reused');
+  c.end();
+});
+
+server.listen(common.PORT, function() {
+  process.send({ cacheFile: server._sessionCache });
+  process.send('listening');
+});
+
+process.on('message', function(msg) {
+  if (msg !== 'die')
+    return;
+
+  // Half of the workers crash instead of shutting down cleanly
+  if (cluster.worker.id % 2)
+    return process.kill(process.pid, 'SIGKILL');
+
+  server.close(function() {
+    process.exit();
+  });
+});
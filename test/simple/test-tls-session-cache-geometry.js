@@ -0,0 +1,98 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+if (process.platform === 'win32') {
+  console.error('Skipping: the cache has no file to look at on Windows.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var constants = require('constants');
+var fs = require('fs');
+var spawn = require('child_process').spawn;
+var tls = require('tls');
+var join = require('path').join;
+
+var file = join(common.tmpDir, 'tls-session-cache-geometry');
+
+if (process.argv[2] === 'child') {
+  // Store a session, that writes past the header.
+  var server = tls.createServer({
+    key: fs.readFileSync(join(common.fixturesDir, 'agent.key')),
+    cert: fs.readFileSync(join(common.fixturesDir, 'agent.crt')),
+    secureOptions: constants.SSL_OP_NO_TICKET,
+    sharedSessionCache: file,
+    sharedSessionCacheSize: +process.argv[3]
+  }, function(c) {
+    c.end();
+  });
+  server.listen(0, function() {
+    var port = this.address().port;
+    tls.connect(port, { rejectUnauthorized: false }, function() {
+      this.end();
+      server.close();
+    });
+  });
+  return;
+}
+
+// A file without a header, left by a process that died creating it, is
+// started over. Then processes that create the cache at the same time with
+// different sizes must agree on one, or some touch entries past the end.
+try {
+  fs.unlinkSync(file);
+} catch (e) {
+}
+fs.writeFileSync(file, new Buffer(100).fill(0));
+
+var sizes = [16, 64, 1024, 16, 64, 1024];
+var exited = 0;
+
+start(4096, function() {
+  fs.unlinkSync(file);
+  sizes.forEach(function(size) {
+    start(size, function() {
+      if (++exited === sizes.length)
+        fs.unlinkSync(file);
+    });
+  });
+});
+
+function start(size, cb) {
+  var child = spawn(process.execPath, [__filename, 'child', size], {
+    stdio: 'inherit'
+  });
+  child.on('exit', function(code, signal) {
+    assert.equal(signal, null);
+    assert.equal(code, 0);
+    cb();
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(exited, sizes.length);
+});
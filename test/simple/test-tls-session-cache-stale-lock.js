@@ -0,0 +1,93 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+if (process.platform === 'win32') {
+  console.error('Skipping: the cache has no file to tamper with on Windows.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var constants = require('constants');
+var fs = require('fs');
+var os = require('os');
+var spawnSync = require('child_process').spawnSync;
+var tls = require('tls');
+var join = require('path').join;
+
+var file = join(common.tmpDir, 'tls-session-cache-stale-lock');
+try {
+  fs.unlinkSync(file);
+} catch (e) {
+}
+
+var server = tls.createServer({
+  key: fs.readFileSync(join(common.fixturesDir, 'agent.key')),
+  cert: fs.readFileSync(join(common.fixturesDir, 'agent.crt')),
+  secureOptions: constants.SSL_OP_NO_TICKET,
+  sharedSessionCache: file,
+  sharedSessionCacheSize: 64
+}, function(c) {
+  c.end();
+});
+
+// Pretend that a process which has exited by now died while holding every
+// lock of the cache. The locks follow the magic, version and set count.
+var pid = spawnSync(process.execPath, ['-e', '']).pid;
+var locks = new Buffer(64 * 4);
+for (var i = 0; i < 64; i++) {
+  if (os.endianness() === 'LE')
+    locks.writeUInt32LE(pid, i * 4);
+  else
+    locks.writeUInt32BE(pid, i * 4);
+}
+var fd = fs.openSync(file, 'r+');
+fs.writeSync(fd, locks, 0, locks.length, 16);
+fs.closeSync(fd);
+
+var resumed = false;
+
+server.listen(common.PORT, function() {
+  var c = tls.connect(common.PORT, { rejectUnauthorized: false }, function() {
+    var session = c.getSession();
+    c.end();
+    c.on('close', function() {
+      var c2 = tls.connect(common.PORT, {
+        session: session,
+        rejectUnauthorized: false
+      }, function() {
+        resumed = c2.isSessionReused();
+        c2.end();
+        server.close();
+      });
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert(resumed);
+  fs.unlinkSync(file);
+});
@@ -0,0 +1,77 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var crypto = require('crypto');
+var fs = require('fs');
+var tls = require('tls');
+
+// Batches of small and large buffers are packed into TLS records on the way
+// out, make sure the byte stream survives that intact.
+var sizes = [1, 7, 100, 1024, 16383, 16384, 16385, 40000, 3, 5000];
+var chunks = sizes.map(function(size) {
+  return crypto.randomBytes(size);
+});
+var expected = Buffer.concat(chunks.concat(chunks));
+var received = [];
+
+var server = tls.createServer({
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent1-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent1-cert.pem')
+}, function(c) {
+  c.on('data', function(chunk) {
+    received.push(chunk);
+  });
+  c.on('end', function() {
+    server.close();
+  });
+}).listen(common.PORT, function() {
+  var c = tls.connect(common.PORT, {
+    rejectUnauthorized: false
+  }, function() {
+    // Once as one writev() batch, once with a smaller record size.
+    c.cork();
+    chunks.forEach(function(chunk) {
+      c.write(chunk);
+    });
+    c.uncork();
+
+    assert(c.setMaxSendFragment(1024));
+    c.cork();
+    chunks.forEach(function(chunk) {
+      c.write(chunk);
+    });
+    c.uncork();
+    c.end();
+  });
+});
+
+process.on('exit', function() {
+  var actual = Buffer.concat(received);
+  assert.equal(actual.length, expected.length);
+  assert.equal(actual.toString('hex'), expected.toString('hex'));
+});
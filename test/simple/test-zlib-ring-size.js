@@ -0,0 +1,77 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var zlib = require('zlib');
+
+// A ring of several chunks gets filled by a single write() to the binding
+// but the output still comes out in chunks of at most chunkSize bytes.
+var chunkSize = 1024;
+var ringSize = 16 * chunkSize;
+var input = require('crypto').pseudoRandomBytes(8 * ringSize);
+
+assert.throws(function() {
+  zlib.createDeflate({ chunkSize: chunkSize, ringSize: chunkSize - 1 });
+}, /Invalid ring size/);
+
+var deflate = zlib.createDeflate({ level: 0,
+                                   chunkSize: chunkSize,
+                                   ringSize: ringSize });
+var handleWrites = 0;
+var write = deflate._handle.write;
+deflate._handle.write = function() {
+  handleWrites++;
+  return write.apply(this, arguments);
+};
+
+var chunks = [];
+deflate.on('data', function(chunk) {
+  assert(chunk.length <= chunkSize);
+  chunks.push(chunk);
+});
+
+deflate.on('end', function() {
+  var compressed = Buffer.concat(chunks);
+  // Stored blocks, the output is a bit larger than the input
+  assert(compressed.length > input.length);
+  // One per full ring instead of one per chunk
+  assert(handleWrites <= Math.ceil(compressed.length / ringSize) + 2);
+  assert(chunks.length >= Math.ceil(compressed.length / chunkSize));
+
+  zlib.inflate(compressed, function(err, result) {
+    assert.ifError(err);
+    assert.equal(result.toString('hex'), input.toString('hex'));
+    ended = true;
+  });
+
+  var sync = zlib.deflateSync(input, { level: 0,
+                                       chunkSize: chunkSize,
+                                       ringSize: ringSize });
+  assert.equal(sync.toString('hex'), compressed.toString('hex'));
+});
+
+var ended = false;
+deflate.end(input);
+
+process.on('exit', function() {
+  assert(ended);
+});